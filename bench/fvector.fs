@@ -0,0 +1,33 @@
+\ Float vector words against the equivalent Forth loops
+\ usage: time ./forth bench/fvector.fs [loop|simd]
+
+1000 CONSTANT n
+10000 CONSTANT reps
+
+CREATE a n FLOATS ALLOT
+CREATE b n FLOATS ALLOT
+CREATE c n FLOATS ALLOT
+
+: init ( -- )
+    n 0 DO
+        I S>F a I FLOATS + F!
+        I 2 * S>F b I FLOATS + F!
+    LOOP ;
+
+: loop-fv+ ( -- )
+    n 0 DO
+        a I FLOATS + F@ b I FLOATS + F@ F+ c I FLOATS + F!
+    LOOP ;
+
+: loop-fdot ( -- ) ( F: -- r )
+    0E0 n 0 DO
+        a I FLOATS + F@ b I FLOATS + F@ F* F+
+    LOOP ;
+
+: bench-loop ( -- ) reps 0 DO loop-fv+ loop-fdot FDROP LOOP ;
+: bench-simd ( -- ) reps 0 DO a b c n FV+ a b n FDOT FDROP LOOP ;
+
+init
+NEXT-ARG S" simd" COMPARE 0= [IF] bench-simd [ELSE] bench-loop [THEN]
+c n 1- FLOATS + F@ F. a b n FDOT F. CR
+BYE
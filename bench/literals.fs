@@ -0,0 +1,33 @@
+\ Load a table of 100000 numeric literals through the text interpreter
+\ usage: time ./forth bench/literals.fs
+
+1000 CONSTANT chunk
+100 CONSTANT reps
+
+CREATE table chunk reps * CELLS ALLOT
+VARIABLE filled
+
+\ source text of a chunk of literals followed by store-chunk
+CREATE text chunk 12 * ALLOT
+VARIABLE text-size
+
+: append ( c-addr u -- )
+    DUP >R text text-size @ + SWAP MOVE
+    R> text-size +! ;
+
+: store-chunk ( x1 .. xn -- )
+    filled @ chunk + DUP filled !
+    chunk 0 DO 1- DUP >R CELLS table + ! R> LOOP DROP ;
+
+: make-text ( -- )
+    0 text-size !
+    chunk 0 DO
+        I 7919 * 1000003 MOD 0 <# #S #> append S"  " append
+    LOOP
+    S" store-chunk" append ;
+
+make-text
+: bench ( -- ) reps 0 DO text text-size @ EVALUATE LOOP ;
+bench
+filled @ . table CELL+ @ . CR
+BYE
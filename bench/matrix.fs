@@ -0,0 +1,33 @@
+\ MAT* against the equivalent Forth loops
+\ usage: time ./forth bench/matrix.fs [loop|mat]
+
+100 CONSTANT n
+
+CREATE a n n * FLOATS ALLOT
+CREATE b n n * FLOATS ALLOT
+CREATE c n n * FLOATS ALLOT
+
+: m@ ( addr row col -- ) ( F: -- r ) SWAP n * + FLOATS + F@ ;
+: m! ( addr row col -- ) ( F: r -- ) SWAP n * + FLOATS + F! ;
+
+: init ( -- )
+    n n * 0 DO
+        I 7 MOD S>F a I FLOATS + F!
+        I 5 MOD S>F b I FLOATS + F!
+    LOOP ;
+
+: loop-mat* { | row col -- }
+    n 0 DO I TO row
+        n 0 DO I TO col
+            0E0 n 0 DO a row I m@ b I col m@ F* F+ LOOP
+            c row col m!
+        LOOP
+    LOOP ;
+
+: bench-loop ( -- ) 10 0 DO loop-mat* LOOP ;
+: bench-mat ( -- ) 10 0 DO a b c n n n MAT* LOOP ;
+
+init
+NEXT-ARG S" mat" COMPARE 0= [IF] bench-mat [ELSE] bench-loop [THEN]
+c n n * FSUM F. CR
+BYE
@@ -0,0 +1,27 @@
+\ Number formatting and parsing
+\ usage: time ./forth bench/numbers.fs [format|parse|print] > /dev/null
+
+200000 CONSTANT n
+
+: format-numbers ( -- )
+    n 0 DO
+        I 7919 * S>D TUCK DABS <# #S ROT SIGN #> 2DROP
+        I S>F 1.5E0 F* PAD 15 REPRESENT 2DROP DROP
+    LOOP ;
+
+: print-numbers ( -- )
+    n 0 DO
+        I 7919 * . I S>F 1.5E0 F* F. CR
+    LOOP ;
+
+: parse-numbers ( -- )
+    n 0 DO
+        0. S" 1234567890" >NUMBER 2DROP 2DROP
+        S" 12345.6789E-3" >FLOAT IF FDROP THEN
+    LOOP ;
+
+NEXT-ARG 2DUP S" format" COMPARE 0= [IF] 2DROP format-numbers
+[ELSE] 2DUP S" parse" COMPARE 0= [IF] 2DROP parse-numbers
+[ELSE] S" print" COMPARE 0= [IF] print-numbers
+[ELSE] format-numbers parse-numbers print-numbers [THEN] [THEN] [THEN]
+BYE
@@ -0,0 +1,35 @@
+\ Build and free linked lists with POOL-ALLOC against ALLOCATE
+\ usage: time ./forth bench/pool.fs [pool|allocate]
+
+10000 CONSTANT n
+20 CONSTANT reps
+2 CELLS CONSTANT node-size          \ link, value
+
+node-size n POOL CONSTANT nodes
+
+: new-pool ( -- addr ) nodes POOL-ALLOC ;
+: free-pool ( addr -- ) nodes POOL-FREE ;
+: new-heap ( -- addr ) node-size ALLOCATE THROW ;
+: free-heap ( addr -- ) FREE THROW ;
+
+DEFER new-node
+DEFER free-node
+
+: build ( -- list )
+    0 n 0 DO new-node TUCK ! I OVER CELL+ ! LOOP ;
+
+: sum-free ( list -- n )
+    0 SWAP BEGIN ?DUP WHILE
+        DUP CELL+ @ ROT + SWAP
+        DUP @ SWAP free-node
+    REPEAT ;
+
+: bench ( -- n ) 0 reps 0 DO build sum-free + LOOP ;
+
+NEXT-ARG S" allocate" COMPARE 0= [IF]
+    ' new-heap IS new-node ' free-heap IS free-node
+[ELSE]
+    ' new-pool IS new-node ' free-pool IS free-node
+[THEN]
+bench . CR
+BYE
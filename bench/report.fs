@@ -0,0 +1,21 @@
+\ Report generation: many small writes with EMIT, TYPE, . and CR
+\ usage: time ./forth bench/report.fs > /dev/null
+
+100000 CONSTANT n
+
+: rule ( -- )
+    40 0 DO [CHAR] - EMIT LOOP CR ;
+
+: row ( i -- )
+    S" item " TYPE DUP 6 .R
+    SPACE [CHAR] | EMIT SPACE DUP 37 * 1000 MOD 5 .R
+    SPACE [CHAR] | EMIT SPACE 3 * . CR ;
+
+: report ( -- )
+    n 0 DO
+        I 20 MOD 0= IF rule THEN
+        I row
+    LOOP rule ;
+
+report
+BYE
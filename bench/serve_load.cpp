@@ -0,0 +1,127 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+// Load generator for forth --serve: send the same request from several
+// clients and show the requests per second and the latency percentiles
+// usage: make bench && bench/serve_load socket [clients [requests [source]]]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const char* default_source =
+    ": work 1000 0 DO I DUP * DROP LOOP ; work 6 7 * .";
+
+using Clock = std::chrono::steady_clock;
+
+static bool send_request(const char* socket_path, const std::string& source,
+                         std::string& reply) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            write(fd, source.data(), source.size()) !=
+            static_cast<ssize_t>(source.size())) {
+        close(fd);
+        return false;
+    }
+    shutdown(fd, SHUT_WR);
+
+    reply.clear();
+    char buffer[4096];
+    ssize_t size;
+    while ((size = read(fd, buffer, sizeof(buffer))) > 0) {
+        reply.append(buffer, size);
+    }
+    close(fd);
+    return size == 0;
+}
+
+static void run_client(const char* socket_path, const std::string& source,
+                       int num_requests, std::vector<double>& latencies,
+                       int& errors) {
+    std::string reply;
+    for (int i = 0; i < num_requests; i++) {
+        auto start = Clock::now();
+        bool ok = send_request(socket_path, source, reply);
+        std::chrono::duration<double, std::micro> elapsed = Clock::now() - start;
+        if (ok && reply.compare(0, 10, "status: 0\n") == 0) {
+            latencies.push_back(elapsed.count());
+        }
+        else {
+            errors++;
+        }
+    }
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: serve_load socket [clients [requests [source]]]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    const char* socket_path = argv[1];
+    int num_clients = argc > 2 ? atoi(argv[2]) : 4;
+    int num_requests = argc > 3 ? atoi(argv[3]) : 10000;
+    std::string source = argc > 4 ? argv[4] : default_source;
+    num_clients = std::max(1, num_clients);
+
+    std::vector<std::vector<double>> latencies(num_clients);
+    std::vector<int> errors(num_clients);
+    std::vector<std::thread> clients;
+    auto start = Clock::now();
+    for (int i = 0; i < num_clients; i++) {
+        int count = num_requests / num_clients +
+                    (i < num_requests % num_clients ? 1 : 0);
+        clients.emplace_back(run_client, socket_path, std::cref(source), count,
+                             std::ref(latencies[i]), std::ref(errors[i]));
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    std::vector<double> all;
+    int total_errors = 0;
+    for (int i = 0; i < num_clients; i++) {
+        all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+        total_errors += errors[i];
+    }
+    std::sort(all.begin(), all.end());
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "clients:    " << num_clients << std::endl
+              << "requests:   " << all.size() << std::endl
+              << "errors:     " << total_errors << std::endl
+              << "seconds:    " << elapsed.count() << std::endl
+              << "requests/s: " << all.size() / elapsed.count() << std::endl
+              << "p50 (us):   " << percentile(all, 50) << std::endl
+              << "p99 (us):   " << percentile(all, 99) << std::endl;
+    return total_errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,86 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+// Run the same script on 1..N threads, each one with its own VM, and show
+// the throughput relative to one thread
+// usage: make bench && bench/vm_threads [threads [source]]
+// the source is interpreted as a single string and must not call BYE
+
+#include "libforth.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char* default_script =
+    ": fib ( n -- n ) DUP 2 < IF EXIT THEN DUP 1- RECURSE SWAP 2 - RECURSE + ; "
+    ": work 0 3000000 0 DO I XOR I 3 * + LOOP DROP 27 fib DROP ; "
+    "work ";
+
+static void run_script(const std::string& script) {
+    ForthVM* vm = forth_create();
+    if (forth_evaluate(vm, script.c_str()) != 0) {
+        std::cerr << forth_error_message(vm) << std::endl;
+    }
+    forth_destroy(vm);
+}
+
+static double run_threads(int num_threads, const std::string& script) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+        threads.emplace_back(run_script, script);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (argc > 1) {
+        max_threads = atoi(argv[1]);
+    }
+    if (max_threads < 1) {
+        max_threads = 1;
+    }
+
+    std::string script = default_script;
+    if (argc > 2) {
+        std::ifstream ifs(argv[2], std::ios::binary);
+        if (!ifs.is_open()) {
+            std::cerr << "Cannot open " << argv[2] << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::ostringstream oss;
+        oss << ifs.rdbuf();
+        script = oss.str();
+    }
+
+    double base = 0.0;
+    std::cout << "threads  seconds  scripts/s  speedup" << std::endl;
+    for (int n = 1; n <= max_threads; n++) {
+        double seconds = run_threads(n, script);
+        double rate = n / seconds;
+        if (n == 1) {
+            base = rate;
+        }
+        std::cout << std::setw(7) << n << ' '
+                  << std::setw(8) << std::fixed << std::setprecision(3)
+                  << seconds << ' '
+                  << std::setw(10) << std::setprecision(2) << rate << ' '
+                  << std::setw(8) << rate / base << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
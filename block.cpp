@@ -11,7 +11,7 @@
 #include <cassert>
 #include <cstring>
 
-void Block::init(uint index, int blk) {
+void Block::init(ucell index, cell blk) {
     this->index = index;
     this->blk = blk;
     this->dirty = false;
@@ -20,7 +20,7 @@ void Block::init(uint index, int blk) {
 
 char* Block::data() const {
     assert(index < NUM_BLK_BUFFERS);
-    return vm.block_data + index * BLOCK_SZ;
+    return vm->block_data + index * BLOCK_SZ;
 }
 
 //-----------------------------------------------------------------------------
@@ -32,31 +32,31 @@ void Blocks::init() {
 void Blocks::deinit() {
     if (block_file_id_ != 0) {
         Error error_code = Error::None;
-        vm.files.close(block_file_id_, error_code);
+        vm->files.close(block_file_id_, error_code);
         if (error_code != Error::None) {
             error(error_code, BLOCKS_FILE);
         }
     }
 }
 
-int Blocks::num_blocks() {
-    uint file_id = block_file_id();
+cell Blocks::num_blocks() {
+    ucell file_id = block_file_id();
     Error error_code = Error::None;
-    udint size = vm.files.size(file_id, error_code);
+    udint size = vm->files.size(file_id, error_code);
     if (error_code != Error::None) {
         error(error_code, BLOCKS_FILE);
     }
 
-    int num_blocks = static_cast<int>(size / BLOCK_SZ);
+    cell num_blocks = static_cast<cell>(size / BLOCK_SZ);
     return num_blocks;
 }
 
-Block* Blocks::f_block(int blk) {
+Block* Blocks::f_block(cell blk) {
     if (blk < 1) {
         error(Error::InvalidBlockNumber);
     }
 
-    int index = find_buffer_index(blk);     // already exists, do not init
+    cell index = find_buffer_index(blk);     // already exists, do not init
     if (index < 0) {
         index = find_first_unused();
         read_block(index, blk);
@@ -76,13 +76,13 @@ Block* Blocks::f_block(int blk) {
 }
 
 void Blocks::f_empty_buffers() {
-    for (int i = 0; i < NUM_BLK_BUFFERS; ++i) {
+    for (cell i = 0; i < NUM_BLK_BUFFERS; ++i) {
         blocks_[i].init(i, 0);
     }
 }
 
 void Blocks::f_save_buffers() {
-    for (int i = 0; i < NUM_BLK_BUFFERS; ++i) {
+    for (cell i = 0; i < NUM_BLK_BUFFERS; ++i) {
         flush_block(i);
     }
 }
@@ -92,40 +92,40 @@ void Blocks::f_flush() {
     f_empty_buffers();
 }
 
-void Blocks::f_list(int blk) {
+void Blocks::f_list(cell blk) {
     if (blk < 1) {
         error(Error::InvalidBlockNumber);
     }
 
-    vm.user->SCR = blk;
+    vm->user->SCR = blk;
     Block* block = f_block(blk);
     char* block_data = block->data();
 
-    int save_base = vm.user->BASE;
-    vm.user->BASE = 10;
+    cell save_base = vm->user->BASE;
+    vm->user->BASE = 10;
 
-    std::cout << std::endl << "Block ";
+    vm->out << std::endl << "Block ";
     print_number(blk);
-    std::cout << std::endl;
-    for (int row = 0; row < BLOCK_ROWS; ++row) {
+    vm->out << std::endl;
+    for (cell row = 0; row < BLOCK_ROWS; ++row) {
         print_number(row + 1, 2);
-        std::cout << BL;
-        for (int col = 0; col < BLOCK_COLS; ++col) {
+        vm->out << BL;
+        for (cell col = 0; col < BLOCK_COLS; ++col) {
             char c = block_data[row * BLOCK_COLS + col];
             if (is_print(c)) {
-                std::cout << c;
+                vm->out << c;
             }
             else {
-                std::cout << "?";
+                vm->out << "?";
             }
         }
-        std::cout << std::endl;
+        vm->out << std::endl;
     }
 
-    vm.user->BASE = save_base;
+    vm->user->BASE = save_base;
 }
 
-void Blocks::f_load(int blk) {
+void Blocks::f_load(cell blk) {
     if (blk < 1) {
         error(Error::InvalidBlockNumber);
     }
@@ -133,18 +133,18 @@ void Blocks::f_load(int blk) {
     Block* block = f_block(blk);
 
     // save input context
-    vm.input.save_input();
+    vm->input.save_input();
 
     // parse string
-    vm.input.set_block(block);
+    vm->input.set_block(block);
     f_execute(xtINTERPRET);
 
     // restore input context
-    vm.input.restore_input();
+    vm->input.restore_input();
 }
 
-void Blocks::f_thru(int first, int last) {
-    for (int i = first; i <= last; ++i) {
+void Blocks::f_thru(cell first, cell last) {
+    for (cell i = first; i <= last; ++i) {
         f_load(i);
     }
 }
@@ -153,9 +153,9 @@ void Blocks::f_update() {
     blocks_[last_block_].dirty = true;
 }
 
-uint Blocks::block_file_id() {
+ucell Blocks::block_file_id() {
     if (block_file_id_ == 0) {
-        block_file_id_ = vm.files.open_or_create(BLOCKS_FILE);
+        block_file_id_ = vm->files.open_or_create(BLOCKS_FILE);
 
         if (block_file_id_ == 0) {
             error(Error::OpenFileException, BLOCKS_FILE);
@@ -165,21 +165,21 @@ uint Blocks::block_file_id() {
     return block_file_id_;
 }
 
-bool Blocks::seek_block(int blk) {
+bool Blocks::seek_block(cell blk) {
     if (blk < 0) {
         error(Error::InvalidBlockNumber);
     }
 
-    uint file_id = block_file_id();
+    ucell file_id = block_file_id();
     Error error_code = Error::None;
     std::streampos fpos = blk * BLOCK_SZ;
-    vm.files.seek(file_id, fpos, error_code);
+    vm->files.seek(file_id, fpos, error_code);
     if (error_code != Error::None) {
         error(error_code, BLOCKS_FILE);
     }
 
     // verify actual position
-    std::streampos actual_pos = vm.files.tell(file_id, error_code);
+    std::streampos actual_pos = vm->files.tell(file_id, error_code);
     if (error_code != Error::None) {
         error(error_code, BLOCKS_FILE);
     }
@@ -191,12 +191,12 @@ bool Blocks::seek_block(int blk) {
     return true;    // seek successful
 }
 
-int Blocks::find_buffer_index(int blk) const {
+cell Blocks::find_buffer_index(cell blk) const {
     if (blk < 0) {
         error(Error::InvalidBlockNumber);
     }
 
-    for (int i = 0; i < NUM_BLK_BUFFERS; ++i) {
+    for (cell i = 0; i < NUM_BLK_BUFFERS; ++i) {
         if (blocks_[i].blk == blk) {
             return i;
         }
@@ -204,9 +204,9 @@ int Blocks::find_buffer_index(int blk) const {
     return -1;
 }
 
-int Blocks::find_first_unused() const {
-    int j = last_block_;
-    for (int i = 0; i < NUM_BLK_BUFFERS; ++i) {
+cell Blocks::find_first_unused() const {
+    cell j = last_block_;
+    for (cell i = 0; i < NUM_BLK_BUFFERS; ++i) {
         j = (j + 1) % NUM_BLK_BUFFERS;
         if (blocks_[j].blk == 0) {
             return j;
@@ -215,9 +215,9 @@ int Blocks::find_first_unused() const {
     return -1;
 }
 
-int Blocks::find_first_not_dirty() const {
-    int j = last_block_;
-    for (int i = 0; i < NUM_BLK_BUFFERS; ++i) {
+cell Blocks::find_first_not_dirty() const {
+    cell j = last_block_;
+    for (cell i = 0; i < NUM_BLK_BUFFERS; ++i) {
         j = (j + 1) % NUM_BLK_BUFFERS;
         if (blocks_[j].blk != 0 && !blocks_[j].dirty) {
             return j;
@@ -226,7 +226,7 @@ int Blocks::find_first_not_dirty() const {
     return -1;
 }
 
-void Blocks::flush_block(int index) {
+void Blocks::flush_block(cell index) {
     assert(index >= 0 && index < NUM_BLK_BUFFERS);
 
     if (blocks_[index].blk > 0) {
@@ -237,7 +237,7 @@ void Blocks::flush_block(int index) {
     }
 }
 
-bool Blocks::read_block(int index, int blk) {
+bool Blocks::read_block(cell index, cell blk) {
     assert(index >= 0 && index < NUM_BLK_BUFFERS);
     if (blk < 0) {
         error(Error::InvalidBlockNumber);
@@ -249,9 +249,9 @@ bool Blocks::read_block(int index, int blk) {
         return false;    // seek failed
     }
 
-    uint file_id = block_file_id();
+    ucell file_id = block_file_id();
     Error error_code = Error::None;
-    uint num_read = vm.files.read_bytes(file_id,
+    ucell num_read = vm->files.read_bytes(file_id,
                                         blocks_[index].data(), BLOCK_SZ,
                                         error_code);
     if (error_code != Error::None) {
@@ -266,10 +266,10 @@ bool Blocks::read_block(int index, int blk) {
     }
 }
 
-bool Blocks::write_block(int index) {
+bool Blocks::write_block(cell index) {
     assert(index >= 0 && index < NUM_BLK_BUFFERS);
 
-    int blk = blocks_[index].blk;
+    cell blk = blocks_[index].blk;
     if (blk < 0) {
         error(Error::InvalidBlockNumber);
     }
@@ -278,9 +278,9 @@ bool Blocks::write_block(int index) {
         return false;    // seek failed
     }
 
-    uint file_id = block_file_id();
+    ucell file_id = block_file_id();
     Error error_code = Error::None;
-    vm.files.write_bytes(file_id,
+    vm->files.write_bytes(file_id,
                          blocks_[index].data(), BLOCK_SZ,
                          error_code);
     if (error_code != Error::None) {
@@ -291,40 +291,40 @@ bool Blocks::write_block(int index) {
 }
 
 void f_block() {
-    int blk = pop();
-    Block* block = vm.blocks.f_block(blk);
+    cell blk = pop();
+    Block* block = vm->blocks.f_block(blk);
     const char* buffer = block->data();
     push(mem_addr(buffer));
 }
 
 void f_save_buffers() {
-    vm.blocks.f_save_buffers();
+    vm->blocks.f_save_buffers();
 }
 
 void f_empty_buffers() {
-    vm.blocks.f_empty_buffers();
+    vm->blocks.f_empty_buffers();
 }
 
 void f_flush() {
-    vm.blocks.f_flush();
+    vm->blocks.f_flush();
 }
 
 void f_load() {
-    int blk = pop();
-    vm.blocks.f_load(blk);
+    cell blk = pop();
+    vm->blocks.f_load(blk);
 }
 
 void f_update() {
-    vm.blocks.f_update();
+    vm->blocks.f_update();
 }
 
 void f_list() {
-    int blk = pop();
-    vm.blocks.f_list(blk);
+    cell blk = pop();
+    vm->blocks.f_list(blk);
 }
 
 void f_thru() {
-    int last = pop();
-    int first = pop();
-    vm.blocks.f_thru(first, last);
+    cell last = pop();
+    cell first = pop();
+    vm->blocks.f_thru(first, last);
 }
@@ -11,14 +11,14 @@
 #include <fstream>
 
 struct Block {
-    uint index;         // sequence number of block
-    int blk;            // block numnber mapped to this buffer, 0 if none
+    ucell index;         // sequence number of block
+    cell blk;            // block numnber mapped to this buffer, 0 if none
     bool dirty;         // true if needs to be written to file
 
-    void init(uint index, int blk);
+    void init(ucell index, cell blk);
     char* data() const;
 
-    // buffer stored in vm.block_data
+    // buffer stored in vm->block_data
 };
 
 class Blocks {
@@ -26,31 +26,31 @@ public:
     void init();
     void deinit();
 
-    int num_blocks();
-    Block* f_block(int blk);
+    cell num_blocks();
+    Block* f_block(cell blk);
     void f_empty_buffers();
     void f_save_buffers();
     void f_flush();
-    void f_list(int blk);
-    void f_load(int blk);
-    void f_thru(int first, int last);
+    void f_list(cell blk);
+    void f_load(cell blk);
+    void f_thru(cell first, cell last);
     void f_update();
 
 private:
-    uint block_file_id_;                // file handle
+    ucell block_file_id_;                // file handle
     Block blocks_[NUM_BLK_BUFFERS];     // block buffers
-    int last_block_;                    // index of last block referenced
+    cell last_block_;                    // index of last block referenced
 
-    uint block_file_id();               // get block file handle
-    bool seek_block(int blk);           // seek to block position
+    ucell block_file_id();               // get block file handle
+    bool seek_block(cell blk);           // seek to block position
 
-    int find_buffer_index(int blk) const;   // -1 if not found
-    int find_first_unused() const;      // -1 if not found
-    int find_first_not_dirty() const;   // -1 if not found
-    void flush_block(int index);        // flush to file if dirty, init
+    cell find_buffer_index(cell blk) const;   // -1 if not found
+    cell find_first_unused() const;      // -1 if not found
+    cell find_first_not_dirty() const;   // -1 if not found
+    void flush_block(cell index);        // flush to file if dirty, init
 
-    bool read_block(int index, int blk);
-    bool write_block(int index);
+    bool read_block(cell index, cell blk);
+    bool write_block(cell index);
 };
 
 void f_block();
@@ -0,0 +1,153 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#include "channels.h"
+#include "errors.h"
+#include "vm.h"
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+// channels of all the VMs, the id is the index plus one
+static const ucell MAX_CHANNELS = 4096;
+static const ucell MAX_CHANNEL_SZ = 1 << 24;
+static std::atomic<Channel*> channels[MAX_CHANNELS];
+static std::atomic<ucell> num_channels{ 0 };
+
+// each slot has a sequence number that tells if it can be written in the
+// current lap of the senders or read in the current lap of the receivers
+Channel::Channel(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+    slots_ = std::make_unique<Slot[]>(size);
+    mask_ = size - 1;
+    for (size_t i = 0; i < size; i++) {
+        slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool Channel::try_send(cell value) {
+    size_t pos = send_pos_.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = slots_[pos & mask_];
+        size_t seq = slot.seq.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (send_pos_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                slot.value = value;
+                slot.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            return false;       // full
+        }
+        else {
+            pos = send_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool Channel::try_receive(cell& value) {
+    size_t pos = receive_pos_.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = slots_[pos & mask_];
+        size_t seq = slot.seq.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) -
+                        static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (receive_pos_.compare_exchange_weak(pos, pos + 1,
+                                                   std::memory_order_relaxed)) {
+                value = slot.value;
+                slot.seq.store(pos + mask_ + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            return false;       // empty
+        }
+        else {
+            pos = receive_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+static Channel* find_channel(ucell id) {
+    Channel* channel = nullptr;
+    if (id > 0 && id <= num_channels.load(std::memory_order_acquire)) {
+        channel = channels[id - 1].load(std::memory_order_acquire);
+    }
+    if (channel == nullptr) {
+        error(Error::InvalidNumericArgument, "channel " + std::to_string(id));
+    }
+    return channel;
+}
+
+// let the other tasks run, or the other threads if there are no tasks
+static void wait_channel(unsigned& spins) {
+    if (vm->tasks.multitasking()) {
+        vm->tasks.wait();
+    }
+    else if (spins < 64) {
+        spins++;
+        std::this_thread::yield();
+    }
+    else {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+void f_channel() {
+    cell capacity = pop();
+    if (capacity < 1 || static_cast<ucell>(capacity) > MAX_CHANNEL_SZ) {
+        error(Error::InvalidNumericArgument, std::to_string(capacity));
+    }
+    ucell index = num_channels.load(std::memory_order_relaxed);
+    do {
+        if (index >= MAX_CHANNELS) {
+            error(Error::AllocateException, "too many channels");
+        }
+    } while (!num_channels.compare_exchange_weak(index, index + 1));
+    channels[index].store(new Channel(capacity), std::memory_order_release);
+    push(index + 1);
+}
+
+void f_send() {
+    Channel* channel = find_channel(pop());
+    cell value = pop();
+    unsigned spins = 0;
+    while (!channel->try_send(value)) {
+        wait_channel(spins);
+    }
+    vm->tasks.progress();
+}
+
+void f_receive() {
+    Channel* channel = find_channel(pop());
+    cell value;
+    unsigned spins = 0;
+    while (!channel->try_receive(value)) {
+        wait_channel(spins);
+    }
+    vm->tasks.progress();
+    push(value);
+}
+
+void f_try_receive() {
+    Channel* channel = find_channel(pop());
+    cell value;
+    if (channel->try_receive(value)) {
+        vm->tasks.progress();
+        push(value);
+        push(F_TRUE);
+    }
+    else {
+        push(F_FALSE);
+    }
+}
@@ -0,0 +1,41 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "forth.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// bounded queue of cells shared by the tasks of a VM and by the VMs of
+// different threads; lock-free for any number of senders and receivers
+// (D. Vyukov's bounded MPMC queue)
+class Channel {
+public:
+    explicit Channel(size_t capacity);
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    bool try_send(cell value);
+    bool try_receive(cell& value);
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        cell value;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> send_pos_{ 0 };
+    alignas(64) std::atomic<size_t> receive_pos_{ 0 };
+};
+
+void f_channel();
+void f_send();
+void f_receive();
+void f_try_receive();
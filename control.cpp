@@ -7,23 +7,46 @@
 #include "control.h"
 #include "dict.h"
 #include "errors.h"
+#include "interp.h"
 #include "locals.h"
+#include "optimizer.h"
 #include "vm.h"
 #include <vector>
 
+static void start_definition() {
+    vm->locals.clear();
+    vm->last_call = 0;
+    vm->last_back_target = 0;
+    vm->fwd_jumps.clear();
+    vm->literals.clear();
+}
+
+bool is_jump_target(ucell start, ucell end) {
+    if (vm->last_back_target > start && vm->last_back_target <= end) {
+        return true;
+    }
+    for (ucell operand : vm->fwd_jumps) {
+        ucell target = operand + fetch(operand);
+        if (target > start && target <= end) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void f_colon() {
     if (cs_ddepth() > 0) {
         error(Error::CompilerNesting);
     }
 
-    vm.locals.clear();
+    start_definition();
 
     cs_dpush(mk_dcell(POS_COLON_START, 0));
-    vm.dict.parse_create(idXDOCOL, F_SMUDGE);
-    vm.user->STATE = STATE_COMPILE;
+    vm->dict.parse_create(idXDOCOL, F_SMUDGE);
+    vm->user->STATE = STATE_COMPILE;
 
-    if (vm.user->TRACE) {
-        vm.cs_stack.print_debug();
+    if (vm->user->TRACE) {
+        vm->cs_stack.print_debug(vm->out);
     }
 }
 
@@ -32,17 +55,17 @@ void f_colon_noname() {
         error(Error::CompilerNesting);
     }
 
-    vm.locals.clear();
+    start_definition();
 
     cs_dpush(mk_dcell(POS_COLON_START, 0));
-    vm.dict.create("", F_SMUDGE, idXDOCOL);
+    vm->dict.create("", F_SMUDGE, idXDOCOL);
     Header* header = reinterpret_cast<Header*>(
-                         mem_char_ptr(vm.latest_word));
-    vm.user->STATE = STATE_COMPILE;
+                         mem_char_ptr(vm->latest_word));
+    vm->user->STATE = STATE_COMPILE;
     push(header->xt());
 
-    if (vm.user->TRACE) {
-        vm.cs_stack.print_debug();
+    if (vm->user->TRACE) {
+        vm->cs_stack.print_debug(vm->out);
     }
 }
 
@@ -57,26 +80,67 @@ void f_semicolon() {
     }
     cs_dpop();
 
-    vm.locals.clear();
+    compile_exit();
+    vm->locals.clear();
 
-    comma(xtEXIT);
     Header* header = reinterpret_cast<Header*>(
-                         mem_char_ptr(vm.latest_word));
+                         mem_char_ptr(vm->latest_word));
     header->flags.smudge = false;
-    vm.user->STATE = STATE_INTERPRET;
+    vm->user->STATE = STATE_INTERPRET;
 
-    if (vm.user->TRACE) {
-        vm.cs_stack.print_debug();
+    optimize_definition(header);
+
+    if (vm->user->TRACE) {
+        vm->cs_stack.print_debug(vm->out);
     }
 }
 
 void f_recurse() {
     Header* header = reinterpret_cast<Header*>(
-                         mem_char_ptr(vm.latest_word));
+                         mem_char_ptr(vm->latest_word));
     comma(header->xt());
+    vm->last_call = vm->here - CELL_SZ;
+}
+
+// replace a call to a colon definition followed by EXIT by a jump that
+// reuses the return address of the caller
+static bool compile_tail_call() {
+    if (vm->user->TRACE ||
+            vm->last_call == 0 || vm->last_call != vm->here - CELL_SZ ||
+            vm->last_back_target == vm->here) {
+        return false;
+    }
+
+    // forward jumps to the EXIT have to skip the inserted cell
+    for (ucell operand : vm->fwd_jumps) {
+        if (operand + fetch(operand) == vm->here) {
+            store(operand, fetch(operand) + CELL_SZ);
+        }
+    }
+
+    ucell xt = fetch(vm->last_call);
+    store(vm->last_call, xtXTAIL_CALL);
+    comma(xt);
+    vm->last_call = 0;
+    return true;
+}
+
+void compile_exit() {
+    if (vm->locals.has_frame()) {
+        comma(xtXLEAVE_FRAME);
+    }
+    else {
+        compile_tail_call();
+    }
+    comma(xtEXIT);
+}
+
+void f_xtail_call() {
+    ucell xt = fetch(vm->ip);
+    tail_func(xt + CELL_SZ);
 }
 
-static void comma_fwd_jump(uint xt_jump, int pos) {
+static void comma_fwd_jump(ucell xt_jump, cell pos) {
     if (pos != POS_IF_FWD &&
             pos != POS_ELSE_FWD &&
             pos != POS_WHILE_FWD &&
@@ -88,11 +152,11 @@ static void comma_fwd_jump(uint xt_jump, int pos) {
     }
 
     comma(xt_jump);
-    cs_dpush(mk_dcell(pos, vm.here));
+    cs_dpush(mk_dcell(pos, vm->here));
     comma(0);
 
-    if (vm.user->TRACE) {
-        vm.cs_stack.print_debug();
+    if (vm->user->TRACE) {
+        vm->cs_stack.print_debug(vm->out);
     }
 }
 
@@ -113,29 +177,31 @@ static void resolve_fwd_jump() {
     }
     cs_dpop();
 
-    int dist = vm.here - dcell_lo(pos_patch);
+    cell dist = vm->here - dcell_lo(pos_patch);
     store(dcell_lo(pos_patch), dist);
+    vm->fwd_jumps.push_back(dcell_lo(pos_patch));
 
-    if (vm.user->TRACE) {
-        vm.cs_stack.print_debug();
+    if (vm->user->TRACE) {
+        vm->cs_stack.print_debug(vm->out);
     }
 }
 
-static void mark_target_back_jump(int pos) {
+static void mark_target_back_jump(cell pos) {
     if (pos != POS_BEGIN_BACK &&
             pos != POS_DO_BACK) {
         error(Error::ControlStructureMismatch);
     }
 
-    uint addr = vm.here;
+    ucell addr = vm->here;
     cs_dpush(mk_dcell(pos, addr));
+    vm->last_back_target = addr;
 
-    if (vm.user->TRACE) {
-        vm.cs_stack.print_debug();
+    if (vm->user->TRACE) {
+        vm->cs_stack.print_debug(vm->out);
     }
 }
 
-static void resolve_back_jump(uint xt_jump) {
+static void resolve_back_jump(ucell xt_jump) {
     if (cs_ddepth() < 1) {
         error(Error::ControlStructureMismatch);
     }
@@ -148,11 +214,11 @@ static void resolve_back_jump(uint xt_jump) {
     cs_dpop();
 
     comma(xt_jump);
-    int dist = dcell_lo(pos_patch) - vm.here;
+    cell dist = dcell_lo(pos_patch) - vm->here;
     comma(dist);
 }
 
-static bool search_resolve_fwd_jump(int pos1, int pos2 = -1, int pos3 = -1) {
+static bool search_resolve_fwd_jump(cell pos1, cell pos2 = -1, cell pos3 = -1) {
     std::vector<dint> save;
     bool resolved = false;
     while (cs_ddepth() > 0) {
@@ -173,15 +239,15 @@ static bool search_resolve_fwd_jump(int pos1, int pos2 = -1, int pos3 = -1) {
         save.pop_back();
     }
 
-    if (vm.user->TRACE) {
-        vm.cs_stack.print_debug();
+    if (vm->user->TRACE) {
+        vm->cs_stack.print_debug(vm->out);
     }
 
     return resolved;
 }
 
-static bool resolve_all_fwd_jumps(int stop,
-                                  int pos1, int pos2 = -1, int pos3 = -1) {
+static bool resolve_all_fwd_jumps(cell stop,
+                                  cell pos1, cell pos2 = -1, cell pos3 = -1) {
     bool resolved = false;
     while (cs_ddepth() > 0) {
         dint pos_target = cs_dpeek();
@@ -201,15 +267,15 @@ static bool resolve_all_fwd_jumps(int stop,
         }
     }
 
-    if (vm.user->TRACE) {
-        vm.cs_stack.print_debug();
+    if (vm->user->TRACE) {
+        vm->cs_stack.print_debug(vm->out);
     }
 
     return resolved;
 }
 
-static bool search_resolve_back_jump(int jump_xt,
-                                     int pos1, int pos2 = -1, int pos3 = -1) {
+static bool search_resolve_back_jump(cell jump_xt,
+                                     cell pos1, cell pos2 = -1, cell pos3 = -1) {
     std::vector<dint> save;
     bool resolved = false;
     while (cs_ddepth() > 0) {
@@ -230,8 +296,8 @@ static bool search_resolve_back_jump(int jump_xt,
         save.pop_back();
     }
 
-    if (vm.user->TRACE) {
-        vm.cs_stack.print_debug();
+    if (vm->user->TRACE) {
+        vm->cs_stack.print_debug(vm->out);
     }
 
     return resolved;
@@ -304,12 +370,18 @@ void f_do() {
     mark_target_back_jump(POS_DO_BACK);
 }
 
+static void push_loop(cell start, cell limit) {
+    LoopFrame loop;
+    loop.count = static_cast<ucell>(start) - static_cast<ucell>(limit);
+    loop.limit = limit;
+    vm->loop_stack.push(loop);
+}
+
 void f_xdo() {
-    int start = pop();
-    int limit = pop();
-    r_push(limit);
-    r_push(start);
-    vm.ip += CELL_SZ;
+    cell start = pop();
+    cell limit = pop();
+    push_loop(start, limit);
+    vm->ip += CELL_SZ;
 }
 
 void f_query_do() {
@@ -319,19 +391,18 @@ void f_query_do() {
 }
 
 void f_xquery_do() {
-    int start = pop();
-    int limit = pop();
+    cell start = pop();
+    cell limit = pop();
     if (start != limit) {
-        r_push(limit);
-        r_push(start);
-        vm.ip += CELL_SZ;
+        push_loop(start, limit);
+        vm->ip += CELL_SZ;
     }
     else {
-        vm.ip += fetch(vm.ip);
+        vm->ip += fetch(vm->ip);
     }
 }
 
-static void f_loop_plus_loop(uint xt_jump) {
+static void f_loop_plus_loop(ucell xt_jump) {
     if (!search_resolve_back_jump(xt_jump, POS_DO_BACK)) {
         error(Error::ControlStructureMismatch);
     }
@@ -349,45 +420,49 @@ void f_plus_loop() {
     f_loop_plus_loop(xtXPLUS_LOOP);
 }
 
+// the loop ends when index - limit wraps to zero
+void f_xloop() {
+    LoopFrame& loop = vm->loop_stack.top();
+    if (++loop.count != 0) {    // loop
+        vm->ip += fetch(vm->ip);
+    }
+    else {                      // skip
+        vm->loop_stack.pop();
+        vm->ip += CELL_SZ;
+    }
+}
+
 // ANS Forth expects +LOOP to check if the index crossed the boundary
-static void f_xloop_step(int step) {
-    int old_i = r_pop();
-    int limit = r_pop();
-    int new_i = old_i + step;
-    int old_diff = old_i - limit;
+void f_xplus_loop() {
+    cell step = pop();
+    LoopFrame& loop = vm->loop_stack.top();
+    cell old_diff = static_cast<cell>(loop.count);
+    loop.count += static_cast<ucell>(step);
+    cell new_diff = static_cast<cell>(loop.count);
 
     // crossing code lifted from pforth/Gforth
     // (x^y)<0 is equivalent to (x<0) != (y<0)
     bool crossed =
-        (((old_diff ^ (old_diff + step))    // is the limit crossed?
-          & (old_diff ^ step))            // is it a wrap-around?
+        (((old_diff ^ new_diff)     // is the limit crossed?
+          & (old_diff ^ step))      // is it a wrap-around?
          < 0);
 
     if (!crossed) {     // loop
-        vm.ip += fetch(vm.ip);
-        r_push(limit);
-        r_push(new_i);
+        vm->ip += fetch(vm->ip);
     }
     else {              // skip
-        vm.ip += CELL_SZ;
+        vm->loop_stack.pop();
+        vm->ip += CELL_SZ;
     }
 }
 
-void f_xloop() {
-    f_xloop_step(1);
-}
-
-void f_xplus_loop() {
-    f_xloop_step(pop());
-}
-
 void f_leave() {
     comma_fwd_jump(xtXLEAVE, POS_LEAVE_FWD);
 }
 
 void f_xleave() {
     f_xunloop();
-    vm.ip += fetch(vm.ip);                // jump to end
+    vm->ip += fetch(vm->ip);                // jump to end
 }
 
 void f_unloop() {
@@ -395,15 +470,14 @@ void f_unloop() {
 }
 
 void f_xunloop() {
-    r_pop();                        // drop I
-    r_pop();                        // drop limit
+    vm->loop_stack.pop();
 }
 
 void f_case() {
     cs_dpush(mk_dcell(POS_CASE_START, 0));    // mark start of case
 
-    if (vm.user->TRACE) {
-        vm.cs_stack.print_debug();
+    if (vm->user->TRACE) {
+        vm->cs_stack.print_debug(vm->out);
     }
 }
 
@@ -412,14 +486,14 @@ void f_of() {
 }
 
 void f_xof() {
-    int b = pop();
-    int a = pop();
+    cell b = pop();
+    cell a = pop();
     if (a != b) {
         push(a);                    // keep selector in stack
-        vm.ip += fetch(vm.ip);
+        vm->ip += fetch(vm->ip);
     }
     else {
-        vm.ip += CELL_SZ;    // drop selector and execute code
+        vm->ip += CELL_SZ;    // drop selector and execute code
     }
 }
 
@@ -6,12 +6,31 @@
 
 #pragma once
 
+#include "forth.h"
+
+// DO-loop parameters, the index is kept as index - limit so that LOOP ends
+// when it wraps to zero
+struct LoopFrame {
+    ucell count;        // index - limit
+    cell limit;
+
+    cell index() const {
+        return static_cast<cell>(count + static_cast<ucell>(limit));
+    }
+};
+
 void f_colon();
 void f_colon_noname();
 void f_semicolon();
 
 void f_recurse();
 
+void compile_exit();
+
+// a jump of the current definition lands in start+1 .. end
+bool is_jump_target(ucell start, ucell end);
+void f_xtail_call();
+
 void f_ahead();
 void f_if();
 void f_else();
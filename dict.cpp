@@ -20,28 +20,61 @@ CString* Header::name() const {
     return name;
 }
 
-uint Header::xt() const {
+ucell Header::xt() const {
     return mem_addr(&this->code);
 }
 
-uint Header::body() const {
+ucell Header::body() const {
     return xt() + CELL_SZ;
 }
 
-Header* Header::header(uint xt) {
-    uint addr = xt - offsetof(Header, code);
+Header* Header::header(ucell xt) {
+    ucell addr = xt - offsetof(Header, code);
     return reinterpret_cast<Header*>(mem_char_ptr(addr));
 }
 
-uint Header::get_size() const {
+ucell Header::get_size() const {
     if (size == 0) {
-        return vm.here - body();
+        return vm->here - body();
     }
     else {
         return size;
     }
 }
 
+// FNV-1a hash of the name folded to lower case, each half selects a bit
+static uint64_t name_hash(const char* name, ucell size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (ucell i = 0; i < size; ++i) {
+        uchar c = name[i];
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void NameFilter::clear() {
+    memset(bits_, 0, sizeof(bits_));
+}
+
+void NameFilter::add(const char* name, ucell size) {
+    uint64_t hash = name_hash(name, size);
+    ucell bit1 = static_cast<ucell>(hash % NUM_BITS);
+    ucell bit2 = static_cast<ucell>((hash >> 32) % NUM_BITS);
+    bits_[bit1 / 64] |= 1ULL << (bit1 % 64);
+    bits_[bit2 / 64] |= 1ULL << (bit2 % 64);
+}
+
+bool NameFilter::may_contain(const char* name, ucell size) const {
+    uint64_t hash = name_hash(name, size);
+    ucell bit1 = static_cast<ucell>(hash % NUM_BITS);
+    ucell bit2 = static_cast<ucell>((hash >> 32) % NUM_BITS);
+    return (bits_[bit1 / 64] & (1ULL << (bit1 % 64))) != 0 &&
+           (bits_[bit2 / 64] & (1ULL << (bit2 % 64))) != 0;
+}
+
 void Dict::init() {
     clear();
     check_free_space();
@@ -49,30 +82,32 @@ void Dict::init() {
 }
 
 void Dict::clear() {
-    vm.here = vm.dict_lo_mem;
-    vm.names = vm.dict_hi_mem;
+    vm->here = vm->dict_lo_mem;
+    vm->names = vm->dict_hi_mem;
 
-    vm.latest_word = 0;
+    vm->latest_word = 0;
 
-    vm.wordlists.clear();
-    vm.wordlists.push_back(0); // SYSTEM_WID = 0
+    vm->wordlists.clear();
+    vm->wordlists.push_back(0); // SYSTEM_WID = 0
 
-    vm.search_order.clear();
-    vm.search_order.push_back(SYSTEM_WID);
+    vm->search_order.clear();
+    vm->search_order.push_back(SYSTEM_WID);
 
-    vm.definitions_wid = SYSTEM_WID;
+    vm->definitions_wid = SYSTEM_WID;
+
+    vm->name_filter.clear();
 }
 
-void Dict::allot(int size) {
+void Dict::allot(cell size) {
     check_free_space(size);
-    vm.here += size;
+    vm->here += size;
 }
 
-int Dict::unused() const {
-    return vm.names - vm.here;
+cell Dict::unused() const {
+    return vm->names - vm->here;
 }
 
-uint Dict::parse_create(uint code, int flags) {
+ucell Dict::parse_create(ucell code, cell flags) {
     const CString* name = parse_cword(BL);
     if (name->size() == 0) {
         error(Error::AttemptToUseZeroLengthStringAsName);
@@ -80,131 +115,136 @@ uint Dict::parse_create(uint code, int flags) {
     return create(name, flags, code);
 }
 
-uint Dict::create(const std::string& name, int flags, uint code) {
-    return create(name.c_str(), static_cast<uint>(name.size()), flags, code);
+ucell Dict::create(const std::string& name, cell flags, ucell code) {
+    return create(name.c_str(), static_cast<ucell>(name.size()), flags, code);
 }
 
-uint Dict::create(const char* name, uint size, int flags, uint code) {
+ucell Dict::create(const char* name, ucell size, cell flags, ucell code) {
     align();
-    uint name_addr = alloc_cstring(name, size);
+    ucell name_addr = alloc_cstring(name, size);
     return create_cont(name_addr, flags, code);
 }
 
-uint Dict::create(const CString* name, int flags, uint code) {
+ucell Dict::create(const CString* name, cell flags, ucell code) {
     if (name->size() > MAX_NAME_SZ) {
         error(Error::DefinitionNameTooLong, name->to_string());
     }
 
     align();
-    uint name_addr = alloc_cstring(name);
+    ucell name_addr = alloc_cstring(name);
     return create_cont(name_addr, flags, code);
 }
 
-uint Dict::create_cont(uint name_addr, int flags, uint code) {
+ucell Dict::create_cont(ucell name_addr, cell flags, ucell code) {
     // store header
     check_free_space(sizeof(Header));
 
     // fill previous header size
-    if (vm.latest_word) {
+    if (vm->latest_word) {
         Header* latest_header = reinterpret_cast<Header*>(
-                                    mem_char_ptr(vm.latest_word));
-        uint latest_size = vm.here - latest_header->body();
+                                    mem_char_ptr(vm->latest_word));
+        ucell latest_size = vm->here - latest_header->body();
         latest_header->size = latest_size; // fill size of previous header
     }
 
     // create new header
-    Header* header = reinterpret_cast<Header*>(mem_char_ptr(vm.here));
+    Header* header = reinterpret_cast<Header*>(mem_char_ptr(vm->here));
 
     // link into list of all words
-    header->prev = vm.latest_word;
-    vm.latest_word = vm.here;
+    header->prev = vm->latest_word;
+    vm->latest_word = vm->here;
 
     // link into current wordlist
-    assert(vm.definitions_wid < vm.wordlists.size());
-    header->link = vm.wordlists[vm.definitions_wid];
-    vm.wordlists[vm.definitions_wid] = vm.here;
+    assert(vm->definitions_wid < vm->wordlists.size());
+    header->link = vm->wordlists[vm->definitions_wid];
+    vm->wordlists[vm->definitions_wid] = vm->here;
 
     // fill header
     header->name_addr = name_addr;
+    CString* name = header->name();
+    vm->name_filter.add(name->str(), name->size());
 
     header->flags.smudge = (flags & F_SMUDGE) ? true : false;
     header->flags.hidden = (flags & F_HIDDEN) ? true : false;
     header->flags.immediate = (flags & F_IMMEDIATE) ? true : false;
+    header->flags.effect = false;
+    header->flags.inline_always = false;
+    header->effect_in = header->effect_out = 0;
 
     header->size = 0; // size will be filled by next header
     header->creator_xt = 0; // filled by defining word
     header->does = 0;
     header->code = code;
 
-    vm.here += aligned(sizeof(Header));
+    vm->here += aligned(sizeof(Header));
     return header->xt(); // return xt of word
 }
 
-uint Dict::alloc_cstring(const std::string& str) {
-    return alloc_cstring(str.c_str(), static_cast<uint>(str.size()));
+ucell Dict::alloc_cstring(const std::string& str) {
+    return alloc_cstring(str.c_str(), static_cast<ucell>(str.size()));
 }
 
-uint Dict::alloc_cstring(const char* str, uint size) {
-    CString* str_str = vm.wordbuf.append_cstring(str, size);
+ucell Dict::alloc_cstring(const char* str, ucell size) {
+    CString* str_str = vm->wordbuf.append_cstring(str, size);
     return alloc_cstring(str_str);
 }
 
-uint Dict::alloc_cstring(const CString* str) {
-    uint alloc_size = CString::alloc_size(str->size());
+ucell Dict::alloc_cstring(const CString* str) {
+    ucell alloc_size = CString::alloc_size(str->size());
 
     check_free_space(alloc_size);
 
-    vm.names -= alloc_size;
-    memcpy(mem_char_ptr(vm.names), str, alloc_size);
+    vm->names -= alloc_size;
+    memcpy(mem_char_ptr(vm->names), str, alloc_size);
 
-    return vm.names;
+    return vm->names;
 }
 
-uint Dict::alloc_string(const std::string& str) {
-    return alloc_string(str.c_str(), static_cast<uint>(str.size()));
+ucell Dict::alloc_string(const std::string& str) {
+    return alloc_string(str.c_str(), static_cast<ucell>(str.size()));
 }
 
-uint Dict::alloc_string(const char* str, uint size) {
-    uint alloc_size = LongString::alloc_size(size);
+ucell Dict::alloc_string(const char* str, ucell size) {
+    ucell alloc_size = LongString::alloc_size(size);
 
     check_free_space(alloc_size);
 
-    vm.names -= alloc_size;
-    LongString* lstring = reinterpret_cast<LongString*>(mem_char_ptr(vm.names));
+    vm->names -= alloc_size;
+    LongString* lstring = reinterpret_cast<LongString*>(mem_char_ptr(vm->names));
     lstring->set_string(str, size);
 
-    return vm.names;
+    return vm->names;
 }
 
-uint Dict::alloc_string(const LongString* str) {
+ucell Dict::alloc_string(const LongString* str) {
     return alloc_string(str->str(), str->size());
 }
 
-void Dict::ccomma(int value) {
+void Dict::ccomma(cell value) {
     check_free_space(CHAR_SZ);
-    cstore(vm.here++, value);
+    cstore(vm->here++, value);
 }
 
-void Dict::comma(int value) {
+void Dict::comma(cell value) {
     check_free_space(CELL_SZ);
-    store(vm.here, value);
-    vm.here += CELL_SZ;
+    store(vm->here, value);
+    vm->here += CELL_SZ;
 }
 
 void Dict::dcomma(dint value) {
     check_free_space(DCELL_SZ);
-    dstore(vm.here, value);
-    vm.here += DCELL_SZ;
+    dstore(vm->here, value);
+    vm->here += DCELL_SZ;
 }
 
 void Dict::fcomma(double value) {
     check_free_space(FCELL_SZ);
-    fstore(vm.here, value);
-    vm.here += FCELL_SZ;
+    fstore(vm->here, value);
+    vm->here += FCELL_SZ;
 }
 
 void Dict::align() {
-    vm.here = aligned(vm.here);
+    vm->here = aligned(vm->here);
 }
 
 Header* Dict::parse_find_word() {
@@ -228,13 +268,17 @@ Header* Dict::parse_find_existing_word() {
 }
 
 Header* Dict::find_word(const std::string& name) const {
-    return find_word(name.c_str(), static_cast<uint>(name.size()));
+    return find_word(name.c_str(), static_cast<ucell>(name.size()));
 }
 
-Header* Dict::find_word(const char* name, uint size) const {
+Header* Dict::find_word(const char* name, ucell size) const {
+    if (!vm->name_filter.may_contain(name, size)) {
+        return nullptr;
+    }
+
     // search in search order
-    for (int i = static_cast<int>(vm.search_order.size()) - 1; i >= 0; i--) {
-        uint wid = vm.search_order[i];
+    for (cell i = static_cast<cell>(vm->search_order.size()) - 1; i >= 0; i--) {
+        ucell wid = vm->search_order[i];
         Header* header = find_word_in_wid(name, size, wid);
         if (header != nullptr) {
             return header;
@@ -250,14 +294,14 @@ Header* Dict::find_word(const CString* name) const {
     return find_word(name->str(), name->size());
 }
 
-Header* Dict::find_word_in_wid(const std::string& name, uint wid) const {
+Header* Dict::find_word_in_wid(const std::string& name, ucell wid) const {
     return find_word_in_wid(
-               name.c_str(), static_cast<uint>(name.size()), wid);
+               name.c_str(), static_cast<ucell>(name.size()), wid);
 }
 
-Header* Dict::find_word_in_wid(const char* name, uint size, uint wid) const {
-    assert(wid < vm.wordlists.size());
-    uint ptr = vm.wordlists[wid];
+Header* Dict::find_word_in_wid(const char* name, ucell size, ucell wid) const {
+    assert(wid < vm->wordlists.size());
+    ucell ptr = vm->wordlists[wid];
 
     while (ptr != 0) {
         Header* header = reinterpret_cast<Header*>(mem_char_ptr(ptr));
@@ -278,12 +322,24 @@ Header* Dict::find_word_in_wid(const char* name, uint size, uint wid) const {
     return nullptr;
 }
 
-Header* Dict::find_word_in_wid(const CString* name, uint wid) const {
+Header* Dict::find_word_in_wid(const CString* name, ucell wid) const {
     return find_word_in_wid(name->str(), name->size(), wid);
 }
 
-std::vector<std::string> Dict::get_words(uint wid) const {
-    std::vector<uint> nts = get_word_nts(wid);
+// names of forgotten words stay in the filter until it is rebuilt
+void Dict::rebuild_name_filter() {
+    vm->name_filter.clear();
+    ucell ptr = vm->latest_word;
+    while (ptr != 0) {
+        Header* header = reinterpret_cast<Header*>(mem_char_ptr(ptr));
+        CString* name = header->name();
+        vm->name_filter.add(name->str(), name->size());
+        ptr = header->prev;
+    }
+}
+
+std::vector<std::string> Dict::get_words(ucell wid) const {
+    std::vector<ucell> nts = get_word_nts(wid);
     std::vector<std::string> words;
     for (auto nt : nts) {
         Header* header = reinterpret_cast<Header*>(mem_char_ptr(nt));
@@ -293,12 +349,12 @@ std::vector<std::string> Dict::get_words(uint wid) const {
     return words;
 }
 
-std::vector<uint> Dict::get_word_nts(uint wid) const {
-    std::vector<uint> nts;
-    if (wid >= static_cast<uint>(vm.wordlists.size())) {
+std::vector<ucell> Dict::get_word_nts(ucell wid) const {
+    std::vector<ucell> nts;
+    if (wid >= static_cast<ucell>(vm->wordlists.size())) {
         error(Error::CompilationWordListDeleted);
     }
-    int ptr = vm.wordlists[wid];
+    cell ptr = vm->wordlists[wid];
     while (ptr != 0) {
         Header* header = reinterpret_cast<Header*>(mem_char_ptr(ptr));
         if (header->flags.hidden || header->flags.smudge) {
@@ -313,21 +369,21 @@ std::vector<uint> Dict::get_word_nts(uint wid) const {
     return nts;
 }
 
-void Dict::check_free_space(int size) const {
-    if (vm.here + size >= vm.names) {
+void Dict::check_free_space(cell size) const {
+    if (vm->here + size >= vm->names) {
         error(Error::DictionaryOverflow);
     }
 }
 
-void f_find(uint addr) {
+void f_find(ucell addr) {
     CString* word = reinterpret_cast<CString*>(mem_char_ptr(addr));
-    Header* header = vm.dict.find_word(word->str(), word->size());
+    Header* header = vm->dict.find_word(word->str(), word->size());
     if (header == nullptr) {
         push(addr);
         push(0);
     }
     else {
-        uint xt = header->xt();
+        ucell xt = header->xt();
         if (header->flags.immediate) {
             push(xt);
             push(1);
@@ -339,35 +395,28 @@ void f_find(uint addr) {
     }
 }
 
-int f_tick() {
-    Header* header = vm.dict.parse_find_existing_word();
+cell f_tick() {
+    Header* header = vm->dict.parse_find_existing_word();
     assert(header != nullptr);
     return header->xt();
 }
 
 void f_bracket_tick() {
-    uint xt = f_tick();
+    ucell xt = f_tick();
     comma(xtXLITERAL);
     comma(xt);
 }
 
 void f_postpone() {
-    Header* header = vm.dict.parse_find_existing_word();
-    assert(header != nullptr);
-    if (header->flags.immediate) {
-        // compile imediate words immediately
-        comma(header->xt());
-    }
-    else {
-        // make code to compile word later
-        comma(xtXLITERAL);		// xt of word in stack
-        comma(header->xt());
-        comma(xtCOMMA);
+    const CString* name = parse_cword(BL);
+    if (name->size() == 0) {
+        error(Error::AttemptToUseZeroLengthStringAsName);
     }
+    vm->recognizers.postpone(name->str(), name->size());
 }
 
 void f_bracket_compile() {
-    uint xt = f_tick();
+    ucell xt = f_tick();
     comma(xt);
 }
 
@@ -377,53 +426,53 @@ void f_compile_comma() {
 
 void f_immediate() {
     Header* header = reinterpret_cast<Header*>(
-                         mem_char_ptr(vm.latest_word));
+                         mem_char_ptr(vm->latest_word));
     header->flags.immediate = true;
 }
 
 void f_hidden() {
     Header* header = reinterpret_cast<Header*>(
-                         mem_char_ptr(vm.latest_word));
+                         mem_char_ptr(vm->latest_word));
     header->flags.hidden = true;
 }
 
 void f_create() {
-    vm.dict.parse_create(idXDOVAR, 0);
+    vm->dict.parse_create(idXDOVAR, 0);
 }
 
 void f_buffer_colon() {
-    vm.dict.parse_create(idXDOVAR, 0);
-    uint size = pop();
-    vm.dict.allot(size);
+    vm->dict.parse_create(idXDOVAR, 0);
+    ucell size = pop();
+    vm->dict.allot(size);
 }
 
 void f_variable() {
-    vm.dict.parse_create(idXDOVAR, 0);
+    vm->dict.parse_create(idXDOVAR, 0);
     comma(0);
 }
 
 void f_2variable() {
-    vm.dict.parse_create(idXDOVAR, 0);
+    vm->dict.parse_create(idXDOVAR, 0);
     dcomma(0);
 }
 
 void f_fvariable() {
-    vm.dict.parse_create(idXDOFVAR, 0);
+    vm->dict.parse_create(idXDOFVAR, 0);
     fcomma(0);
 }
 
 void f_value() {
-    vm.dict.parse_create(idXDOCONST, 0);
+    vm->dict.parse_create(idXDOVALUE, 0);
     comma(pop());
 }
 
 void f_two_value() {
-    vm.dict.parse_create(idXDO2CONST, 0);
+    vm->dict.parse_create(idXDO2VALUE, 0);
     dcomma(dpop());
 }
 
 void f_fvalue() {
-    vm.dict.parse_create(idXDOFCONST, 0);
+    vm->dict.parse_create(idXDOFVALUE, 0);
     fcomma(fpop());
 }
 
@@ -435,10 +484,8 @@ void f_to() {
 
     VarName vname;
     if (find_local(name->str(), name->size(), vname)) { // local found
-        if (vm.user->STATE == STATE_COMPILE) {
-            comma(xtXLITERAL);
-            comma(vname.index);
-            comma(xtXSET_LOCAL);
+        if (vm->user->STATE == STATE_COMPILE) {
+            vm->locals.compile_store(vname);
         }
         else {
             error(Error::InterpretingACompileOnlyWord, name->to_string());
@@ -446,14 +493,14 @@ void f_to() {
         return;
     }
 
-    Header* header = vm.dict.find_word(name);
+    Header* header = vm->dict.find_word(name);
     if (!header) {
         error(Error::UndefinedWord, name->to_string());
     }
 
-    uint code = fetch(header->xt());
-    if (code == idXDOCONST) {			// single cell value
-        if (vm.user->STATE == STATE_COMPILE) {
+    ucell code = fetch(header->xt());
+    if (code == idXDOVALUE) {			// single cell value
+        if (vm->user->STATE == STATE_COMPILE) {
             comma(xtXLITERAL);
             comma(header->body());
             comma(xtSTORE);
@@ -462,8 +509,8 @@ void f_to() {
             store(header->body(), pop());
         }
     }
-    else if (code == idXDO2CONST) {		// double cell value
-        if (vm.user->STATE == STATE_COMPILE) {
+    else if (code == idXDO2VALUE) {		// double cell value
+        if (vm->user->STATE == STATE_COMPILE) {
             comma(xtXLITERAL);
             comma(header->body());
             comma(xtTWO_STORE);
@@ -472,8 +519,8 @@ void f_to() {
             dstore(header->body(), dpop());
         }
     }
-    else if (code == idXDOFCONST) {		// float cell value
-        if (vm.user->STATE == STATE_COMPILE) {
+    else if (code == idXDOFVALUE) {		// float cell value
+        if (vm->user->STATE == STATE_COMPILE) {
             comma(xtXLITERAL);
             comma(header->body());
             comma(xtF_STORE);
@@ -489,143 +536,149 @@ void f_to() {
 
 
 void f_constant() {
-    vm.dict.parse_create(idXDOCONST, 0);
+    vm->dict.parse_create(idXDOCONST, 0);
     comma(pop());
 }
 
 void f_2constant() {
-    vm.dict.parse_create(idXDO2CONST, 0);
+    vm->dict.parse_create(idXDO2CONST, 0);
     dcomma(dpop());
 }
 
 void f_fconstant() {
-    vm.dict.parse_create(idXDOFCONST, 0);
+    vm->dict.parse_create(idXDOFCONST, 0);
     fcomma(fpop());
 }
 
 void f_does() {
-    vm.locals.clear();
+    if (vm->locals.has_frame()) {
+        comma(xtXLEAVE_FRAME);              // leave frame of CREATE part
+    }
+    vm->locals.clear();
 
     Header* header = reinterpret_cast<Header*>(
-                         mem_char_ptr(vm.latest_word));
+                         mem_char_ptr(vm->latest_word));
     comma(xtXDOES_DEFINE);                  // set this word as having DOES>
     comma(header->xt());					// xt of creater word
-    comma(vm.here + 2 * CELL_SZ);	// location of run code
+    comma(vm->here + 2 * CELL_SZ);	// location of run code
     comma(xtEXIT);                          // exit from CREATE part
     // run code starts here
 }
 
 void f_xdoes_define() {
-    int creator_xt = fetch(vm.ip);
-    vm.ip += CELL_SZ;
-    int run_code = fetch(vm.ip);
-    vm.ip += CELL_SZ;						// start of runtime code
+    cell creator_xt = fetch(vm->ip);
+    vm->ip += CELL_SZ;
+    cell run_code = fetch(vm->ip);
+    vm->ip += CELL_SZ;						// start of runtime code
 
     Header* def_word = reinterpret_cast<Header*>(
-                           mem_char_ptr(vm.latest_word));
+                           mem_char_ptr(vm->latest_word));
     def_word->creator_xt = creator_xt;		// store xt of creator word
     def_word->does = run_code;				// start of DOES> code
     def_word->code = idXDOES_RUN;			// new execution id
 }
 
-void f_xdoes_run(uint body) {
+void f_xdoes_run(ucell body) {
     push(body);							// store parameter field on the stack
     Header* header = Header::header(body - CELL_SZ);
     enter_func(header->does);           // call code after DOES>
 }
 
 void f_marker() {
-    uint save_latest_word = vm.latest_word;
-    std::vector<uint> save_wordlists = vm.wordlists;
-    uint save_here = vm.here;
-    uint save_names = vm.names;
+    ucell save_latest_word = vm->latest_word;
+    std::vector<ucell> save_wordlists = vm->wordlists;
+    ucell save_here = vm->here;
+    ucell save_names = vm->names;
 
-    vm.dict.parse_create(idXMARKER, 0);
+    vm->dict.parse_create(idXMARKER, 0);
 
     comma(save_latest_word);
     comma(save_here);
     comma(save_names);
-    comma(static_cast<uint>(save_wordlists.size()));
+    comma(static_cast<ucell>(save_wordlists.size()));
     for (auto latest : save_wordlists) {
         comma(latest);
     }
 }
 
-void f_xmarker(uint body) {
-    uint ptr = body;
-    uint save_latest_word = fetch(ptr);
+void f_xmarker(ucell body) {
+    ucell ptr = body;
+    ucell save_latest_word = fetch(ptr);
     ptr += CELL_SZ;
-    uint save_here = fetch(ptr);
+    ucell save_here = fetch(ptr);
     ptr += CELL_SZ;
-    uint save_names = fetch(ptr);
+    ucell save_names = fetch(ptr);
     ptr += CELL_SZ;
 
-    vm.latest_word = save_latest_word;
-    vm.here = save_here;
-    vm.names = save_names;
+    vm->latest_word = save_latest_word;
+    vm->here = save_here;
+    vm->names = save_names;
+    forget_inlined(vm->here);
 
-    vm.wordlists.clear();
-    uint save_wordlists_size = fetch(ptr);
+    vm->wordlists.clear();
+    ucell save_wordlists_size = fetch(ptr);
     ptr += CELL_SZ;
-    for (uint i = 0; i < save_wordlists_size; ++i) {
-        uint latest = fetch(ptr);
+    for (ucell i = 0; i < save_wordlists_size; ++i) {
+        ucell latest = fetch(ptr);
         ptr += CELL_SZ;
-        vm.wordlists.push_back(latest);
+        vm->wordlists.push_back(latest);
     }
+
+    vm->dict.rebuild_name_filter();
 }
 
 void f_words() {
-    uint wid = vm.search_order.empty() ? SYSTEM_WID : vm.search_order.back();
-    std::vector<std::string> words = vm.dict.get_words(wid);
+    ucell wid = vm->search_order.empty() ? SYSTEM_WID : vm->search_order.back();
+    std::vector<std::string> words = vm->dict.get_words(wid);
     size_t col = 0;
     for (auto& word : words) {
         if (col + 1 + word.size() >= SCREEN_WIDTH) {
-            std::cout << std::endl << word;
+            vm->out << std::endl << word;
             col = word.size();
         }
         else if (col == 0) {
-            std::cout << word;
+            vm->out << word;
             col += word.size();
         }
         else {
-            std::cout << BL << word;
+            vm->out << BL << word;
             col += 1 + word.size();
         }
     }
-    std::cout << std::endl;
+    vm->out << std::endl;
 }
 
 void f_defer() {
-    vm.dict.parse_create(idXDEFER, 0);
+    vm->dict.parse_create(idXDEFER, 0);
     comma(xtABORT);
 }
 
-void f_xdefer(uint body) {
-    uint xt = fetch(body);
+void f_xdefer(ucell body) {
+    ucell xt = fetch(body);
     f_execute(xt);
 }
 
 void f_defer_fetch() {
-    uint xt = pop();
+    ucell xt = pop();
     f_defer_fetch(xt);
 }
 
-void f_defer_fetch(uint xt) {
-    uint body = xt + CELL_SZ;
+void f_defer_fetch(ucell xt) {
+    ucell body = xt + CELL_SZ;
     push(fetch(body));
 }
 
 void f_defer_store() {
-    uint xt_self = pop();
-    uint xt_action = pop();
-    uint body = xt_self + CELL_SZ;
+    ucell xt_self = pop();
+    ucell xt_action = pop();
+    ucell body = xt_self + CELL_SZ;
     store(body, xt_action);
 }
 
 void f_action_of() {
-    Header* header = vm.dict.parse_find_existing_word();
+    Header* header = vm->dict.parse_find_existing_word();
     assert(header != nullptr);
-    if (vm.user->STATE == STATE_INTERPRET) {
+    if (vm->user->STATE == STATE_INTERPRET) {
         f_defer_fetch(header->xt());
     }
     else {
@@ -636,9 +689,9 @@ void f_action_of() {
 }
 
 void f_is() {
-    Header* header = vm.dict.parse_find_existing_word();
+    Header* header = vm->dict.parse_find_existing_word();
     assert(header != nullptr);
-    if (vm.user->STATE == STATE_INTERPRET) {
+    if (vm->user->STATE == STATE_INTERPRET) {
         store(header->body(), pop());
     }
     else {
@@ -649,51 +702,51 @@ void f_is() {
 }
 
 void f_definitions() {
-    uint wid = vm.search_order.empty() ? SYSTEM_WID : vm.search_order.back();
-    vm.definitions_wid = wid;
+    ucell wid = vm->search_order.empty() ? SYSTEM_WID : vm->search_order.back();
+    vm->definitions_wid = wid;
 }
 
 void f_wordlist() {
-    uint wid = static_cast<uint>(vm.wordlists.size());
-    vm.wordlists.push_back(0);
+    ucell wid = static_cast<ucell>(vm->wordlists.size());
+    vm->wordlists.push_back(0);
     push(wid);
 }
 
 void f_get_order() {
-    for(uint i = 0; i < vm.search_order.size(); i++) {
-        push(vm.search_order[i]);
+    for(ucell i = 0; i < vm->search_order.size(); i++) {
+        push(vm->search_order[i]);
     }
-    push(static_cast<uint>(vm.search_order.size()));
+    push(static_cast<ucell>(vm->search_order.size()));
 }
 
 void f_set_order() {
-    int n = pop();
+    cell n = pop();
     if (n < 0) {
         f_only();
     }
     else if (n == 0) {
-        vm.search_order.clear();
+        vm->search_order.clear();
     }
     else {
-        vm.search_order.resize(n);
-        for (int i = n - 1; i >= 0; --i) {
-            vm.search_order[i] = pop();
+        vm->search_order.resize(n);
+        for (cell i = n - 1; i >= 0; --i) {
+            vm->search_order[i] = pop();
         }
     }
 }
 
 void f_search_wordlist() {
-    uint wid = pop();
-    uint size = pop();
-    uint addr = pop();
+    ucell wid = pop();
+    ucell size = pop();
+    ucell addr = pop();
     const char* word = mem_char_ptr(addr);
 
-    Header* header = vm.dict.find_word_in_wid(word, size, wid);
+    Header* header = vm->dict.find_word_in_wid(word, size, wid);
     if (header == nullptr) {
         push(0);
     }
     else {
-        uint xt = header->xt();
+        ucell xt = header->xt();
         if (header->flags.immediate) {
             push(xt);
             push(1);
@@ -706,39 +759,39 @@ void f_search_wordlist() {
 }
 
 void f_also() {
-    if (vm.search_order.empty()) {
-        vm.search_order.push_back(SYSTEM_WID);
+    if (vm->search_order.empty()) {
+        vm->search_order.push_back(SYSTEM_WID);
     }
     else {
-        uint wid = vm.search_order.back();
-        vm.search_order.push_back(wid);
+        ucell wid = vm->search_order.back();
+        vm->search_order.push_back(wid);
     }
 }
 
 void f_previous() {
-    if (!vm.search_order.empty()) {
-        vm.search_order.pop_back();
+    if (!vm->search_order.empty()) {
+        vm->search_order.pop_back();
     }
 }
 
 void f_only() {
-    vm.search_order.clear();
-    vm.search_order.push_back(SYSTEM_WID);
+    vm->search_order.clear();
+    vm->search_order.push_back(SYSTEM_WID);
 }
 
 void f_order() {
-    std::cout << std::endl << "Search order: ";
-    for (uint i = 0; i < static_cast<uint>(vm.search_order.size()); ++i) {
-        uint wid = vm.search_order[i];
-        print_number(static_cast<int>(wid));
+    vm->out << std::endl << "Search order: ";
+    for (ucell i = 0; i < static_cast<ucell>(vm->search_order.size()); ++i) {
+        ucell wid = vm->search_order[i];
+        print_number(static_cast<cell>(wid));
     }
-    std::cout << std::endl << "Definitions: ";
-    print_number(static_cast<int>(vm.definitions_wid));
-    std::cout << std::endl;
+    vm->out << std::endl << "Definitions: ";
+    print_number(static_cast<cell>(vm->definitions_wid));
+    vm->out << std::endl;
 }
 
 void f_forth() {
     f_previous();
-    vm.search_order.push_back(SYSTEM_WID);
+    vm->search_order.push_back(SYSTEM_WID);
 }
 
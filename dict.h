@@ -11,24 +11,43 @@
 #include <vector>
 
 struct Header {
-    uint prev;          // address of previous header in dictionary
-    uint link;			// address of previous header in search order
-    uint name_addr;		// address of name
+    ucell prev;          // address of previous header in dictionary
+    ucell link;			// address of previous header in search order
+    ucell name_addr;		// address of name
     struct {
         bool smudge : 1;
         bool hidden : 1;
         bool immediate : 1;
+        bool effect : 1;    // effect_in and effect_out are valid
+        bool inline_always : 1; // set by INLINE
     } flags;
-    uint size;			// size of body, filled by next header
-    uint creator_xt;	// xt of word that created this word
-    uint does;			// address of DOES> code
-    uint code;			// primitive code
+    uchar effect_in;    // data stack cells consumed, computed at ;
+    uchar effect_out;   // data stack cells produced, computed at ;
+    ucell size;			// size of body, filled by next header
+    ucell creator_xt;	// xt of word that created this word
+    ucell does;			// address of DOES> code
+    ucell code;			// primitive code
 
     CString* name() const;
-    uint xt() const;
-    uint body() const;
-    static Header* header(uint xt);
-    uint get_size() const;
+    ucell xt() const;
+    ucell body() const;
+    static Header* header(ucell xt);
+    ucell get_size() const;
+};
+
+
+// bloom filter of the names ever defined, folded to lower case; a name
+// that is not in the filter is not in any wordlist, so the search can be
+// skipped, which is the common case for numbers in the input
+class NameFilter {
+public:
+    void clear();
+    void add(const char* name, ucell size);
+    bool may_contain(const char* name, ucell size) const;
+
+private:
+    static const ucell NUM_BITS = 1 << 16;
+    uint64_t bits_[NUM_BITS / 64]{};
 };
 
 
@@ -37,26 +56,26 @@ public:
     void init();
     void clear();
 
-    void allot(int size);
-    int unused() const;
+    void allot(cell size);
+    cell unused() const;
 
-    uint parse_create(uint code, int flags); // return xt of word
+    ucell parse_create(ucell code, cell flags); // return xt of word
 
-    uint create(const std::string& name, int flags, uint code); // return xt of word
-    uint create(const char* name, uint size, int flags,
-                uint code); // return xt of word
-    uint create(const CString* name, int flags, uint code); // return xt of word
+    ucell create(const std::string& name, cell flags, ucell code); // return xt of word
+    ucell create(const char* name, ucell size, cell flags,
+                ucell code); // return xt of word
+    ucell create(const CString* name, cell flags, ucell code); // return xt of word
 
-    uint alloc_cstring(const std::string& str);
-    uint alloc_cstring(const char* str, uint size);
-    uint alloc_cstring(const CString* str);
+    ucell alloc_cstring(const std::string& str);
+    ucell alloc_cstring(const char* str, ucell size);
+    ucell alloc_cstring(const CString* str);
 
-    uint alloc_string(const std::string& str);
-    uint alloc_string(const char* str, uint size);
-    uint alloc_string(const LongString* str);
+    ucell alloc_string(const std::string& str);
+    ucell alloc_string(const char* str, ucell size);
+    ucell alloc_string(const LongString* str);
 
-    void ccomma(int value);
-    void comma(int value);
+    void ccomma(cell value);
+    void comma(cell value);
     void dcomma(dint value);
     void fcomma(double value);
     void align();
@@ -65,25 +84,27 @@ public:
     Header* parse_find_existing_word();
 
     Header* find_word(const std::string& name) const;
-    Header* find_word(const char* name, uint size) const;
+    Header* find_word(const char* name, ucell size) const;
     Header* find_word(const CString* name) const;
 
-    Header* find_word_in_wid(const std::string& name, uint wid) const;
-    Header* find_word_in_wid(const char* name, uint size, uint wid) const;
-    Header* find_word_in_wid(const CString* name, uint wid) const;
+    Header* find_word_in_wid(const std::string& name, ucell wid) const;
+    Header* find_word_in_wid(const char* name, ucell size, ucell wid) const;
+    Header* find_word_in_wid(const CString* name, ucell wid) const;
+
+    std::vector<std::string> get_words(ucell wid) const;
+    std::vector<ucell> get_word_nts(ucell wid) const;
 
-    std::vector<std::string> get_words(uint wid) const;
-    std::vector<uint> get_word_nts(uint wid) const;
+    void rebuild_name_filter();
 
 private:
-    void check_free_space(int size = 0) const;
-    uint create_cont(uint name_addr, int flags, uint code);
+    void check_free_space(cell size = 0) const;
+    ucell create_cont(ucell name_addr, cell flags, ucell code);
 };
 
 
-void f_find(uint addr);	// search dictionary, word max size 255
+void f_find(ucell addr);	// search dictionary, word max size 255
 
-int f_tick();
+cell f_tick();
 void f_bracket_tick();
 
 void f_postpone();
@@ -106,17 +127,17 @@ void f_2constant();
 void f_fconstant();
 void f_does();
 void f_xdoes_define();
-void f_xdoes_run(uint body);
+void f_xdoes_run(ucell body);
 
 void f_marker();
-void f_xmarker(uint body);
+void f_xmarker(ucell body);
 
 void f_words();
 
 void f_defer();
-void f_xdefer(uint body);
+void f_xdefer(ucell body);
 void f_defer_fetch();
-void f_defer_fetch(uint xt);
+void f_defer_fetch(ucell xt);
 void f_defer_store();
 void f_action_of();
 void f_is();
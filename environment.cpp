@@ -13,13 +13,13 @@
 #include <cstring>
 #include <string>
 
-int g_argc = 0;
+cell g_argc = 0;
 char** g_argv = nullptr;
 bool g_interactive = false;
 
 void f_environment_q() {
-    uint size = pop();
-    uint addr = pop();
+    ucell size = pop();
+    ucell addr = pop();
     char* query = mem_char_ptr(addr, size);
     f_environment_q(query, size);
 }
@@ -50,19 +50,19 @@ void f_environment_q(const std::string& query) {
         push(F_TRUE);
     }
     else if (case_insensitive_equal(query, "MAX-D")) {
-        dpush(INT64_MAX);
+        dpush(mk_dcell(CELL_MAX, -1));
         push(F_TRUE);
     }
     else if (case_insensitive_equal(query, "MAX-N")) {
-        push(INT_MAX);
+        push(CELL_MAX);
         push(F_TRUE);
     }
     else if (case_insensitive_equal(query, "MAX-U")) {
-        push(UINT_MAX);
+        push(UCELL_MAX);
         push(F_TRUE);
     }
     else if (case_insensitive_equal(query, "MAX-UD")) {
-        dpush(UINT64_MAX);
+        dpush(mk_dcell(-1, -1));
         push(F_TRUE);
     }
     else if (case_insensitive_equal(query, "RETURN-STACK-CELLS")) {
@@ -186,17 +186,17 @@ void f_environment_q(const std::string& query) {
     }
 }
 
-void f_environment_q(const char* query, uint size) {
+void f_environment_q(const char* query, ucell size) {
     f_environment_q(std::string(query, query + size));
 }
 
 void f_next_arg() {
     if (g_argc > 0) {
         const char* arg = g_argv[0];
-        uint size = static_cast<uint>(strlen(arg));
+        ucell size = static_cast<ucell>(strlen(arg));
         g_argc--;
         g_argv++;
-        LongString* lstring = vm.wordbuf.append_long_string(arg, size);
+        LongString* lstring = vm->wordbuf.append_long_string(arg, size);
         push(mem_addr(lstring->str()));
         push(lstring->size());
     }
@@ -9,11 +9,11 @@
 #include "forth.h"
 #include <string>
 
-extern int g_argc;
+extern cell g_argc;
 extern char** g_argv;
 extern bool g_interactive;
 
 void f_environment_q();
 void f_environment_q(const std::string& query);
-void f_environment_q(const char* query, uint size);
+void f_environment_q(const char* query, ucell size);
 void f_next_arg();
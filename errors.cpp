@@ -13,109 +13,122 @@
 
 class ThrowException : public std::exception {
 public:
-    ThrowException(uint code) : error_code(code) {}
+    ThrowException(ucell code) : error_code(code) {}
     virtual const char* what() const noexcept override {
-        static std::string message;
+        static thread_local std::string message;
         message = std::string("Forth exception thrown with error code ") +
-                  std::to_string(error_code) + ": " + vm.error_message;
+                  std::to_string(error_code) + ": " + vm->error_message;
         return message.c_str();
     }
 
 public:
-    int error_code;
+    cell error_code;
 };
 
-[[noreturn]] static void output_error(const std::string& message,
-                                      const std::string& arg = "") {
-    std::cerr << std::endl << "Error: " << message;
+static std::string error_text(const std::string& message,
+                              const std::string& arg = "") {
+    std::string text = "Error: " + message;
     if (!arg.empty()) {
-        std::cerr << ": " << arg;
+        text += ": " + arg;
     }
-    std::cerr << std::endl;
-    exit(EXIT_FAILURE);
+    return text;
 }
 
-[[noreturn]] static void exit_error(Error err, const std::string& arg = "") {
-    if (err == Error::None) {
-        exit(EXIT_SUCCESS);
-    }
-    else if (err == Error::Abort) {
-        exit(EXIT_FAILURE);
+std::string error_message(cell error_code) {
+    Error err = static_cast<Error>(error_code);
+    if (err == Error::None || err == Error::Abort) {
+        return "";
     }
     else if (err == Error::AbortQuote) {
-        std::cerr << std::endl << "Aborted: " << vm.error_message << std::endl;
-        exit(EXIT_FAILURE);
+        return "Aborted: " + vm->error_message;
     }
     else {
         switch (err) {
-#define X(code, id, message) case Error::id: output_error(message, arg); break;
+#define X(code, id, message) case Error::id: return error_text(message, vm->error_message);
 #include "errors.def"
         default:
-            output_error(std::to_string(static_cast<int>(err)));
-            break;
+            return error_text(std::to_string(error_code));
         }
     }
 }
 
-[[noreturn]] static void exit_error(int error_code,
-                                    const std::string& arg = "") {
-    exit_error(static_cast<Error>(error_code), arg);
+void print_error(cell error_code) {
+    std::string message = error_message(error_code);
+    if (!message.empty()) {
+        vm->out.flush();
+        std::cerr << std::endl << message << std::endl;
+    }
+}
+
+[[noreturn]] static void exit_error(cell error_code) {
+    print_error(error_code);
+    exit_forth(error_code == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
 }
 
 void error(Error err, const std::string& arg) {
-    vm.error_message = arg;
+    vm->error_message = arg;
     f_throw(err);
 }
 
 void f_catch() {
-    uint xt = pop();
+    ucell xt = pop();
     f_catch(xt);
 }
 
-void f_catch(uint xt) {
-    vm.except_stack.push(vm.r_stack.size());
-    vm.except_stack.push(vm.locals.size());
-    vm.except_stack.push(vm.locals.frame());
-    vm.except_stack.push(vm.stack.size());
-    vm.except_stack.push(vm.input.input_level());
-    vm.except_stack.push(vm.ip);
+void f_catch(ucell xt) {
+    push(catch_error([xt]() { f_execute(xt); }));
+}
+
+// cells pushed to the exception stack by CATCH
+static const ucell CATCH_FRAME_SZ = 7;
+
+cell catch_error(const std::function<void()>& f) {
+    vm->except_stack.push(vm->r_stack.size());
+    vm->except_stack.push(vm->loop_stack.size());
+    vm->except_stack.push(vm->locals.size());
+    vm->except_stack.push(vm->locals.frame());
+    vm->except_stack.push(vm->stack.size());
+    vm->except_stack.push(vm->input.input_level());
+    vm->except_stack.push(vm->ip);
 
-    int catch_result = 0;
+    cell catch_result = 0;
     try {
-        f_execute(xt);
+        f();
+        vm->except_stack.resize(vm->except_stack.size() - CATCH_FRAME_SZ);
     }
     catch (ThrowException& e) {
-        vm.ip = vm.except_stack.pop(); // restore instruction pointer
-        vm.input.restore_input(vm.except_stack.pop());
-        vm.stack.resize(vm.except_stack.pop()); // restore data stack pointer
-        vm.locals.set_frame(vm.except_stack.pop()); // restore locals frame
-        vm.locals.resize(vm.except_stack.pop()); // restore locals stack
-        vm.r_stack.resize(vm.except_stack.pop()); // restore return stack pointer
+        vm->ip = vm->except_stack.pop(); // restore instruction pointer
+        vm->input.restore_input(vm->except_stack.pop());
+        vm->stack.resize(vm->except_stack.pop()); // restore data stack pointer
+        vm->locals.set_frame(vm->except_stack.pop()); // restore locals frame
+        vm->locals.resize(vm->except_stack.pop()); // restore locals stack
+        vm->loop_stack.resize(vm->except_stack.pop()); // restore loop stack
+        vm->r_stack.resize(vm->except_stack.pop()); // restore return stack pointer
 
         catch_result = e.error_code;
     }
     catch (...) {
         throw;
     }
-    push(catch_result);
+    return catch_result;
 }
 
 void f_throw() {
-    int error_code = pop();
+    cell error_code = pop();
     f_throw(error_code);
 }
 
 void f_throw(Error err) {
-    f_throw(static_cast<int>(err));
+    f_throw(static_cast<cell>(err));
 }
 
-void f_throw(int error_code) {
+void f_throw(cell error_code) {
     if (error_code == 0) {
         return;
     }
 
-    if (vm.except_stack.empty()) {
-        exit_error(error_code, vm.error_message);
+    if (vm->except_stack.empty()) {
+        exit_error(error_code);
     }
     else {
         throw ThrowException(error_code);
@@ -123,38 +136,38 @@ void f_throw(int error_code) {
 }
 
 void f_abort() {
-    vm.stack.clear();
-    vm.error_message.clear();
+    vm->stack.clear();
+    vm->error_message.clear();
     f_throw(Error::Abort);
 }
 
 void f_abort_quote() {
-    uint size;
+    ucell size;
     const char* message = parse_word(size, '"');
-    if (vm.user->STATE == STATE_COMPILE) {
-        int str_addr = vm.dict.alloc_string(message, size);
+    if (vm->user->STATE == STATE_COMPILE) {
+        cell str_addr = vm->dict.alloc_string(message, size);
         comma(xtXABORT_QUOTE);
         comma(str_addr);
     }
     else {
-        int error_code = pop();
+        cell error_code = pop();
         if (error_code != 0) {
-            vm.stack.clear();
-            vm.error_message = std::string(message, size);
+            vm->stack.clear();
+            vm->error_message = std::string(message, size);
             f_throw(Error::AbortQuote);
         }
     }
 }
 
 void f_xabort_quote() {
-    int str_addr = fetch(vm.ip);
-    vm.ip += CELL_SZ;
+    cell str_addr = fetch(vm->ip);
+    vm->ip += CELL_SZ;
 
-    int error_code = pop();
+    cell error_code = pop();
     if (error_code != 0) {
         LongString* str = reinterpret_cast<LongString*>(mem_char_ptr(str_addr));
-        vm.stack.clear();
-        vm.error_message = str->to_string();
+        vm->stack.clear();
+        vm->error_message = str->to_string();
         f_throw(Error::AbortQuote);
     }
 }
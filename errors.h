@@ -7,6 +7,7 @@
 #pragma once
 
 #include "forth.h"
+#include <functional>
 #include <string>
 
 enum class Error {
@@ -16,11 +17,20 @@ enum class Error {
 
 void error(Error err, const std::string& arg = "");
 
+// message shown for an uncaught THROW, empty for ABORT
+std::string error_message(cell error_code);
+
+// show the message of an uncaught THROW on stderr
+void print_error(cell error_code);
+
+// run f like CATCH, return 0 or the THROW code
+cell catch_error(const std::function<void()>& f);
+
 void f_catch();
-void f_catch(uint xt);
+void f_catch(ucell xt);
 void f_throw();
 void f_throw(Error err);
-void f_throw(int error_code);
+void f_throw(cell error_code);
 
 // abort
 void f_abort();
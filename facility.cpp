@@ -11,34 +11,34 @@
 #include <thread>
 
 void f_at_xy() {
-    int y = pop();
-    int x = pop();
+    cell y = pop();
+    cell x = pop();
     f_at_xy(x, y);
 }
 
-void f_at_xy(int x, int y) {
-    std::cout << "\033[" << (y + 1) << ";" << (x + 1) << "H";
+void f_at_xy(cell x, cell y) {
+    vm->out << "\033[" << (y + 1) << ";" << (x + 1) << "H";
 }
 
 void f_page() {
-    std::cout << "\033[2J\033[H";
+    vm->out << "\033[2J\033[H";
 }
 
 void f_begin_structure() {
-    vm.dict.parse_create(idXDOCONST, 0);
-    uint addr = vm.here;     // address to store size of structure
+    vm->dict.parse_create(idXDOCONST, 0);
+    ucell addr = vm->here;     // address to store size of structure
     comma(0);                       // reserve space for size
 
     push(addr);                     // push address of size
     push(0);                        // initial offset is 0
 }
 
-static int field(uint offset, uint size, bool do_align) {
+static cell field(ucell offset, ucell size, bool do_align) {
     if (do_align) {
         offset = aligned(offset);
     }
 
-    vm.dict.parse_create(idXPLUS_FIELD, 0);
+    vm->dict.parse_create(idXPLUS_FIELD, 0);
     comma(offset);                   // offset of field
 
     offset += size;
@@ -47,56 +47,63 @@ static int field(uint offset, uint size, bool do_align) {
 }
 
 void f_plus_field() {
-    uint size = pop();
-    uint offset = pop();
+    ucell size = pop();
+    ucell offset = pop();
     offset = field(offset, size, false);
     push(offset);                    // new offset
 }
 
-void f_xplus_field(uint body) {
-    int base_addr = pop();
-    uint offset = fetch(body);
-    int field_addr = base_addr + offset;
+void f_xplus_field(ucell body) {
+    cell base_addr = pop();
+    ucell offset = fetch(body);
+    cell field_addr = base_addr + offset;
     push(field_addr);
 }
 
 void f_cfield_colon() {
-    uint offset = pop();
+    ucell offset = pop();
     offset = field(offset, CHAR_SZ, false);
     push(offset);                    // new offset
 }
 
 void f_field_colon() {
-    uint offset = pop();
+    ucell offset = pop();
     offset = field(offset, CELL_SZ, true);
     push(offset);                    // new offset
 }
 
 void f_two_field_colon() {
-    uint offset = pop();
+    ucell offset = pop();
     offset = field(offset, DCELL_SZ, true);
     push(offset);                    // new offset
 }
 
 void f_f_field_colon() {
-    uint offset = pop();
+    ucell offset = pop();
     offset = field(offset, FCELL_SZ, true);
     push(offset);                    // new offset
 }
 
 void f_end_structure() {
-    uint offset = pop();
-    uint addr = pop();
+    ucell offset = pop();
+    ucell addr = pop();
     store(addr, offset); // store size of structure
 }
 
 void f_ms() {
-    int milliseconds = pop();
+    cell milliseconds = pop();
     f_ms(milliseconds);
 }
 
-void f_ms(int milliseconds) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+// show any pending output before waiting, let the other tasks run
+void f_ms(cell milliseconds) {
+    vm->out.flush();
+    auto end = std::chrono::steady_clock::now() +
+               std::chrono::milliseconds(milliseconds);
+    while (vm->tasks.multitasking() && std::chrono::steady_clock::now() < end) {
+        vm->tasks.wait();
+    }
+    std::this_thread::sleep_until(end);
 }
 
 void f_time_date() {
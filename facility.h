@@ -11,12 +11,12 @@
 void init_console_output();
 
 void f_at_xy();
-void f_at_xy(int x, int y);
+void f_at_xy(cell x, cell y);
 void f_page();
 
 void f_begin_structure();
 void f_plus_field();
-void f_xplus_field(uint body);
+void f_xplus_field(ucell body);
 void f_cfield_colon();
 void f_field_colon();
 void f_two_field_colon();
@@ -24,5 +24,5 @@ void f_f_field_colon();
 void f_end_structure();
 
 void f_ms();
-void f_ms(int milliseconds);
+void f_ms(cell milliseconds);
 void f_time_date();
@@ -8,9 +8,13 @@
 #include "input.h"
 #include "parser.h"
 #include "vm.h"
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
 
+// threads that run READ-FILE-ASYNC and WRITE-FILE-ASYNC
+static const int ASYNC_IO_THREADS = 4;
+
 SyncStream::SyncStream(const std::string& filename, std::ios::openmode mode)
     : filename_(filename),
       file_stream_(filename, mode | std::ios::binary),
@@ -35,13 +39,13 @@ const std::string& SyncStream::filename() const {
     return filename_;
 }
 
-uint SyncStream::read_bytes(char* buffer, uint size) {
+ucell SyncStream::read_bytes(char* buffer, ucell size) {
     flush_if_needed(Operation::READ);
     sync_read_pos();
     file_stream_.read(buffer, size);
     last_op_ = Operation::READ;
     sync_write_pos();
-    return static_cast<uint>(file_stream_.gcount());
+    return static_cast<ucell>(file_stream_.gcount());
 }
 
 char SyncStream::read_char() {
@@ -62,13 +66,13 @@ char SyncStream::peek_char() {
     return c;
 }
 
-uint SyncStream::read_line(char* buffer, uint size, bool& found_eof) {
+ucell SyncStream::read_line(char* buffer, ucell size, bool& found_eof) {
     flush_if_needed(Operation::READ);
     sync_read_pos();
 
     char c;
     found_eof = size == 0 ? false : true;
-    uint num_read = 0;
+    ucell num_read = 0;
     while (num_read < size && file_stream_.get(c)) {
         found_eof = false;
         if (c == '\n') {
@@ -91,7 +95,7 @@ uint SyncStream::read_line(char* buffer, uint size, bool& found_eof) {
     return num_read;
 }
 
-void SyncStream::write_bytes(const char* buffer, uint size) {
+void SyncStream::write_bytes(const char* buffer, ucell size) {
     flush_if_needed(Operation::WRITE);
     sync_write_pos();
     file_stream_.write(buffer, size);
@@ -107,7 +111,7 @@ void SyncStream::write_char(char c) {
     sync_read_pos();
 }
 
-void SyncStream::write_line(const char* buffer, uint size, EolType eol) {
+void SyncStream::write_line(const char* buffer, ucell size, EolType eol) {
     flush_if_needed(Operation::WRITE);
     sync_write_pos();
 
@@ -198,27 +202,37 @@ Files::Files() {
 }
 
 Files::~Files() {
+    // the threads end when the queue is empty
+    {
+        std::lock_guard<std::mutex> lock(io_mutex_);
+        io_quit_ = true;
+    }
+    io_queued_.notify_all();
+    for (auto& thread : io_threads_) {
+        thread.join();
+    }
+
     for (auto& file : files_) {
         delete file;
     }
 }
 
-uint Files::open(const std::string& filename, std::ios::openmode mode) {
+ucell Files::open(const std::string& filename, std::ios::openmode mode) {
     SyncStream* fs = new SyncStream(filename, mode);
     if (!fs->is_open()) {
         delete fs;
         return 0;
     }
     else {
-        uint file_id = next_file_id();
+        ucell file_id = next_file_id();
         files_[file_id] = fs;
         return file_id;
     }
 }
 
-uint Files::open_or_create(const std::string& filename) {
+ucell Files::open_or_create(const std::string& filename) {
     // open r/w
-    uint file_id = open(filename, std::ios::in | std::ios::out | std::ios::binary);
+    ucell file_id = open(filename, std::ios::in | std::ios::out | std::ios::binary);
 
     // check if file exists
     if (file_id == 0) {
@@ -241,7 +255,8 @@ uint Files::open_or_create(const std::string& filename) {
     return file_id; // 0 if last open failed
 }
 
-SyncStream* Files::get_file(uint file_id) {
+SyncStream* Files::get_file(ucell file_id) {
+    wait_file(file_id);
     if (file_id < files_.size()) {
         return files_[file_id];
     }
@@ -250,7 +265,7 @@ SyncStream* Files::get_file(uint file_id) {
     }
 }
 
-bool Files::close(uint file_id, Error& error_code) {
+bool Files::close(ucell file_id, Error& error_code) {
     error_code = Error::None;
     SyncStream* fs = get_file(file_id);
     if (fs != nullptr) {
@@ -266,12 +281,12 @@ bool Files::close(uint file_id, Error& error_code) {
     return false;
 }
 
-uint Files::read_bytes(uint file_id, char* buffer, uint size,
+ucell Files::read_bytes(ucell file_id, char* buffer, ucell size,
                        Error& error_code) {
     error_code = Error::None;
     SyncStream* fs = get_file(file_id);
     if (fs != nullptr) {
-        uint num_read = fs->read_bytes(buffer, size);
+        ucell num_read = fs->read_bytes(buffer, size);
         return num_read;
     }
 
@@ -279,7 +294,7 @@ uint Files::read_bytes(uint file_id, char* buffer, uint size,
     return 0;
 }
 
-void Files::write_bytes(uint file_id, const char* buffer, uint size,
+void Files::write_bytes(ucell file_id, const char* buffer, ucell size,
                         Error& error_code) {
     error_code = Error::None;
     SyncStream* fs = get_file(file_id);
@@ -293,14 +308,14 @@ void Files::write_bytes(uint file_id, const char* buffer, uint size,
     error_code = Error::WriteFileException;
 }
 
-uint Files::read_line(uint file_id, char* buffer, uint size,
+ucell Files::read_line(ucell file_id, char* buffer, ucell size,
                       bool& found_eof, Error& error_code) {
     found_eof = false;
     error_code = Error::None;
 
     SyncStream* fs = get_file(file_id);
     if (fs != nullptr) {
-        uint num_read = fs->read_line(buffer, size, found_eof);
+        ucell num_read = fs->read_line(buffer, size, found_eof);
         if (!fs->bad()) {
             return num_read;
         }
@@ -311,7 +326,7 @@ uint Files::read_line(uint file_id, char* buffer, uint size,
     return 0;
 }
 
-void Files::write_line(uint file_id, char* buffer, uint size,
+void Files::write_line(ucell file_id, char* buffer, ucell size,
                        Error& error_code) {
     error_code = Error::None;
     SyncStream* fs = get_file(file_id);
@@ -326,7 +341,7 @@ void Files::write_line(uint file_id, char* buffer, uint size,
 }
 
 
-bool Files::seek(uint file_id, udint pos, Error& error_code) {
+bool Files::seek(ucell file_id, udint pos, Error& error_code) {
     error_code = Error::None;
     SyncStream* fs = get_file(file_id);
     if (fs != nullptr) {
@@ -338,7 +353,7 @@ bool Files::seek(uint file_id, udint pos, Error& error_code) {
     return false;
 }
 
-udint Files::tell(uint file_id, Error& error_code) {
+udint Files::tell(ucell file_id, Error& error_code) {
     error_code = Error::None;
     SyncStream* fs = get_file(file_id);
     if (fs != nullptr) {
@@ -349,7 +364,7 @@ udint Files::tell(uint file_id, Error& error_code) {
     return -1;
 }
 
-udint Files::size(uint file_id, Error& error_code) {
+udint Files::size(ucell file_id, Error& error_code) {
     error_code = Error::None;
     SyncStream* fs = get_file(file_id);
     if (fs != nullptr) {
@@ -364,7 +379,7 @@ udint Files::size(uint file_id, Error& error_code) {
     return -1;
 }
 
-void Files::resize(uint file_id, udint size, Error& error_code) {
+void Files::resize(ucell file_id, udint size, Error& error_code) {
     error_code = Error::None;
     SyncStream* fs = get_file(file_id);
     if (fs != nullptr) {
@@ -375,7 +390,7 @@ void Files::resize(uint file_id, udint size, Error& error_code) {
     error_code = Error::ResizeException;
 }
 
-void Files::flush(uint file_id, Error& error_code) {
+void Files::flush(ucell file_id, Error& error_code) {
     error_code = Error::None;
     SyncStream* fs = get_file(file_id);
     if (fs != nullptr) {
@@ -386,18 +401,139 @@ void Files::flush(uint file_id, Error& error_code) {
     error_code = Error::FlushFileException;
 }
 
-std::string Files::filename(uint file_id) {
+std::string Files::filename(ucell file_id) {
     SyncStream* fs = get_file(file_id);
     return fs ? fs->filename() : "";
 }
 
-int Files::next_file_id() {
-    for (uint file_id = 1; file_id < files_.size(); ++file_id) {
+ucell Files::read_bytes_async(ucell file_id, char* buffer, ucell size) {
+    return submit(file_id, buffer, size, false);
+}
+
+ucell Files::write_bytes_async(ucell file_id, char* buffer, ucell size) {
+    return submit(file_id, buffer, size, true);
+}
+
+ucell Files::submit(ucell file_id, char* buffer, ucell size, bool write) {
+    auto request = std::make_unique<Request>();
+    request->file_id = file_id;
+    request->fs = file_id < files_.size() ? files_[file_id] : nullptr;
+    request->buffer = buffer;
+    request->size = size;
+    request->write = write;
+
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    if (io_threads_.empty()) {
+        for (int i = 0; i < ASYNC_IO_THREADS; i++) {
+            io_threads_.emplace_back(&Files::io_thread, this);
+        }
+    }
+
+    ucell req = next_request_++;
+    if (request->fs == nullptr) {
+        request->done = true;
+        request->error_code = write ? Error::WriteFileException :
+                              Error::ReadFileException;
+    }
+    else {
+        io_queue_.push_back(request.get());
+        io_pending_[file_id]++;
+        num_pending_++;
+        io_queued_.notify_one();
+    }
+    io_requests_[req] = std::move(request);
+    return req;
+}
+
+bool Files::await(ucell req, ucell& num_bytes, Error& error_code) {
+    std::unique_lock<std::mutex> lock(io_mutex_);
+    auto it = io_requests_.find(req);
+    if (it == io_requests_.end()) {
+        return false;
+    }
+
+    Request* request = it->second.get();
+    while (!request->done) {
+        if (vm->tasks.multitasking()) {
+            lock.unlock();
+            vm->tasks.wait();       // let the other tasks run
+            lock.lock();
+        }
+        else {
+            io_done_.wait(lock);
+        }
+    }
+
+    num_bytes = request->num_bytes;
+    error_code = request->error_code;
+    io_requests_.erase(req);
+    return true;
+}
+
+void Files::wait_file(ucell file_id) {
+    if (num_pending_ == 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(io_mutex_);
+    io_done_.wait(lock, [&]() {
+        auto it = io_pending_.find(file_id);
+        return it == io_pending_.end() || it->second == 0;
+    });
+}
+
+// run the oldest request of a file that has no request running
+void Files::io_thread() {
+    std::unique_lock<std::mutex> lock(io_mutex_);
+    while (true) {
+        auto next = std::find_if(io_queue_.begin(), io_queue_.end(),
+        [&](const Request * request) {
+            return io_running_.count(request->file_id) == 0;
+        });
+        if (next == io_queue_.end()) {
+            if (io_quit_ && io_queue_.empty()) {
+                break;
+            }
+            io_queued_.wait(lock);
+            continue;
+        }
+
+        Request* request = *next;
+        io_queue_.erase(next);
+        io_running_.insert(request->file_id);
+        lock.unlock();
+
+        if (request->write) {
+            request->fs->write_bytes(request->buffer, request->size);
+            if (request->fs->bad()) {
+                request->error_code = Error::WriteFileException;
+            }
+            else {
+                request->num_bytes = request->size;
+            }
+        }
+        else {
+            request->num_bytes = request->fs->read_bytes(request->buffer,
+                                 request->size);
+        }
+
+        lock.lock();
+        io_running_.erase(request->file_id);
+        if (--io_pending_[request->file_id] == 0) {
+            io_pending_.erase(request->file_id);
+        }
+        num_pending_--;
+        request->done = true;
+        io_done_.notify_all();
+    }
+}
+
+cell Files::next_file_id() {
+    for (ucell file_id = 1; file_id < files_.size(); ++file_id) {
         if (files_[file_id] == nullptr) {
             return file_id;
         }
     }
-    uint file_id = static_cast<uint>(files_.size());
+    ucell file_id = static_cast<ucell>(files_.size());
     files_.push_back(nullptr);
     return file_id;
 }
@@ -419,20 +555,20 @@ void f_bin() {
 }
 
 static void open_create(std::ios::openmode base_mode, Error error_code) {
-    int mode = pop();
-    uint size = pop();
-    int filename_addr = pop();
+    cell mode = pop();
+    ucell size = pop();
+    cell filename_addr = pop();
     char* filename_ptr = mem_char_ptr(filename_addr, size);
     std::string filename = std::string(filename_ptr, filename_ptr + size);
-    uint file_id = vm.files.open(filename,
+    ucell file_id = vm->files.open(filename,
                                  base_mode | static_cast<std::ios::openmode>(mode));
     if (file_id == 0) {
         push(0);        // file_id
-        push(static_cast<int>(error_code));
+        push(static_cast<cell>(error_code));
     }
-    else if (!vm.files.seek(file_id, 0, error_code)) {
+    else if (!vm->files.seek(file_id, 0, error_code)) {
         push(0);        // file_id
-        push(static_cast<int>(error_code));
+        push(static_cast<cell>(error_code));
     }
     else {
         push(file_id);    // file_id
@@ -449,136 +585,165 @@ void f_open_file() {
 }
 
 void f_read_file() {
-    uint file_id = pop();
-    uint size = pop();
-    uint addr = pop();
+    ucell file_id = pop();
+    ucell size = pop();
+    ucell addr = pop();
     char* buffer = mem_char_ptr(addr, size);
+    vm->tasks.pause();              // let the other tasks run
 
     Error error_code = Error::None;
-    int num_read = vm.files.read_bytes(file_id, buffer, size, error_code);
+    cell num_read = vm->files.read_bytes(file_id, buffer, size, error_code);
 
     push(num_read);
-    push(static_cast<int>(error_code));
+    push(static_cast<cell>(error_code));
 }
 
 void f_write_file() {
-    uint file_id = pop();
-    uint size = pop();
-    uint addr = pop();
+    ucell file_id = pop();
+    ucell size = pop();
+    ucell addr = pop();
     char* buffer = mem_char_ptr(addr, size);
 
     Error error_code = Error::None;
-    vm.files.write_bytes(file_id, buffer, size, error_code);
+    vm->files.write_bytes(file_id, buffer, size, error_code);
 
-    push(static_cast<int>(error_code));
+    push(static_cast<cell>(error_code));
+}
+
+void f_read_file_async() {
+    ucell file_id = pop();
+    ucell size = pop();
+    ucell addr = pop();
+    char* buffer = mem_char_ptr(addr, size);
+    push(vm->files.read_bytes_async(file_id, buffer, size));
+}
+
+void f_write_file_async() {
+    ucell file_id = pop();
+    ucell size = pop();
+    ucell addr = pop();
+    char* buffer = mem_char_ptr(addr, size);
+    push(vm->files.write_bytes_async(file_id, buffer, size));
+}
+
+void f_await() {
+    ucell req = pop();
+    ucell num_bytes = 0;
+    Error error_code = Error::None;
+    if (!vm->files.await(req, num_bytes, error_code)) {
+        error(Error::InvalidNumericArgument, "request " + std::to_string(req));
+    }
+    push(num_bytes);
+    push(static_cast<cell>(error_code));
 }
 
 void f_read_line() {
-    uint file_id = pop();
-    uint size = pop();
-    uint addr = pop();
+    ucell file_id = pop();
+    ucell size = pop();
+    ucell addr = pop();
     char* buffer = mem_char_ptr(addr, size);
+    vm->tasks.pause();              // let the other tasks run
 
     Error error_code = Error::None;
     bool found_eof = false;
-    uint num_read = vm.files.read_line(file_id, buffer, size,
+    ucell num_read = vm->files.read_line(file_id, buffer, size,
                                        found_eof, error_code);
 
     push(num_read);
     push(f_bool(!found_eof));
-    push(static_cast<int>(error_code));
+    push(static_cast<cell>(error_code));
 }
 
 void f_write_line() {
-    uint file_id = pop();
-    uint size = pop();
-    uint addr = pop();
+    ucell file_id = pop();
+    ucell size = pop();
+    ucell addr = pop();
     char* buffer = mem_char_ptr(addr, size);
 
     Error error_code = Error::None;
-    vm.files.write_line(file_id, buffer, size, error_code);
+    vm->files.write_line(file_id, buffer, size, error_code);
 
-    push(static_cast<int>(error_code));
+    push(static_cast<cell>(error_code));
 }
 
 void f_file_position() {
-    uint file_id = pop();
+    ucell file_id = pop();
 
     Error error_code = Error::None;
-    udint pos = vm.files.tell(file_id, error_code);
+    udint pos = vm->files.tell(file_id, error_code);
 
     dpush(pos);
-    push(static_cast<int>(error_code));
+    push(static_cast<cell>(error_code));
 }
 
 void f_reposition_file() {
-    uint file_id = pop();
+    ucell file_id = pop();
     udint pos = dpop();
 
     Error error_code = Error::None;
-    vm.files.seek(file_id, pos, error_code);
+    vm->files.seek(file_id, pos, error_code);
 
-    push(static_cast<int>(error_code));
+    push(static_cast<cell>(error_code));
 }
 
 void f_file_size() {
-    uint file_id = pop();
+    ucell file_id = pop();
 
     Error error_code = Error::None;
-    udint size = vm.files.size(file_id, error_code);
+    udint size = vm->files.size(file_id, error_code);
 
     dpush(size);
-    push(static_cast<int>(error_code));
+    push(static_cast<cell>(error_code));
 }
 
 void f_resize_file() {
-    uint file_id = pop();
+    ucell file_id = pop();
     udint size = dpop();
 
     Error error_code = Error::None;
-    vm.files.resize(file_id, size, error_code);
+    vm->files.resize(file_id, size, error_code);
 
-    push(static_cast<int>(error_code));
+    push(static_cast<cell>(error_code));
 }
 
 void f_flush_file() {
-    uint file_id = pop();
+    ucell file_id = pop();
 
     Error error_code = Error::None;
-    vm.files.flush(file_id, error_code);
+    vm->files.flush(file_id, error_code);
 
-    push(static_cast<int>(error_code));
+    push(static_cast<cell>(error_code));
 }
 
 void f_close_file() {
-    uint file_id = pop();
+    ucell file_id = pop();
 
     Error error_code = Error::None;
-    vm.files.close(file_id, error_code);
+    vm->files.close(file_id, error_code);
 
-    push(static_cast<int>(error_code));
+    push(static_cast<cell>(error_code));
 }
 
 void f_delete_file() {
-    uint size = pop();
-    int filename_addr = pop();
+    ucell size = pop();
+    cell filename_addr = pop();
     const char* filename_str = mem_char_ptr(filename_addr, size);
     std::string filename(filename_str, filename_str + size);
 
     std::error_code ec;
     bool deleted = std::filesystem::remove(filename, ec);
 
-    push(deleted ? 0 : static_cast<int>(Error::DeleteFileException));
+    push(deleted ? 0 : static_cast<cell>(Error::DeleteFileException));
 }
 
 void f_rename_file() {
-    uint size2 = pop();
-    int filename_addr2 = pop();
+    ucell size2 = pop();
+    cell filename_addr2 = pop();
     const char* filename_str2 = mem_char_ptr(filename_addr2, size2);
     std::string filename2(filename_str2, filename_str2 + size2);
 
-    uint size1 = pop();
-    int filename_addr1 = pop();
+    ucell size1 = pop();
+    cell filename_addr1 = pop();
     const char* filename_str1 = mem_char_ptr(filename_addr1, size1);
     std::string filename1(filename_str1, filename_str1 + size1);
 
@@ -589,77 +754,77 @@ void f_rename_file() {
         error_code = Error::RenameFileException;
     }
 
-    push(static_cast<int>(error_code));
+    push(static_cast<cell>(error_code));
 }
 
 void f_include_file() {
-    uint file_id = pop();
+    ucell file_id = pop();
     f_include_file(file_id);
 }
 
-void f_include_file(uint file_id) {
+void f_include_file(ucell file_id) {
     if (file_id == 0) {
         error(Error::OpenFileException);
     }
     else {
-        vm.input.save_input();
-        vm.input.open_file(file_id);
-        std::string filename = vm.files.filename(file_id);
-        vm.included_files.insert(filename);
+        vm->input.save_input();
+        vm->input.open_file(file_id);
+        std::string filename = vm->files.filename(file_id);
+        vm->included_files.insert(filename);
     }
 }
 
 void f_include() {
-    uint size = 0;
+    ucell size = 0;
     const char* filename = parse_word(size, BL);
     f_included(filename, size);
 }
 
 void f_included() {
-    uint size = pop();
-    int filename_addr = pop();
+    ucell size = pop();
+    cell filename_addr = pop();
     const char* filename_str = mem_char_ptr(filename_addr, size);
     f_included(filename_str, size);
 }
 
 void f_included(const std::string& filename) {
-    uint file_id = vm.files.open(filename, std::ios::in | std::ios::binary);
+    ucell file_id = vm->files.open(filename, std::ios::in | std::ios::binary);
     if (file_id == 0) {
         error(Error::OpenFileException, filename);
     }
     else {
-        vm.input.save_input();
-        vm.input.open_file(file_id);
-        vm.included_files.insert(filename);
+        vm->input.save_input();
+        vm->input.open_file(file_id);
+        vm->included_files.insert(filename);
     }
 }
 
-void f_included(const char* filename, uint size) {
+void f_included(const char* filename, ucell size) {
     std::string filename_str(filename, filename + size);
     f_included(filename_str);
 }
 
 void f_require() {
-    uint size = 0;
+    ucell size = 0;
     const char* filename = parse_word(size, BL);
     f_required(filename, size);
 }
 
 void f_required() {
-    uint size = pop();
-    int filename_addr = pop();
+    ucell size = pop();
+    cell filename_addr = pop();
     const char* filename_str = mem_char_ptr(filename_addr, size);
     f_required(filename_str, size);
 }
 
 void f_required(const std::string& filename) {
-    auto it = vm.included_files.find(filename);
-    if (it == vm.included_files.end()) {    // not yet included
+    auto it = vm->included_files.find(filename);
+    if (it == vm->included_files.end()) {    // not yet included
         f_included(filename);
     }
 }
 
-void f_required(const char* filename, uint size) {
+void f_required(const char* filename, ucell size) {
     f_required(std::string(filename, filename + size));
 }
 
@@ -701,8 +866,8 @@ static uint32_t get_forth_file_status(const std::string& path) {
 }
 
 void f_file_status() {
-    uint size = pop();
-    int filename_addr = pop();
+    ucell size = pop();
+    cell filename_addr = pop();
     const char* filename_str = mem_char_ptr(filename_addr, size);
     f_file_status(filename_str, size);
 }
@@ -711,7 +876,7 @@ void f_file_status(const std::string& filename) {
     uint32_t st = get_forth_file_status(filename);
     if ((st & FS_ERROR) != 0) {     // file does not exist
         push(st);
-        push(static_cast<int>(Error::FileStatusException));
+        push(static_cast<cell>(Error::FileStatusException));
     }
     else {
         push(st);
@@ -719,7 +884,7 @@ void f_file_status(const std::string& filename) {
     }
 }
 
-void f_file_status(const char* filename, uint size) {
+void f_file_status(const char* filename, ucell size) {
     f_file_status(std::string(filename, filename + size));
 }
 
@@ -8,8 +8,16 @@
 
 #include "errors.h"
 #include "forth.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <cassert>
 
@@ -23,13 +31,13 @@ public:
     bool good() const;
     bool bad() const;
     const std::string& filename() const;
-    uint read_bytes(char* buffer, uint size);
+    ucell read_bytes(char* buffer, ucell size);
     char read_char();
     char peek_char();
-    uint read_line(char* buffer, uint size, bool& found_eof);
-    void write_bytes(const char* buffer, uint size);
+    ucell read_line(char* buffer, ucell size, bool& found_eof);
+    void write_bytes(const char* buffer, ucell size);
     void write_char(char c);
-    void write_line(const char* buffer, uint size, EolType eol = EolType::LF);
+    void write_line(const char* buffer, ucell size, EolType eol = EolType::LF);
     void seek(udint pos, std::ios_base::seekdir dir = std::ios_base::beg);
     udint tell();
     void flush();
@@ -54,27 +62,65 @@ public:
     virtual ~Files();
 
     // returns file id, 0 on failure
-    uint open(const std::string& filename, std::ios::openmode mode);
-    uint open_or_create(const std::string& filename);
-    bool close(uint file_id, Error& error_code);
-    uint read_bytes(uint file_id, char* buffer, uint size, Error& error_code);
-    void write_bytes(uint file_id, const char* buffer, uint size,
+    ucell open(const std::string& filename, std::ios::openmode mode);
+    ucell open_or_create(const std::string& filename);
+    bool close(ucell file_id, Error& error_code);
+    ucell read_bytes(ucell file_id, char* buffer, ucell size, Error& error_code);
+    void write_bytes(ucell file_id, const char* buffer, ucell size,
                      Error& error_code);
-    uint read_line(uint file_id, char* buffer, uint size,
+    ucell read_line(ucell file_id, char* buffer, ucell size,
                    bool& found_eof, Error& error_code);
-    void write_line(uint file_id, char* buffer, uint size, Error& error_code);
-    bool seek(uint file_id, udint pos, Error& error_code);
-    udint tell(uint file_id, Error& error_code);
-    udint size(uint file_id, Error& error_code);
-    void resize(uint file_id, udint size, Error& error_code);
-    void flush(uint file_id, Error& error_code);
-    std::string filename(uint file_id);
+    void write_line(ucell file_id, char* buffer, ucell size, Error& error_code);
+    bool seek(ucell file_id, udint pos, Error& error_code);
+    udint tell(ucell file_id, Error& error_code);
+    udint size(ucell file_id, Error& error_code);
+    void resize(ucell file_id, udint size, Error& error_code);
+    void flush(ucell file_id, Error& error_code);
+    std::string filename(ucell file_id);
+
+    // read or write at the current position of the file in a pool of
+    // threads, return the request id; the requests of a file run in order,
+    // and the other operations on the file wait for them
+    ucell read_bytes_async(ucell file_id, char* buffer, ucell size);
+    ucell write_bytes_async(ucell file_id, char* buffer, ucell size);
+
+    // wait for the request and forget it, return false if req is not a
+    // request id
+    bool await(ucell req, ucell& num_bytes, Error& error_code);
 
 private:
     std::vector<SyncStream*> files_;
 
-    SyncStream* get_file(uint file_id);
-    int next_file_id();
+    // asynchronous request
+    struct Request {
+        ucell file_id;
+        SyncStream* fs;
+        char* buffer;
+        ucell size;
+        bool write;
+        bool done{ false };
+        ucell num_bytes{ 0 };
+        Error error_code{ Error::None };
+    };
+
+    std::vector<std::thread> io_threads_;
+    std::mutex io_mutex_;
+    std::condition_variable io_queued_;     // a request was queued, or quit
+    std::condition_variable io_done_;       // a request is done
+    std::deque<Request*> io_queue_;
+    std::unordered_map<ucell, std::unique_ptr<Request>> io_requests_;
+    std::unordered_map<ucell, ucell> io_pending_;   // not done, by file
+    std::unordered_set<ucell> io_running_;          // files being accessed
+    std::atomic<ucell> num_pending_{ 0 };
+    ucell next_request_{ 1 };
+    bool io_quit_{ false };
+
+    SyncStream* get_file(ucell file_id);
+    cell next_file_id();
+
+    ucell submit(ucell file_id, char* buffer, ucell size, bool write);
+    void wait_file(ucell file_id);
+    void io_thread();
 };
 
 void f_r_o();
@@ -86,6 +132,9 @@ void f_create_file();
 void f_open_file();
 void f_read_file();
 void f_write_file();
+void f_read_file_async();
+void f_write_file_async();
+void f_await();
 void f_read_line();
 void f_write_line();
 void f_file_position();
@@ -98,18 +147,18 @@ void f_delete_file();
 void f_rename_file();
 
 void f_include_file();
-void f_include_file(uint file_id);
+void f_include_file(ucell file_id);
 
 void f_include();
 
 void f_included();
 void f_included(const std::string& filename);
-void f_included(const char* filename, uint size);
+void f_included(const char* filename, ucell size);
 
 void f_require();
 void f_required();
 void f_required(const std::string& filename);
-void f_required(const char* filename, uint size);
+void f_required(const char* filename, ucell size);
 
 enum ForthFileStatus {
     FS_EXISTS = 0x00000001,
@@ -124,4 +173,4 @@ enum ForthFileStatus {
 
 void f_file_status();
 void f_file_status(const std::string& filename);
-void f_file_status(const char* filename, uint size);
+void f_file_status(const char* filename, ucell size);
@@ -4,53 +4,60 @@
 // License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
 //-----------------------------------------------------------------------------
 
+#include "channels.h"
 #include "control.h"
 #include "environment.h"
 #include "errors.h"
 #include "facility.h"
 #include "file.h"
 #include "forth.h"
+#include "fvector.h"
 #include "interp.h"
 #include "kbd_input.h"
 #include "locals.h"
 #include "math.h"
 #include "math96.h"
+#include "optimizer.h"
 #include "output.h"
+#include "parallel.h"
 #include "parser.h"
+#include "recognizer.h"
+#include "tasks.h"
 #include "tools.h"
 #include "vm.h"
 #include <algorithm>
 #include <cmath>
+#include <mutex>
 
 // define xtWORD for all words - execution token from dictionary
-#define CONST(word, name, flags, value) uint xt##name = 0;
-#define VAR(word, name, flags, value)   uint xt##name = 0;
-#define CODE(word, name, flags, c_code) uint xt##name = 0;
+#define CONST(word, name, flags, value) ucell xt##name = 0;
+#define VAR(word, name, flags, value)   ucell xt##name = 0;
+#define CODE(word, name, flags, c_code) ucell xt##name = 0;
 #include "words.def"
 
 // bool
-int f_bool(bool f) {
+cell f_bool(bool f) {
     return f ? F_TRUE : F_FALSE;
 }
 
 // alignment and double cells
-int aligned(int x) {
-    int al_x = (x + CELL_SZ - 1) & ~(CELL_SZ - 1);
+cell aligned(cell x) {
+    cell al_x = (x + CELL_SZ - 1) & ~(CELL_SZ - 1);
     return al_x == 0 ? x : al_x;    // if al_x is 0, alignment wrapped around
 }
 
-int dcell_lo(dint x) {
-    return x & 0xffffffffLL;
+cell dcell_lo(dint x) {
+    return static_cast<cell>(static_cast<ucell>(x));
 }
 
-int dcell_hi(dint x) {
-    return (x >> 32) & 0xffffffffLL;
+cell dcell_hi(dint x) {
+    return static_cast<cell>(static_cast<ucell>(static_cast<udint>(x) >> CELL_BITS));
 }
 
-dint mk_dcell(int hi, int lo) {
-    return
-        ((static_cast<udint>(hi) & 0xffffffffLL) << 32) |
-        (static_cast<udint>(lo) & 0xffffffffLL);
+dint mk_dcell(cell hi, cell lo) {
+    return static_cast<dint>(
+               (static_cast<udint>(static_cast<ucell>(hi)) << CELL_BITS) |
+               static_cast<udint>(static_cast<ucell>(lo)));
 }
 
 // user variables
@@ -59,51 +66,63 @@ void User::init() {
 #include "words.def"
 }
 
+// the built-in words get the same xts in every VM, only the first one
+// stores them, so that other threads running VMs only read them
+static void set_xt(ucell& xt, ucell value) {
+    if (xt != value) {
+        xt = value;
+    }
+}
+
 void create_dictionary() {
-#define CONST(word, name, flags, value) xt##name = vm.dict.create(word, flags, id##name);
-#define VAR(word, name, flags, value)   xt##name = vm.dict.create(word, flags, id##name);
-#define CODE(word, name, flags, c_code) xt##name = vm.dict.create(word, flags, id##name);
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+#define CONST(word, name, flags, value) set_xt(xt##name, vm->dict.create(word, flags, id##name));
+#define VAR(word, name, flags, value)   set_xt(xt##name, vm->dict.create(word, flags, id##name));
+#define CODE(word, name, flags, c_code) set_xt(xt##name, vm->dict.create(word, flags, id##name));
 #include "words.def"
 }
 
-void f_execute(uint xt) {
+void f_execute(ucell xt) {
+    // keep the VM of this thread in a local for the words expanded below
+    VM* const vm = ::vm;
     bool do_exit = false;
-    int old_ip = vm.ip;
-    vm.ip = 0;
+    cell old_ip = vm->ip;
+    vm->ip = 0;
     while (true) {
-        if (vm.user->TRACE) {
+        if (vm->user->TRACE) {
             Header* header = Header::header(xt);
             CString* name = header->name();
-            std::cout << std::string((2 + r_depth()), '>') << BL
-                      << name->to_string() << BL;
+            vm->out << std::string((2 + r_depth()), '>') << BL
+                    << name->to_string() << BL;
         }
 
-        uint code = fetch(xt);
-        uint body = xt + CELL_SZ;			// point to data area, if any
+        ucell code = fetch(xt);
+        ucell body = xt + CELL_SZ;			// point to data area, if any
 
         switch (code) {
 #define CONST(word, name, flags, value) case id##name: push(value); break;
-#define VAR(word, name, flags, value)   case id##name: push(mem_addr(&vm.user->name)); break;
+#define VAR(word, name, flags, value)   case id##name: push(mem_addr(&vm->user->name)); break;
 #define CODE(word, name, flags, c_code) case id##name: { c_code; break; }
 #include "words.def"
         default:
             error(Error::InvalidMemoryAddress, std::to_string(xt));
         }
 
-        if (vm.user->TRACE) {
-            vm.stack.print_debug();
-            if (!vm.f_stack.empty()) {
-                vm.f_stack.print_debug();
+        if (vm->user->TRACE) {
+            vm->stack.print_debug(vm->out);
+            if (!vm->f_stack.empty()) {
+                vm->f_stack.print_debug(vm->out);
             }
-            std::cout << std::endl;
+            vm->out << std::endl;
         }
 
-        if (vm.ip == 0 || do_exit) {	// ip did not change, exit
+        if (vm->ip == 0 || do_exit) {	// ip did not change, exit
             break;
         }
 
-        xt = fetch(vm.ip);
-        vm.ip += CELL_SZ;	    // else fetch next xt from ip
+        xt = fetch(vm->ip);
+        vm->ip += CELL_SZ;	    // else fetch next xt from ip
     }
-    vm.ip = old_ip;
+    vm->ip = old_ip;
 }
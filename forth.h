@@ -8,58 +8,81 @@
 
 #include <climits>
 #include <cstdint>
+#include <limits>
 #include <string>
 
 // types
 typedef uint8_t uchar;
-typedef unsigned int uint;
+
+// cells are 32 bits wide, or 64 bits wide if built with CELL64 defined
+#ifdef CELL64
+#ifndef __SIZEOF_INT128__
+#error "CELL64 needs a compiler with 128-bit integers"
+#endif
+typedef int64_t cell;
+typedef uint64_t ucell;
+__extension__ typedef __int128 dint;
+__extension__ typedef unsigned __int128 udint;
+#else
+typedef int32_t cell;
+typedef uint32_t ucell;
 typedef int64_t dint;
 typedef uint64_t udint;
+#endif
 
 // types sizes
-static const int CHAR_SZ = sizeof(char);
-static const int CELL_SZ = sizeof(int);
-static const int DCELL_SZ = sizeof(dint);
-static const int FCELL_SZ = sizeof(double);
+static const cell CHAR_SZ = sizeof(char);
+static const cell CELL_SZ = sizeof(cell);
+static const cell DCELL_SZ = sizeof(dint);
+static const cell FCELL_SZ = sizeof(double);
+static const cell CELL_BITS = CELL_SZ * CHAR_BIT;
 
 static_assert(CELL_SZ * 2 == DCELL_SZ, "DCELL should be double of CELL");
-
-// size of the virtual machine
-static const int MEM_SZ = 2 * 1024 * 1024;
-static const int BUFFER_SZ = 1024;
-static const int TIB_SZ = BUFFER_SZ + CELL_SZ; // leave room for BL, align
-static const int WORDBUF_SZ = 2 * BUFFER_SZ;
-static const int PAD_SZ = 256;
-static const int NUMBER_OUTPUT_SZ = 256;
-static const int STACK_SZ = INT_MAX; // limited by available memory
-static const int MAX_CSTRING_SZ = 0xff;
-static const int MAX_NAME_SZ = 0x3f;
-static const int SYSTEM_WID = 0;
+static_assert(CELL_SZ <= FCELL_SZ, "FCELL should hold a CELL");
+
+static const cell CELL_MAX = std::numeric_limits<cell>::max();
+static const ucell UCELL_MAX = std::numeric_limits<ucell>::max();
+
+// size of the virtual machine, can be set at build time
+#ifdef FORTH_MEM_SZ
+static const ucell MEM_SZ = FORTH_MEM_SZ;
+#else
+static const ucell MEM_SZ = 2 * 1024 * 1024;
+#endif
+static const cell BUFFER_SZ = 1024;
+static const cell TIB_SZ = BUFFER_SZ + CELL_SZ; // leave room for BL, align
+static const cell WORDBUF_SZ = 2 * BUFFER_SZ;
+static const cell PAD_SZ = 256;
+static const cell NUMBER_OUTPUT_SZ = 256;
+static const cell STACK_SZ = INT_MAX; // limited by available memory
+static const cell MAX_CSTRING_SZ = 0xff;
+static const cell MAX_NAME_SZ = 0x3f;
+static const cell SYSTEM_WID = 0;
 
 // constants
 static const char BL = ' ';
 static const char CR = '\n';
-static const int SCREEN_WIDTH = 80;
+static const cell SCREEN_WIDTH = 80;
 
-static const int F_TRUE = -1;
-static const int F_FALSE = 0;
+static const cell F_TRUE = -1;
+static const cell F_FALSE = 0;
 
-static const int F_SMUDGE = 0x20;
-static const int F_HIDDEN = 0x40;
-static const int F_IMMEDIATE = 0x80;
+static const cell F_SMUDGE = 0x20;
+static const cell F_HIDDEN = 0x40;
+static const cell F_IMMEDIATE = 0x80;
 
-static const int STATE_INTERPRET = 0;
-static const int STATE_COMPILE = 1;
+static const cell STATE_INTERPRET = 0;
+static const cell STATE_COMPILE = 1;
 
 static const double EPSILON = 1e-10;
-static const uint MAX_PRECISION = 15;
+static const ucell MAX_PRECISION = 15;
 
 // blocks
 static const std::string BLOCKS_FILE = "blocks.fb";
-static const int BLOCK_SZ = 1024;
-static const int BLOCK_ROWS = 16;
-static const int BLOCK_COLS = 64;
-static const int NUM_BLK_BUFFERS = 16;
+static const cell BLOCK_SZ = 1024;
+static const cell BLOCK_ROWS = 16;
+static const cell BLOCK_COLS = 64;
+static const cell NUM_BLK_BUFFERS = 16;
 
 // idWORD for all words - used in switch statement to select word to execute
 enum {
@@ -70,23 +93,23 @@ enum {
 };
 
 // declare xtWORD for all words - execution token from dictionary
-#define CONST(word, name, flags, value) extern uint xt##name;
-#define VAR(word, name, flags, value)   extern uint xt##name;
-#define CODE(word, name, flags, c_code) extern uint xt##name;
+#define CONST(word, name, flags, value) extern ucell xt##name;
+#define VAR(word, name, flags, value)   extern ucell xt##name;
+#define CODE(word, name, flags, c_code) extern ucell xt##name;
 #include "words.def"
 
 // bool
-int f_bool(bool f);
+cell f_bool(bool f);
 
 // alignment and double cells
-int aligned(int x);
-int dcell_lo(dint x);
-int dcell_hi(dint x);
-dint mk_dcell(int hi, int lo);
+cell aligned(cell x);
+cell dcell_lo(dint x);
+cell dcell_hi(dint x);
+dint mk_dcell(cell hi, cell lo);
 
 // user variables
 struct User {
-#define VAR(word, name, flags, value)   int name;
+#define VAR(word, name, flags, value)   cell name;
 #include "words.def"
 
     void init();
@@ -96,4 +119,4 @@ struct User {
 void create_dictionary();
 
 // inner interpreter
-void f_execute(uint xt);
+void f_execute(ucell xt);
@@ -0,0 +1,476 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#include "errors.h"
+#include "forth.h"
+#include "fvector.h"
+#include "simd.h"
+#include "vm.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// kernels for one instruction set, n elements of each array
+struct FVectorKernels {
+    void (*add)(const double* a, const double* b, double* dst, size_t n);
+    void (*mult)(const double* a, const double* b, double* dst, size_t n);
+    void (*scale)(const double* a, double r, double* dst, size_t n);
+    void (*axpy)(double r, const double* a, double* dst, size_t n);
+    void (*sqrt)(const double* a, double* dst, size_t n);
+    double (*dot)(const double* a, const double* b, size_t n);
+    double (*sum)(const double* a, size_t n);
+};
+
+//-----------------------------------------------------------------------------
+// scalar fallback
+
+static void add_scalar(const double* a, const double* b, double* dst,
+                       size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = a[i] + b[i];
+    }
+}
+
+static void mult_scalar(const double* a, const double* b, double* dst,
+                        size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = a[i] * b[i];
+    }
+}
+
+static void scale_scalar(const double* a, double r, double* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = a[i] * r;
+    }
+}
+
+static void axpy_scalar(double r, const double* a, double* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] += r * a[i];
+    }
+}
+
+static void sqrt_scalar(const double* a, double* dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = std::sqrt(a[i]);
+    }
+}
+
+static double dot_scalar(const double* a, const double* b, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+static double sum_scalar(const double* a, size_t n) {
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sum += a[i];
+    }
+    return sum;
+}
+
+static const FVectorKernels scalar_kernels = {
+    add_scalar, mult_scalar, scale_scalar, axpy_scalar, sqrt_scalar,
+    dot_scalar, sum_scalar
+};
+
+#ifdef SIMD_X86
+
+//-----------------------------------------------------------------------------
+// SSE2, 2 doubles per register
+
+__attribute__((target("sse2")))
+static void add_sse2(const double* a, const double* b, double* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(dst + i, _mm_add_pd(_mm_loadu_pd(a + i),
+                                          _mm_loadu_pd(b + i)));
+    }
+    add_scalar(a + i, b + i, dst + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void mult_sse2(const double* a, const double* b, double* dst,
+                      size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(dst + i, _mm_mul_pd(_mm_loadu_pd(a + i),
+                                          _mm_loadu_pd(b + i)));
+    }
+    mult_scalar(a + i, b + i, dst + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void scale_sse2(const double* a, double r, double* dst, size_t n) {
+    __m128d vr = _mm_set1_pd(r);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(dst + i, _mm_mul_pd(_mm_loadu_pd(a + i), vr));
+    }
+    scale_scalar(a + i, r, dst + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void axpy_sse2(double r, const double* a, double* dst, size_t n) {
+    __m128d vr = _mm_set1_pd(r);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(dst + i, _mm_add_pd(_mm_loadu_pd(dst + i),
+                                          _mm_mul_pd(_mm_loadu_pd(a + i), vr)));
+    }
+    axpy_scalar(r, a + i, dst + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void sqrt_sse2(const double* a, double* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(dst + i, _mm_sqrt_pd(_mm_loadu_pd(a + i)));
+    }
+    sqrt_scalar(a + i, dst + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static double hsum_sse2(__m128d v) {
+    double lanes[2];
+    _mm_storeu_pd(lanes, v);
+    return lanes[0] + lanes[1];
+}
+
+__attribute__((target("sse2")))
+static double dot_sse2(const double* a, const double* b, size_t n) {
+    __m128d acc = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(a + i),
+                                         _mm_loadu_pd(b + i)));
+    }
+    return hsum_sse2(acc) + dot_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static double sum_sse2(const double* a, size_t n) {
+    __m128d acc = _mm_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        acc = _mm_add_pd(acc, _mm_loadu_pd(a + i));
+    }
+    return hsum_sse2(acc) + sum_scalar(a + i, n - i);
+}
+
+static const FVectorKernels sse2_kernels = {
+    add_sse2, mult_sse2, scale_sse2, axpy_sse2, sqrt_sse2, dot_sse2, sum_sse2
+};
+
+//-----------------------------------------------------------------------------
+// AVX2, 4 doubles per register
+
+__attribute__((target("avx2")))
+static void add_avx2(const double* a, const double* b, double* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(a + i),
+                                                _mm256_loadu_pd(b + i)));
+    }
+    add_scalar(a + i, b + i, dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void mult_avx2(const double* a, const double* b, double* dst,
+                      size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(dst + i, _mm256_mul_pd(_mm256_loadu_pd(a + i),
+                                                _mm256_loadu_pd(b + i)));
+    }
+    mult_scalar(a + i, b + i, dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void scale_avx2(const double* a, double r, double* dst, size_t n) {
+    __m256d vr = _mm256_set1_pd(r);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(dst + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), vr));
+    }
+    scale_scalar(a + i, r, dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void axpy_avx2(double r, const double* a, double* dst, size_t n) {
+    __m256d vr = _mm256_set1_pd(r);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(dst + i,
+                         _mm256_add_pd(_mm256_loadu_pd(dst + i),
+                                       _mm256_mul_pd(_mm256_loadu_pd(a + i), vr)));
+    }
+    axpy_scalar(r, a + i, dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void sqrt_avx2(const double* a, double* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(dst + i, _mm256_sqrt_pd(_mm256_loadu_pd(a + i)));
+    }
+    sqrt_scalar(a + i, dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static double hsum_avx2(__m256d v) {
+    double lanes[4];
+    _mm256_storeu_pd(lanes, v);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+__attribute__((target("avx2")))
+static double dot_avx2(const double* a, const double* b, size_t n) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(a + i),
+                                               _mm256_loadu_pd(b + i)));
+    }
+    return hsum_avx2(acc) + dot_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static double sum_avx2(const double* a, size_t n) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_add_pd(acc, _mm256_loadu_pd(a + i));
+    }
+    return hsum_avx2(acc) + sum_scalar(a + i, n - i);
+}
+
+static const FVectorKernels avx2_kernels = {
+    add_avx2, mult_avx2, scale_avx2, axpy_avx2, sqrt_avx2, dot_avx2, sum_avx2
+};
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+static const FVectorKernels& kernels() {
+    switch (simd_level()) {
+#ifdef SIMD_X86
+    case SimdLevel::AVX2:
+        return avx2_kernels;
+    case SimdLevel::SSE2:
+        return sse2_kernels;
+#endif
+    default:
+        return scalar_kernels;
+    }
+}
+
+// pointer to an array of n floats
+static double* vector_ptr(ucell addr, cell n) {
+    if (static_cast<ucell>(n) > MEM_SZ / FCELL_SZ) {
+        error(Error::InvalidMemoryAddress);
+    }
+    return mem_float_ptr(addr, n * FCELL_SZ);
+}
+
+void f_fv_plus() {
+    cell n = pop();
+    ucell dst = pop();
+    ucell b = pop();
+    ucell a = pop();
+    if (n > 0) {
+        kernels().add(vector_ptr(a, n), vector_ptr(b, n), vector_ptr(dst, n), n);
+    }
+}
+
+void f_fv_mult() {
+    cell n = pop();
+    ucell dst = pop();
+    ucell b = pop();
+    ucell a = pop();
+    if (n > 0) {
+        kernels().mult(vector_ptr(a, n), vector_ptr(b, n), vector_ptr(dst, n), n);
+    }
+}
+
+void f_fv_scale() {
+    cell n = pop();
+    ucell dst = pop();
+    ucell a = pop();
+    double r = fpop();
+    if (n > 0) {
+        kernels().scale(vector_ptr(a, n), r, vector_ptr(dst, n), n);
+    }
+}
+
+void f_fv_sqrt() {
+    cell n = pop();
+    ucell dst = pop();
+    ucell a = pop();
+    if (n > 0) {
+        kernels().sqrt(vector_ptr(a, n), vector_ptr(dst, n), n);
+    }
+}
+
+void f_fdot() {
+    cell n = pop();
+    ucell b = pop();
+    ucell a = pop();
+    if (n > 0) {
+        fpush(kernels().dot(vector_ptr(a, n), vector_ptr(b, n), n));
+    }
+    else {
+        fpush(0.0);
+    }
+}
+
+void f_fsum() {
+    cell n = pop();
+    ucell a = pop();
+    if (n > 0) {
+        fpush(kernels().sum(vector_ptr(a, n), n));
+    }
+    else {
+        fpush(0.0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// row-major matrices
+
+// block sizes of the matrix multiplication, a block of rows of b of
+// MAT_BLOCK_INNER x MAT_BLOCK_COLS doubles (128KB) stays in the L2 cache
+static const size_t MAT_BLOCK_ROWS = 32;
+static const size_t MAT_BLOCK_INNER = 64;
+static const size_t MAT_BLOCK_COLS = 256;
+
+// minimum number of multiply-adds to split the rows among threads
+static const size_t MAT_PARALLEL_WORK = 1 << 20;
+
+// pointer to a matrix of m x n floats
+static double* matrix_ptr(ucell addr, cell m, cell n) {
+    if (m < 0 || n < 0 ||
+            (n != 0 && static_cast<ucell>(m) > MEM_SZ / FCELL_SZ / n)) {
+        error(Error::InvalidMemoryAddress);
+    }
+    return mem_float_ptr(addr, m * n * FCELL_SZ);
+}
+
+// call f(i0, i1) on ranges of the m rows, in parallel if work is large
+static void for_rows(size_t m, size_t work,
+                     const std::function<void(size_t, size_t)>& f) {
+    size_t threads = std::min<size_t>(std::thread::hardware_concurrency(), m);
+    if (work < MAT_PARALLEL_WORK || threads < 2) {
+        f(0, m);
+        return;
+    }
+
+    size_t chunk = (m + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (size_t i0 = chunk; i0 < m; i0 += chunk) {
+        workers.emplace_back(f, i0, std::min(i0 + chunk, m));
+    }
+    f(0, chunk);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// rows i0 to i1 of c(m x p) = a(m x n) * b(n x p)
+static void mat_mult_rows(const double* a, const double* b, double* c,
+                          size_t n, size_t p, size_t i0, size_t i1) {
+    const FVectorKernels& k = kernels();
+    std::fill(c + i0 * p, c + i1 * p, 0.0);
+    for (size_t ii = i0; ii < i1; ii += MAT_BLOCK_ROWS) {
+        size_t i_end = std::min(ii + MAT_BLOCK_ROWS, i1);
+        for (size_t kk = 0; kk < n; kk += MAT_BLOCK_INNER) {
+            size_t k_end = std::min(kk + MAT_BLOCK_INNER, n);
+            for (size_t jj = 0; jj < p; jj += MAT_BLOCK_COLS) {
+                size_t cols = std::min(MAT_BLOCK_COLS, p - jj);
+                for (size_t i = ii; i < i_end; i++) {
+                    for (size_t kx = kk; kx < k_end; kx++) {
+                        k.axpy(a[i * n + kx], b + kx * p + jj, c + i * p + jj,
+                               cols);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void f_mat_mult() {
+    cell p = pop();
+    cell n = pop();
+    cell m = pop();
+    ucell c_addr = pop();
+    ucell b_addr = pop();
+    ucell a_addr = pop();
+    const double* a = matrix_ptr(a_addr, m, n);
+    const double* b = matrix_ptr(b_addr, n, p);
+    double* c = matrix_ptr(c_addr, m, p);
+    if (m > 0 && p > 0) {
+        for_rows(m, static_cast<size_t>(m) * n * p, [&](size_t i0, size_t i1) {
+            mat_mult_rows(a, b, c, n, p, i0, i1);
+        });
+    }
+}
+
+void f_mat_plus() {
+    cell n = pop();
+    cell m = pop();
+    ucell c_addr = pop();
+    ucell b_addr = pop();
+    ucell a_addr = pop();
+    const double* a = matrix_ptr(a_addr, m, n);
+    const double* b = matrix_ptr(b_addr, m, n);
+    double* c = matrix_ptr(c_addr, m, n);
+    kernels().add(a, b, c, static_cast<size_t>(m) * n);
+}
+
+void f_mat_mult_vector() {
+    cell n = pop();
+    cell m = pop();
+    ucell y_addr = pop();
+    ucell x_addr = pop();
+    ucell a_addr = pop();
+    const double* a = matrix_ptr(a_addr, m, n);
+    const double* x = matrix_ptr(x_addr, 1, n);
+    double* y = matrix_ptr(y_addr, 1, m);
+    for_rows(m, static_cast<size_t>(m) * n, [&](size_t i0, size_t i1) {
+        const FVectorKernels& k = kernels();
+        for (size_t i = i0; i < i1; i++) {
+            y[i] = k.dot(a + i * n, x, n);
+        }
+    });
+}
+
+void f_mat_transpose() {
+    cell n = pop();
+    cell m = pop();
+    ucell b_addr = pop();
+    ucell a_addr = pop();
+    const double* a = matrix_ptr(a_addr, m, n);
+    double* b = matrix_ptr(b_addr, n, m);
+    const size_t block = 32;
+    for (size_t ii = 0; ii < static_cast<size_t>(m); ii += block) {
+        size_t i_end = std::min<size_t>(ii + block, m);
+        for (size_t jj = 0; jj < static_cast<size_t>(n); jj += block) {
+            size_t j_end = std::min<size_t>(jj + block, n);
+            for (size_t i = ii; i < i_end; i++) {
+                for (size_t j = jj; j < j_end; j++) {
+                    b[j * m + i] = a[i * n + j];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,25 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "forth.h"
+
+// bulk operations on arrays of floats, using the SIMD kernels supported by
+// the CPU
+
+void f_fv_plus();
+void f_fv_mult();
+void f_fv_scale();
+void f_fv_sqrt();
+void f_fdot();
+void f_fsum();
+
+// row-major matrices of floats
+void f_mat_mult();
+void f_mat_plus();
+void f_mat_mult_vector();
+void f_mat_transpose();
@@ -16,26 +16,26 @@ class Pad {
 public:
     void init();
 
-// pad buffer pointer by vm.pad_data
+// pad buffer pointer by vm->pad_data
 };
 
 class Input {
 public:
     void init();
 
-    int source_id() const;
+    cell source_id() const;
     const char* buffer() const;
 
     void open_file(const std::string& filename);
-    void open_file(int source_id);
+    void open_file(cell source_id);
 
     void open_terminal();
 
-    void set_text(const char* text, uint size);
+    void set_text(const char* text, ucell size);
 
     void set_block(Block* block);
 
-    void set_tib(const char* text, uint size);
+    void set_tib(const char* text, ucell size);
     void set_tib(const std::string& text);
 
     bool refill();
@@ -46,23 +46,23 @@ public:
     void save_input_for_query();
     bool restore_input_if_query();
 
-    int input_level() const;
-    void restore_input(int level);
+    cell input_level() const;
+    void restore_input(cell level);
 
 private:
-    int source_id_;         // 0: terminal, >=1: file, -1: string
-    int num_query_;         // number of times f_query was called and save_input() called within
+    cell source_id_;         // 0: terminal, >=1: file, -1: string
+    cell num_query_;         // number of times f_query was called and save_input() called within
 
-    // data in vm.tib_data and vm.tib_ptr
+    // data in vm->tib_data and vm->tib_ptr
 
     struct SaveInput {
-        int source_id;
+        cell source_id;
         udint fpos;
-        int blk;
+        cell blk;
         std::string tib;
         const char* tib_ptr;
-        int nr_in;
-        int to_in;
+        cell nr_in;
+        cell to_in;
     };
 
     std::vector<SaveInput> input_stack_;    // stack of saved inputs
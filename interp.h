@@ -11,17 +11,18 @@
 
 // outer interpreter
 void f_interpret_word(const std::string& word);
-void f_interpret_word(const char* word, uint size);
+void f_interpret_word(const char* word, ucell size);
 void f_interpret();
 
 // evaluate text
 void f_evaluate();
 void f_evaluate(const std::string& text);
-void f_evaluate(const char* text, uint size);
+void f_evaluate(const char* text, ucell size);
 
 // main loop
 void f_quit();
 
 // stack frame for function calls
-void enter_func(uint called_ip);
+void enter_func(ucell called_ip);
 void leave_func();
+void tail_func(ucell called_ip);
@@ -37,21 +37,37 @@ uint32_t ekey_to_fkey(uint32_t ekey) {
     return is_printable_char(key_code) ? 0 : ekey;
 }
 
+// input from pipes and files is read at once, it does not wait for the user
+void wait_input() {
+    static const bool is_terminal = input_is_terminal();
+    if (is_terminal) {
+        while (vm->tasks.multitasking() && !key_available()) {
+            vm->tasks.wait();
+        }
+    }
+}
+
 // Forth interface functions
 void f_key_query() {
+    vm->out.flush();
     push(f_bool(key_available()));
 }
 
 void f_key() {
+    vm->out.flush();
+    wait_input();
     int key = get_key();
     push(key);
 }
 
 void f_ekey_query() {
+    vm->out.flush();
     push(f_bool(key_available()));
 }
 
 void f_ekey() {
+    vm->out.flush();
+    wait_input();
     uint32_t ekey = get_ekey();
     push(ekey);
 }
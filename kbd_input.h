@@ -57,6 +57,12 @@ uint32_t ekey_to_fkey(uint32_t ekey);
 // Check if a key is available (non-blocking)
 bool key_available();
 
+// Check if stdin is a terminal
+bool input_is_terminal();
+
+// Let the other tasks run until the terminal has input
+void wait_input();
+
 // Platform-specific key reader
 int get_key();
 
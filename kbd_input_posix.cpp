@@ -27,6 +27,10 @@ bool key_available() {
     return select(STDIN_FILENO + 1, &read_fds, nullptr, nullptr, &timeout) > 0;
 }
 
+bool input_is_terminal() {
+    return isatty(STDIN_FILENO) != 0;
+}
+
 // Platform-specific key reader
 int get_key() {
     struct termios oldt, newt;
@@ -9,6 +9,7 @@
 #ifdef _WIN32
 #include <conio.h>
 #include <cstdio>
+#include <io.h>
 #include <windows.h>
 
 static HANDLE hStdin = nullptr;
@@ -28,6 +29,10 @@ bool key_available() {
     return _kbhit();
 }
 
+bool input_is_terminal() {
+    return _isatty(_fileno(stdin)) != 0;
+}
+
 // Platform-specific key reader
 int get_key() {
     while (true) {
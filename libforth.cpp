@@ -0,0 +1,193 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#include "environment.h"
+#include "errors.h"
+#include "file.h"
+#include "forth.h"
+#include "input.h"
+#include "interp.h"
+#include "libforth.h"
+#include "parallel.h"
+#include "vm.h"
+#include <cstring>
+
+ForthVM* forth_create(void) {
+    return new VM;
+}
+
+void forth_destroy(ForthVM* fvm) {
+    delete fvm;
+}
+
+void forth_set_args(int argc, char* argv[]) {
+    g_argc = argc;
+    g_argv = argv;
+}
+
+void forth_set_threads(int num_threads) {
+    set_parallel_threads(num_threads);
+}
+
+// keep the message of an error caught by the API, leave compilation mode
+static int caught(cell error_code) {
+    if (error_code != 0) {
+        vm->last_error = error_message(error_code);
+        vm->user->STATE = STATE_INTERPRET;
+    }
+    return static_cast<int>(error_code);
+}
+
+int forth_evaluate(ForthVM* fvm, const char* text) {
+    fvm->make_current();
+    ucell size = static_cast<ucell>(strlen(text));
+    cell error_code = catch_error([text, size]() { f_evaluate(text, size); });
+    return caught(error_code);
+}
+
+const char* forth_error_message(ForthVM* fvm) {
+    return fvm->last_error.c_str();
+}
+
+int forth_include(ForthVM* fvm, const char* filename) {
+    fvm->make_current();
+    cell error_code = catch_error([filename]() {
+        // interpret the file and the ones it includes up to its end
+        cell level = vm->input.input_level();
+        f_included(std::string(filename));
+        while (true) {
+            while (f_refill()) {
+                f_interpret();
+            }
+            vm->input.restore_input();
+            if (vm->input.input_level() <= level) {
+                break;
+            }
+            f_interpret();  // rest of the line that included the file
+        }
+    });
+    return caught(error_code);
+}
+
+void forth_interpret(ForthVM* fvm, const char* text) {
+    fvm->make_current();
+    vm->input.set_text(text, static_cast<ucell>(strlen(text)));
+    f_execute(xtINTERPRET);
+}
+
+void forth_run(ForthVM* fvm, const char* filename) {
+    fvm->make_current();
+    if (filename == nullptr) {
+        vm->input.open_terminal();
+        g_interactive = true;
+    }
+    else {
+        vm->input.open_file(filename);
+    }
+    f_execute(xtQUIT);
+}
+
+void forth_set_trace(ForthVM* fvm, int trace) {
+    fvm->user->TRACE = f_bool(trace != 0);
+}
+
+void forth_push(ForthVM* fvm, forth_cell value) {
+    fvm->make_current();
+    push(static_cast<cell>(value));
+}
+
+forth_cell forth_pop(ForthVM* fvm) {
+    fvm->make_current();
+    // outside a callback there is no CATCH frame to report the underflow to
+    if (vm->stack.empty() && vm->except_stack.empty()) {
+        return 0;
+    }
+    return static_cast<forth_cell>(pop());
+}
+
+int forth_depth(ForthVM* fvm) {
+    return static_cast<int>(fvm->stack.size());
+}
+
+void forth_fpush(ForthVM* fvm, double value) {
+    fvm->make_current();
+    fpush(value);
+}
+
+double forth_fpop(ForthVM* fvm) {
+    fvm->make_current();
+    if (vm->f_stack.empty() && vm->except_stack.empty()) {
+        return 0.0;
+    }
+    return fpop();
+}
+
+int forth_fdepth(ForthVM* fvm) {
+    return static_cast<int>(fvm->f_stack.size());
+}
+
+void forth_throw(ForthVM* fvm, int error_code) {
+    fvm->make_current();
+    f_throw(static_cast<cell>(error_code));
+}
+
+int forth_register(ForthVM* fvm, const char* name, forth_callback func,
+                   void* user_data) {
+    fvm->make_current();
+    ucell size = static_cast<ucell>(strlen(name));
+    cell error_code = catch_error([name, size, func, user_data]() {
+        if (size == 0) {
+            error(Error::AttemptToUseZeroLengthStringAsName);
+        }
+        else if (size > MAX_NAME_SZ) {
+            error(Error::DefinitionNameTooLong, std::string(name, name + size));
+        }
+        vm->dict.create(name, size, 0, idXCALLBACK);
+        comma(static_cast<cell>(vm->callbacks.size()));
+        vm->callbacks.push_back(HostCallback{ func, user_data });
+    });
+    return static_cast<int>(error_code);
+}
+
+void f_xcallback(ucell body) {
+    VM* self = vm;
+    HostCallback callback = self->callbacks[fetch(body)];
+    callback.func(self, callback.user_data);
+    self->make_current();       // the callback may have used other VMs
+}
+
+ForthSnapshot* forth_save_snapshot(ForthVM* fvm) {
+    ForthSnapshot* snapshot = new ForthSnapshot;
+    fvm->save_snapshot(*snapshot);
+    return snapshot;
+}
+
+void forth_restore_snapshot(ForthVM* fvm, const ForthSnapshot* snapshot) {
+    fvm->restore_snapshot(*snapshot);
+}
+
+void forth_free_snapshot(ForthSnapshot* snapshot) {
+    delete snapshot;
+}
+
+void forth_capture_output(ForthVM* fvm, int capture) {
+    fvm->out.flush();
+    fvm->console.set_capture(capture != 0);
+}
+
+const char* forth_output(ForthVM* fvm, size_t* size) {
+    fvm->out.flush();
+    const std::string& output = fvm->console.captured();
+    if (size != nullptr) {
+        *size = output.size();
+    }
+    return output.c_str();
+}
+
+void forth_clear_output(ForthVM* fvm) {
+    fvm->out.flush();
+    fvm->console.captured().clear();
+}
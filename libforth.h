@@ -0,0 +1,116 @@
+/*-----------------------------------------------------------------------------
+ * C++ implementation of a Forth interpreter
+ * Copyright (c) Paulo Custodio, 2020-2026
+ * License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+ *-----------------------------------------------------------------------------
+ * C and C++ interface of libforth
+ *
+ * Each ForthVM is an independent interpreter. A VM may be used by one thread
+ * at a time; different VMs may run in parallel in different threads.
+ * Build the client with -DCELL64 if libforth was built with CELL64=1.
+ *---------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct VM ForthVM;
+typedef struct VMSnapshot ForthSnapshot;
+
+#ifdef CELL64
+typedef int64_t forth_cell;
+#else
+typedef int32_t forth_cell;
+#endif
+
+/* host function called when the word created by forth_register() runs;
+   it takes its arguments from the stacks and pushes its results; errors
+   unwind through it as C++ exceptions, compile C callbacks with -fexceptions */
+typedef void (*forth_callback)(ForthVM* vm, void* user_data);
+
+/* create and destroy a VM, the destructor flushes its output */
+ForthVM* forth_create(void);
+void forth_destroy(ForthVM* vm);
+
+/* arguments returned by NEXT-ARG, shared by all the VMs */
+void forth_set_args(int argc, char* argv[]);
+
+/* threads that run PARALLEL-FOR and PARALLEL-REDUCE, including the
+   calling one, 0 for one per processor; used by VMs that have not run a
+   parallel loop yet */
+void forth_set_threads(int num_threads);
+
+/* interpret the text, return 0 or the THROW code of an uncaught error;
+   the error does not end the process and, like CATCH, restores the depth
+   of the stacks at the call */
+int forth_evaluate(ForthVM* vm, const char* text);
+
+/* message of the last uncaught error, empty for ABORT */
+const char* forth_error_message(ForthVM* vm);
+
+/* interpret the source file, return 0 or the THROW code like
+   forth_evaluate() */
+int forth_include(ForthVM* vm, const char* filename);
+
+/* interpret the text like the -e option of the forth executable:
+   an uncaught error shows the message and ends the process */
+void forth_interpret(ForthVM* vm, const char* text);
+
+/* run the source file, or the terminal if filename is NULL, and end the
+   process at the end of input, like the forth executable */
+void forth_run(ForthVM* vm, const char* filename);
+
+/* trace execution of words */
+void forth_set_trace(ForthVM* vm, int trace);
+
+/* data and floating point stacks; popping an empty stack inside a callback
+   makes forth_evaluate() return a stack underflow, outside it returns 0 */
+void forth_push(ForthVM* vm, forth_cell value);
+forth_cell forth_pop(ForthVM* vm);
+int forth_depth(ForthVM* vm);
+
+void forth_fpush(ForthVM* vm, double value);
+double forth_fpop(ForthVM* vm);
+int forth_fdepth(ForthVM* vm);
+
+/* inside a callback, abort the word with a THROW code */
+void forth_throw(ForthVM* vm, int error_code);
+
+/* define a word in the current definitions wordlist that calls func,
+   return 0 or the THROW code if the name is not valid */
+int forth_register(ForthVM* vm, const char* name, forth_callback func,
+                   void* user_data);
+
+/* save the memory and the dictionary of a VM, e.g. after loading its
+   libraries, and restore them into the same or another VM, clearing the
+   stacks; open files and block buffers are not saved */
+ForthSnapshot* forth_save_snapshot(ForthVM* vm);
+void forth_restore_snapshot(ForthVM* vm, const ForthSnapshot* snapshot);
+void forth_free_snapshot(ForthSnapshot* snapshot);
+
+/* serve requests on a Unix domain socket with a pool of workers, each one
+   a VM restored from a snapshot of vm before every request; each request
+   is the source text up to the end of the client's writes, the response is
+   a header followed by the captured output:
+       status: <0 or THROW code>
+       message: <error message>         (if status is not 0)
+       stack: <cells of the data stack>
+       fstack: <floats of the float stack>
+       <empty line>
+       <output>
+   returns only if the socket cannot be created */
+int forth_serve(ForthVM* vm, const char* socket_path, int num_workers);
+
+/* collect the output in a buffer instead of writing it to stdout */
+void forth_capture_output(ForthVM* vm, int capture);
+const char* forth_output(ForthVM* vm, size_t* size);
+void forth_clear_output(ForthVM* vm);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,49 +8,79 @@
 #include "locals.h"
 #include "parser.h"
 #include "vm.h"
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 
+// clear the names of the definition being compiled
 void Locals::clear() {
-    vars_.clear();
-    frame_ = 0;
     names_.clear();
+    num_cells_ = 0;
+    num_cells_addr_ = 0;
 }
 
-uint Locals::size() const {
-    return static_cast<uint>(vars_.size());
+ucell Locals::size() const {
+    return static_cast<ucell>(sp_);
 }
 
-void Locals::resize(uint size) {
-    vars_.resize(size);
+void Locals::resize(ucell size) {
+    sp_ = size;
 }
 
-uint Locals::frame() const {
-    return static_cast<uint>(frame_);
+ucell Locals::frame() const {
+    return static_cast<ucell>(frame_);
 }
 
-void Locals::set_frame(uint frame) {
+void Locals::set_frame(ucell frame) {
     frame_ = frame;
 }
 
-void Locals::enter_frame() {
-    VarValue v;
-    v.type = VarType::Frame;
-    v.value.frame = frame_;
-    frame_ = vars_.size() + 1;
-    vars_.push_back(v);
+void Locals::enter_frame(ucell num_cells) {
+    size_t new_sp = sp_ + 1 + num_cells;
+    if (new_sp > data_.size()) {
+        data_.resize(std::max(new_sp, 2 * data_.size()));
+    }
+    data_[sp_] = static_cast<cell>(frame_);
+    frame_ = sp_ + 1;
+    sp_ = new_sp;
 }
 
 void Locals::leave_frame() {
-    if (vars_.empty()) {
+    if (frame_ == 0) {
         // no frame_ to leave
-        frame_ = 0;
+        sp_ = 0;
     }
     else {
-        // remove all vars_ in current frame_
-        vars_.resize(frame_);
-        frame_ = vars_.back().value.frame;
-        vars_.pop_back();
+        // remove all locals in current frame_
+        sp_ = frame_ - 1;
+        frame_ = static_cast<size_t>(data_[sp_]);
+    }
+}
+
+void Locals::swap(Locals& other) {
+    data_.swap(other.data_);
+    std::swap(sp_, other.sp_);
+    std::swap(frame_, other.frame_);
+}
+
+// true if the definition being compiled declared locals and needs to leave
+// the frame before EXIT
+bool Locals::has_frame() const {
+    return !names_.empty();
+}
+
+static ucell local_cells(VarType type) {
+    switch (type) {
+    case VarType::Int:
+        return 1;
+    case VarType::DInt:
+        return DCELL_SZ / CELL_SZ;
+    case VarType::Float:
+        return (FCELL_SZ + CELL_SZ - 1) / CELL_SZ;
+    default:
+        assert(0);
+        return 0;
     }
 }
 
@@ -60,93 +90,78 @@ void Locals::add_local(const std::string& name, VarType type) {
         error(Error::DuplicateDefinition, name);
     }
 
-    uint index = static_cast<uint>(names_.size());
+    // only words with locals pay for the frame
+    if (names_.empty()) {
+        comma(xtXENTER_FRAME);
+        num_cells_addr_ = vm->here;
+        comma(0);
+    }
 
     VarName vname;
     vname.type = type;
     vname.name = name;
-    vname.index = index;
+    vname.index = num_cells_;
     names_[to_upper(name)] = vname;
 
+    num_cells_ += local_cells(type);
+    store(num_cells_addr_, num_cells_);
+
+    // initialize from stack
+    compile_store(vname);
+}
+
+void Locals::compile_fetch(const VarName& vname) {
     switch (vname.type) {
     case VarType::Int:
-        comma(xtXW_TO_LOCAL);
+        comma(xtXLOCAL_FETCH);
         break;
     case VarType::DInt:
-        comma(xtXD_TO_LOCAL);
+        comma(xtXTWO_LOCAL_FETCH);
         break;
     case VarType::Float:
-        comma(xtXF_TO_LOCAL);
+        comma(xtXF_LOCAL_FETCH);
         break;
     default:
         assert(0);
     }
+    comma(vname.index);
 }
 
-void Locals::init_int_local() {
-    int value = pop();
-    VarValue vv;
-    vv.type = VarType::Int;
-    vv.value.n = value;
-    vars_.push_back(vv);
-}
-
-void Locals::init_dint_local() {
-    dint value = dpop();
-    VarValue vv;
-    vv.type = VarType::DInt;
-    vv.value.d = value;
-    vars_.push_back(vv);
-}
-
-void Locals::init_float_local() {
-    double value = fpop();
-    VarValue vv;
-    vv.type = VarType::Float;
-    vv.value.f = value;
-    vars_.push_back(vv);
-}
-
-void Locals::get_local(uint index) {
-    size_t i = index + frame_;
-    if (i >= vars_.size()) {
-        error(Error::LocalsStackUnderflow);
-    }
-
-    switch (vars_[i].type) {
+void Locals::compile_store(const VarName& vname) {
+    switch (vname.type) {
     case VarType::Int:
-        push(vars_[i].value.n);
+        comma(xtXLOCAL_STORE);
         break;
     case VarType::DInt:
-        dpush(vars_[i].value.d);
+        comma(xtXTWO_LOCAL_STORE);
         break;
     case VarType::Float:
-        fpush(vars_[i].value.f);
+        comma(xtXF_LOCAL_STORE);
         break;
     default:
         assert(0);
     }
+    comma(vname.index);
 }
 
-void Locals::set_local(uint index) {
-    size_t i = index + frame_;
-    if (i >= vars_.size()) {
-        error(Error::LocalsStackUnderflow);
-    }
+dint Locals::dfetch(ucell index) {
+    dint value;
+    memcpy(&value, &slot(index), sizeof(value));
+    return value;
+}
 
-    switch (vars_[i].type) {
-    case VarType::Int:
-        vars_[i].value.n = pop();
-        break;
-    case VarType::DInt:
-        vars_[i].value.d = dpop();
-        break;
-    case VarType::Float:
-        vars_[i].value.f = fpop();
-        break;
-    default:
-        assert(0);
-    }
+void Locals::dstore(ucell index, dint value) {
+    memcpy(&slot(index), &value, sizeof(value));
+}
+
+double Locals::ffetch(ucell index) {
+    double value;
+    memcpy(&value, &slot(index), sizeof(value));
+    return value;
+}
+
+void Locals::fstore(ucell index, double value) {
+    memcpy(&slot(index), &value, sizeof(value));
 }
 
 bool Locals::find_local(const std::string& name, VarName& vname) const {
@@ -174,12 +189,12 @@ static void check_in_colon() {
 void Locals::parse_declaration() {
     check_in_colon();
 
-    int state = 0;  // collecting locals to be initialized from stack
+    cell state = 0;  // collecting locals to be initialized from stack
     std::vector<VarName> init_locals;
     std::vector<VarName> uninit_locals;
     VarType type = VarType::Int;
     while (true) {
-        uint size;
+        ucell size;
         const char* word = parse_word(size, BL);
 
         if (size == 0) {
@@ -245,7 +260,7 @@ void Locals::parse_declaration() {
             dcomma(0);
             break;
         case VarType::Float:
-            comma(xtFLITERAL);
+            comma(xtXFLITERAL);
             fcomma(0.0);
             break;
         default:
@@ -257,8 +272,8 @@ void Locals::parse_declaration() {
 }
 
 void f_paren_local() {
-    uint size = pop();
-    uint addr = pop();
+    ucell size = pop();
+    ucell addr = pop();
     const char* name = mem_char_ptr(addr, size);
 
     if (size != 0) {
@@ -266,17 +281,17 @@ void f_paren_local() {
     }
 }
 
-void f_paren_local(const char* name, uint size) {
+void f_paren_local(const char* name, ucell size) {
     f_paren_local(std::string(name, name + size));
 }
 
 void f_paren_local(const std::string& name) {
-    vm.locals.add_local(name, VarType::Int);
+    vm->locals.add_local(name, VarType::Int);
 }
 
 void f_locals_bar() {
     while (true) {
-        uint size;
+        ucell size;
         const char* word = parse_word(size, BL);
         if (size == 0 || (size == 1 && word[0] == '|')) {
             break;  // end of locals
@@ -286,14 +301,14 @@ void f_locals_bar() {
 }
 
 void f_locals_bracket() {
-    vm.locals.parse_declaration();
+    vm->locals.parse_declaration();
 }
 
 bool find_local(const std::string& name, VarName& vname) {
-    return vm.locals.find_local(name, vname);
+    return vm->locals.find_local(name, vname);
 }
 
-bool find_local(const char* name, uint size, VarName& vname) {
+bool find_local(const char* name, ucell size, VarName& vname) {
     return find_local(std::string(name, name + size), vname);
 }
 
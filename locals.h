@@ -11,61 +11,63 @@
 #include <unordered_map>
 #include <vector>
 
-enum class VarType { Frame, Int, DInt, Float };
+enum class VarType { Int, DInt, Float };
 
 struct VarName {
     VarType type;
     std::string name;
-    uint index;
-};
-
-struct VarValue {
-    VarType type;
-    union {
-        size_t frame;
-        int n;
-        dint d;
-        double f;
-    } value;
+    ucell index;        // offset of first cell in frame
 };
 
+// each frame is the saved frame pointer followed by the cells of the locals,
+// laid out at compile time
 class Locals {
 public:
     void clear();
 
-    uint size() const;
-    void resize(uint size);
+    ucell size() const;
+    void resize(ucell size);
 
-    uint frame() const;
-    void set_frame(uint frame);
+    ucell frame() const;
+    void set_frame(ucell frame);
 
-    void enter_frame();
+    void enter_frame(ucell num_cells);
     void leave_frame();
+    bool has_frame() const;
 
     void add_local(const std::string& name, VarType type);
 
-    void init_int_local();
-    void init_dint_local();
-    void init_float_local();
+    void compile_fetch(const VarName& vname);
+    void compile_store(const VarName& vname);
 
-    void get_local(uint index);
-    void set_local(uint index);
+    cell& slot(ucell index) {
+        return data_[frame_ + index];
+    }
+    dint dfetch(ucell index);
+    void dstore(ucell index, dint value);
+    double ffetch(ucell index);
+    void fstore(ucell index, double value);
+
+    // exchange the frames with the ones of another task
+    void swap(Locals& other);
 
     bool find_local(const std::string& name, VarName& vname) const;
 
     void parse_declaration();
 
 private:
-    std::vector<VarValue> vars_;
+    std::vector<cell> data_;
+    size_t sp_{ 0 };
     size_t frame_{ 0 };
     std::unordered_map<std::string, VarName> names_;
-
+    ucell num_cells_{ 0 };          // cells used by the locals being compiled
+    ucell num_cells_addr_{ 0 };     // operand of (ENTER_FRAME)
 };
 
 void f_paren_local();
-void f_paren_local(const char* name, uint size);
+void f_paren_local(const char* name, ucell size);
 void f_paren_local(const std::string& name);
 void f_locals_bar();
 void f_locals_bracket();
 bool find_local(const std::string& name, VarName& vname);
-bool find_local(const char* name, uint size, VarName& vname);
+bool find_local(const char* name, ucell size, VarName& vname);
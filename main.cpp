@@ -4,74 +4,95 @@
 // License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
 //-----------------------------------------------------------------------------
 
-#include "environment.h"
-#include "forth.h"
-#include "vm.h"
-#include <iostream>
+#include "libforth.h"
+#include <cstdlib>
 #include <cstring>
+#include <iostream>
+#include <vector>
 
 const char* FORTH_ENV = "FORTH";
 
 static void die_usage() {
-    std::cerr << "Usage: forth [-e forth] [-t] [source [args...]]" << std::endl;
+    std::cerr << "Usage: forth [-e forth] [-t] [--threads n] "
+              "[--serve socket [--workers n]] [source [args...]]" << std::endl;
     exit(EXIT_FAILURE);
 }
 
 int main(int argc, char* argv[]) {
-    // parse env variable
-    const char* envp = getenv(FORTH_ENV);
-    if (envp != nullptr) {
-        vm.input.set_text(envp, static_cast<uint>(strlen(envp)));
-        f_execute(xtINTERPRET);
-    }
+    // parse command line, -e and -t are run in order after FORTH
+    std::vector<const char*> options;
+    const char* socket_path = nullptr;
+    int num_workers = 0;
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+            continue;
+        }
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            num_workers = atoi(argv[++i]);
+            continue;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            forth_set_threads(atoi(argv[++i]));
+            continue;
+        }
 
-    // parse command line
-    g_argc = argc;
-    g_argv = argv;
-    g_interactive = false;
-    bool did_forth = false;
-    g_argc--;
-    g_argv++;
-    while (g_argc > 0 && g_argv[0][0] == '-') {
-        switch (g_argv[0][1]) {
+        switch (argv[i][1]) {
         case 'e':
-            if (g_argc == 1) {
+            if (i + 1 == argc) {
                 die_usage();
             }
-            else {
-                g_argc--;
-                g_argv++;
-                vm.input.set_text(g_argv[0], static_cast<uint>(strlen(g_argv[0])));
-                f_execute(xtINTERPRET);
-                did_forth = true;
-            }
+            options.push_back(argv[i]);
+            options.push_back(argv[++i]);
             break;
         case 't':
-            vm.user->TRACE = F_TRUE;
+            options.push_back(argv[i]);
             break;
         default:
             die_usage();
         }
-        g_argc--;
-        g_argv++;
     }
 
-    // get script, if any
-    if (g_argc == 0) {
-        if (!did_forth) {
-            vm.input.open_terminal();
-            g_interactive = true;
-            f_execute(xtQUIT);
+    // get script, if any, the rest are read by NEXT-ARG
+    const char* source = nullptr;
+    if (i < argc) {
+        source = argv[i++];
+    }
+    forth_set_args(argc - i, argv + i);
+
+    ForthVM* vm = forth_create();
+
+    // parse env variable
+    const char* envp = getenv(FORTH_ENV);
+    if (envp != nullptr) {
+        forth_interpret(vm, envp);
+    }
+
+    bool did_forth = false;
+    for (size_t j = 0; j < options.size(); j++) {
+        if (options[j][1] == 'e') {
+            forth_interpret(vm, options[++j]);
+            did_forth = true;
+        }
+        else {
+            forth_set_trace(vm, 1);
         }
     }
-    else {
-        const char* source = g_argv[0];
-        g_argc--;
-        g_argv++;
 
-        vm.input.open_file(source);
-        f_execute(xtQUIT);
+    if (socket_path != nullptr) {
+        // load the source once, the workers start from a snapshot of it
+        if (source != nullptr && forth_include(vm, source) != 0) {
+            std::cerr << std::endl << forth_error_message(vm) << std::endl;
+            return EXIT_FAILURE;
+        }
+        forth_serve(vm, socket_path, num_workers);
+        return EXIT_FAILURE;
+    }
+    else if (source != nullptr || !did_forth) {
+        forth_run(vm, source);      // does not return
     }
 
+    forth_destroy(vm);
     return EXIT_SUCCESS;
 }
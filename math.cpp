@@ -10,27 +10,28 @@
 #include "stack.h"
 #include "vm.h"
 #include <algorithm>
+#include <charconv>
 #include <cmath>
 #include <cstring>
 #include <iomanip>
 #include <limits>
 #include <sstream>
 
-int f_mod(int a, int b) {
+cell f_mod(cell a, cell b) {
     if (b == 0) {
         error(Error::DivisionByZero);
         return 0; // not reached
     }
     // Handle edge cases where negation does not change the value
-    else if (b == std::numeric_limits<int>::min()) {
+    else if (b == std::numeric_limits<cell>::min()) {
         // Only possible remainders are a or a + b, depending on sign
-        int ret = a % b;
+        cell ret = a % b;
         if (ret < 0) {
             ret += b;
         }
         return ret;
     }
-    else if (a == std::numeric_limits<int>::min() && b == -1) {
+    else if (a == std::numeric_limits<cell>::min() && b == -1) {
         // Avoid overflow
         return 0;
     }
@@ -38,7 +39,7 @@ int f_mod(int a, int b) {
         return -f_mod(-a, -b);
     }
     else {
-        int ret = a % b;
+        cell ret = a % b;
         if (ret < 0) {
             ret += b;
         }
@@ -46,9 +47,9 @@ int f_mod(int a, int b) {
     }
 }
 
-int f_div(int a, int b) {
-    int rem = f_mod(a, b);
-    int quot = (a - rem) / b;
+cell f_div(cell a, cell b) {
+    cell rem = f_mod(a, b);
+    cell quot = (a - rem) / b;
     return quot;
 }
 
@@ -57,8 +58,8 @@ double f_div(double a, double b) {
 }
 
 void f_div_mod() {
-    int b = pop();
-    int a = pop();
+    cell b = pop();
+    cell a = pop();
     push(f_mod(a, b));
     push(f_div(a, b));
 }
@@ -96,8 +97,8 @@ void f_ddiv_mod() {
 void f_fm_div_mod() {
     dint n = (dint)pop();
     dint d = dpop();
-    push(static_cast<int>(f_dmod(d, n)));
-    push(static_cast<int>(f_ddiv(d, n)));
+    push(static_cast<cell>(f_dmod(d, n)));
+    push(static_cast<cell>(f_ddiv(d, n)));
 }
 
 void f_sm_div_rem() {
@@ -107,57 +108,57 @@ void f_sm_div_rem() {
         error(Error::DivisionByZero);
     }
     else {
-        push(static_cast<int>(d % n));
-        push(static_cast<int>(d / n));
+        push(static_cast<cell>(d % n));
+        push(static_cast<cell>(d / n));
     }
 }
 
 void f_um_div_mod() {
-    udint n = static_cast<uint>(pop());
+    udint n = static_cast<ucell>(pop());
     udint d = dpop();
     if (n == 0) {
         error(Error::DivisionByZero);
     }
     else {
-        push(static_cast<int>(d % n));
-        push(static_cast<int>(d / n));
+        push(static_cast<cell>(d % n));
+        push(static_cast<cell>(d / n));
     }
 }
 
-static void mul_div_mod(int a, int b, int c, int& quot, int& rem) {
+static void mul_div_mod(cell a, cell b, cell c, cell& quot, cell& rem) {
     dint prod = (dint)a * (dint)b;
-    quot = static_cast<int>(f_ddiv(prod, c));
-    rem = static_cast<int>(f_dmod(prod, c));
+    quot = static_cast<cell>(f_ddiv(prod, c));
+    rem = static_cast<cell>(f_dmod(prod, c));
 }
 
 void f_mul_div_mod() {
-    int c = pop(), b = pop(), a = pop(), quot, rem;
+    cell c = pop(), b = pop(), a = pop(), quot, rem;
     mul_div_mod(a, b, c, quot, rem);
     push(rem);
     push(quot);
 }
 
 void f_mul_div() {
-    int c = pop(), b = pop(), a = pop(), quot, rem;
+    cell c = pop(), b = pop(), a = pop(), quot, rem;
     mul_div_mod(a, b, c, quot, rem);
     push(quot);
 }
 
-bool within(uint x, uint lo, uint hi) {
+bool within(ucell x, ucell lo, ucell hi) {
     // implement the same logic as Forth's WITHIN word
     return (x - lo) < (hi - lo);
 }
 
 void f_within() {
-    uint hi = pop();
-    uint lo = pop();
-    uint x = pop();
+    ucell hi = pop();
+    ucell lo = pop();
+    ucell x = pop();
     push(f_bool(within(x, lo, hi)));
 }
 
 void f_um_mult() {
-    udint b = static_cast<uint>(pop());
-    udint a = static_cast<uint>(pop());
+    udint b = static_cast<ucell>(pop());
+    udint a = static_cast<ucell>(pop());
     udint result = a * b;
     dpush(result);
 }
@@ -181,18 +182,18 @@ void f_to_d() {
 }
 
 void s_to_f() {
-    int d = pop();
+    cell d = pop();
     double f = static_cast<double>(d);
     fpush(f);
 }
 
 void f_to_s() {
     double f = fpop();
-    int d = static_cast<int>(std::trunc(f));
+    cell d = static_cast<cell>(std::trunc(f));
     push(d);
 }
 
-RepresentResult f_represent(double x, int significant_digits) {
+RepresentResult f_represent(double x, cell significant_digits) {
     RepresentResult result;
 
     // Handle sign
@@ -200,11 +201,24 @@ RepresentResult f_represent(double x, int significant_digits) {
     double abs_x = std::fabs(x);
 
     // Use scientific notation to extract exponent and digits
-    std::ostringstream oss;
-    oss << std::scientific
-        << std::setprecision(significant_digits - 1)
-        << abs_x;
-    std::string sci = oss.str();  // e.g., "1.234567890123456e+03"
+    std::string sci;  // e.g., "1.234567890123456e+03"
+    char buffer[BUFFER_SZ];
+    std::to_chars_result res{ buffer, std::errc::invalid_argument };
+    if (significant_digits >= 1) {
+        res = std::to_chars(buffer, buffer + sizeof(buffer), abs_x,
+                            std::chars_format::scientific,
+                            static_cast<int>(significant_digits - 1));
+    }
+    if (res.ec == std::errc()) {
+        sci.assign(buffer, res.ptr);
+    }
+    else {
+        std::ostringstream oss;
+        oss << std::scientific
+            << std::setprecision(significant_digits - 1)
+            << abs_x;
+        sci = oss.str();
+    }
 
     // Parse digits and exponent
     size_t e_pos = sci.find('e');
@@ -223,8 +237,8 @@ RepresentResult f_represent(double x, int significant_digits) {
 }
 
 void f_represent() {
-    uint size = pop();
-    uint addr = pop();
+    ucell size = pop();
+    ucell addr = pop();
     char* buffer = mem_char_ptr(addr, size);
 
     double f = fpop();
@@ -233,7 +247,7 @@ void f_represent() {
 
     memset(buffer, BL, size);
     memcpy(buffer, res.digits.c_str(),
-           std::min(size, static_cast<uint>(res.digits.size())));
+           std::min(size, static_cast<ucell>(res.digits.size())));
 
     push(res.exponent);
     push(res.is_negative ? F_TRUE : F_FALSE);
@@ -8,8 +8,8 @@
 
 #include "forth.h"
 
-int f_mod(int a, int b);
-int f_div(int a, int b);
+cell f_mod(cell a, cell b);
+cell f_div(cell a, cell b);
 double f_div(double a, double b);
 void f_div_mod();
 dint f_dmod(dint a, dint b);
@@ -20,7 +20,7 @@ void f_sm_div_rem();
 void f_um_div_mod();
 void f_mul_div_mod();
 void f_mul_div();
-bool within(uint x, uint a, uint b);
+bool within(ucell x, ucell a, ucell b);
 void f_within();
 void f_um_mult();
 void f_m_plus();
@@ -31,11 +31,11 @@ void f_to_s();
 
 struct RepresentResult {
     std::string digits;
-    int exponent;
+    cell exponent;
     bool is_negative;
 };
 
-RepresentResult f_represent(double x, int significant_digits);
+RepresentResult f_represent(double x, cell significant_digits);
 void f_represent();
 
 bool f_f_tilde();
@@ -5,11 +5,11 @@
 //-----------------------------------------------------------------------------
 
 /*
- * Portable ANS-style M* and M* / for 32-bit cells (FIXED)
- * - No __int128, no compiler intrinsics
- * - M*    : ( n1 n2 -- d )       32x32 -> signed 64
- * - M* /  : ( d n1 +n2 -- d )    (signed 64 * signed 32) / unsigned 32
- *           with a true 96-bit intermediate and **floored division**
+ * Portable ANS-style M* and M* / for 32-bit or 64-bit cells (FIXED)
+ * - No compiler intrinsics, uses the double cell type for two-word products
+ * - M*    : ( n1 n2 -- d )       cell x cell -> signed double
+ * - M* /  : ( d n1 +n2 -- d )    (signed double * signed cell) / unsigned cell
+ *           with a true triple cell intermediate and **floored division**
  *
  * Compile test:
  *   cc -std=c99 -O2 mstar32_fixed.c -DTEST_MSTAR32 && ./a.out
@@ -21,14 +21,12 @@
 #include <cassert>
 
 /* ------- Forth cell / double ------- */
-typedef int32_t  cell;    /* one Forth cell (signed, 32-bit) */
-typedef uint32_t ucell;
 
 typedef struct {
     cell lo, hi;
 } dcell;   /* Forth double: lo first, then hi */
 
-/* ------- Unsigned helpers: 64-bit (2 words) & 96-bit (3 words) ------- */
+/* ------- Unsigned helpers: double (2 words) & triple (3 words) ------- */
 typedef struct {
     ucell lo, hi;
 } u64;    /* magnitude of a signed double */
@@ -36,18 +34,18 @@ typedef struct {
     ucell lo, mid, hi;
 } u96;
 
-/* Add with carry (32-bit words) */
+/* Add with carry (cell words) */
 static inline ucell addc32(ucell a, ucell b, ucell* carry) {
-    uint64_t s = (uint64_t)a + b + *carry;
-    *carry = (ucell)(s >> 32);
+    udint s = (udint)a + b + *carry;
+    *carry = (ucell)(s >> CELL_BITS);
     return (ucell)s;
 }
 
-/* Sub with borrow (32-bit words) -- kept for completeness (not used in fixes) */
+/* Sub with borrow (cell words) -- kept for completeness (not used in fixes) */
 #if 0
 static inline ucell subb32(ucell a, ucell b, ucell* borrow) {
-    uint64_t d = (uint64_t)a - b - *borrow;
-    *borrow = (ucell)((d >> 63) & 1u); /* 1 if underflow */
+    udint d = (udint)a - b - *borrow;
+    *borrow = (ucell)((d >> (2 * CELL_BITS - 1)) & 1u); /* 1 if underflow */
     return (ucell)d;
 }
 #endif
@@ -57,7 +55,7 @@ static inline ucell subb32(ucell a, ucell b, ucell* borrow) {
 static u64 dcell_abs_u64(dcell d) {
     u64 u = { (ucell)d.lo, (ucell)d.hi };
     if (d.hi < 0) {
-        /* two's complement negate (64-bit in two 32-bit words) */
+        /* two's complement negate (double in two cell words) */
         ucell carry = 1;
         u.lo = ~u.lo;
         u.lo = addc32(u.lo, 0u, &carry); /* +1, carry updated */
@@ -83,48 +81,48 @@ static dcell u64_to_signed_dcell(u64 u, int negative) {
     return r;
 }
 
-/* 64x32 -> 96 unsigned multiply: (A.hi:A.lo) * b */
+/* double x cell -> triple unsigned multiply: (A.hi:A.lo) * b */
 static u96 u64_mul_u32(u64 A, ucell b) {
     u96 acc;
-    uint64_t p0 = (uint64_t)A.lo * b; /* up to 64 bits */
-    uint64_t p1 = (uint64_t)A.hi * b; /* up to 64 bits */
+    udint p0 = (udint)A.lo * b; /* up to two words */
+    udint p1 = (udint)A.hi * b; /* up to two words */
 
-    acc.lo = (ucell)(p0 & 0xFFFFFFFFu);
-    uint64_t carry = (p0 >> 32);
+    acc.lo = (ucell)p0;
+    udint carry = (p0 >> CELL_BITS);
 
-    uint64_t mid = (p1 & 0xFFFFFFFFu) + carry;
-    acc.mid = (ucell)(mid & 0xFFFFFFFFu);
-    acc.hi  = (ucell)((p1 >> 32) + (mid >> 32));
-    return acc; /* full 96-bit product */
+    udint mid = (udint)(ucell)p1 + carry;
+    acc.mid = (ucell)mid;
+    acc.hi  = (ucell)((p1 >> CELL_BITS) + (mid >> CELL_BITS));
+    return acc; /* full triple cell product */
 }
 
 /*
- * Fast word-wise long division in base 2^32:
- *   (N.hi:N.mid:N.lo) / d  where d is 32-bit unsigned and N is 96-bit unsigned
- * Returns quotient Q (96-bit) and remainder R (32-bit).
+ * Fast word-wise long division in base 2^CELL_BITS:
+ *   (N.hi:N.mid:N.lo) / d  where d is a cell and N is a triple cell
+ * Returns quotient Q (triple cell) and remainder R (cell).
  *
  * This is the classic "divide by single-limb" algorithm:
  *   q2 = N.hi  / d; r  = N.hi  % d;
- *   q1 = (r<<32 | N.mid) / d; r = ...
- *   q0 = (r<<32 | N.lo)  / d; r = ...
+ *   q1 = (r<<CELL_BITS | N.mid) / d; r = ...
+ *   q0 = (r<<CELL_BITS | N.lo)  / d; r = ...
  */
 static void u96_div_u32(u96 N, ucell d, u96* Q, ucell* R) {
     assert(d != 0);
-    uint64_t r, q;
+    udint r, q;
 
     /* step 1: high word */
-    q = ((uint64_t)N.hi) / d;
-    r = ((uint64_t)N.hi) % d;
+    q = ((udint)N.hi) / d;
+    r = ((udint)N.hi) % d;
     Q->hi = (ucell)q;
 
     /* step 2: middle word */
-    uint64_t m = (r << 32) | N.mid;
+    udint m = (r << CELL_BITS) | N.mid;
     q = m / d;
     r = m % d;
     Q->mid = (ucell)q;
 
     /* step 3: low word */
-    uint64_t l = (r << 32) | N.lo;
+    udint l = (r << CELL_BITS) | N.lo;
     q = l / d;
     r = l % d;
     Q->lo = (ucell)q;
@@ -132,28 +130,27 @@ static void u96_div_u32(u96 N, ucell d, u96* Q, ucell* R) {
     *R = (ucell)r;
 }
 
-/* --------- Public API: M* (32x32 -> 64 signed) --------- */
+/* --------- Public API: M* (cell x cell -> signed double) --------- */
 static dcell MSTAR(cell n1, cell n2) {
-    int64_t p = (int64_t)n1 * (int64_t)
-                n2; /* standard C guarantees at least 64-bit here */
+    dint p = (dint)n1 * (dint)n2;   /* double cell holds the full product */
     dcell r;
-    r.lo = (cell)(p & 0xFFFFFFFFll);
-    r.hi = (cell)((uint64_t)p >> 32);
+    r.lo = (cell)(ucell)p;
+    r.hi = (cell)((udint)p >> CELL_BITS);
     return r;
 }
 
 /*
  * --------- Public API: M* /  (d n1 + n2 -- d)
  * Inputs:
- *   d   : signed 64-bit (two 32-bit cells in Forth order lo,hi)
- *   n1  : signed 32-bit
- *   n2  : positive 32-bit (ANS says +n2)
+ *   d   : signed double (two cells in Forth order lo,hi)
+ *   n1  : signed cell
+ *   n2  : positive cell (ANS says +n2)
  * Semantics:
- *   Compute floor( (d * n1) / n2 ) in signed 64-bit, using a 96-bit intermediate.
+ *   Compute floor( (d * n1) / n2 ) in signed double, using a triple intermediate.
  * Implementation:
- *   1) Take magnitudes: |d| (u64), |n1| (u32), D = (uint32_t)n2
+ *   1) Take magnitudes: |d| (u64), |n1| (ucell), D = (ucell)n2
  *   2) N = |d| * |n1|  (u96)
- *   3) Q = N / D, R = N % D   (word-wise 96/32 division)
+ *   3) Q = N / D, R = N % D   (word-wise triple/cell division)
  *   4) If result sign negative and R != 0, increment |Q| by 1 (floored adjustment)
  *   5) Apply sign to |Q| and return as dcell
  */
@@ -166,18 +163,18 @@ static dcell MSTAR_SLASH(dcell d, cell n1, cell n2) {
 
     /* Magnitudes */
     u64   A = dcell_abs_u64(d);
-    ucell B = (neg_n1 ? (ucell)(-(int64_t)n1) : (ucell)n1);
+    ucell B = (neg_n1 ? (ucell)(-(dint)n1) : (ucell)n1);
     ucell D = (ucell)n2;
 
-    /* 1) 64x32 -> 96 product */
+    /* 1) double x cell -> triple product */
     u96 N = u64_mul_u32(A, B);
 
-    /* 2) 96/32 -> quotient Q (96), remainder R (32) */
+    /* 2) triple / cell -> quotient Q (triple), remainder R (cell) */
     u96 Q;
     ucell R;
     u96_div_u32(N, D, &Q, &R);
 
-    /* 3) Take low 64 bits of Q as magnitude result (Q.mid:Q.lo) */
+    /* 3) Take low double of Q as magnitude result (Q.mid:Q.lo) */
     u64 mag = { Q.lo, Q.mid };
 
     /* 4) Floored adjustment: if negative result and remainder non-zero, |Q|++ */
@@ -192,16 +189,16 @@ static dcell MSTAR_SLASH(dcell d, cell n1, cell n2) {
 }
 
 void f_m_star() {
-    int n2 = pop();
-    int n1 = pop();
+    cell n2 = pop();
+    cell n1 = pop();
     dcell result = MSTAR(n1, n2);
     dint result1 = mk_dcell(result.hi, result.lo);
     dpush(result1);
 }
 
 void f_m_star_slash() {
-    int n2 = pop();
-    int n1 = pop();
+    cell n2 = pop();
+    cell n1 = pop();
     dint d = dpop();
 
     if (n2 == 0) {
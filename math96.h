@@ -4,7 +4,7 @@
 // License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
 //-----------------------------------------------------------------------------
 
-// Portable ANS-style M* and M*/ for 32-bit cells
+// Portable ANS-style M* and M*/ for 32-bit or 64-bit cells
 
 #pragma once
 
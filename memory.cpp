@@ -8,40 +8,54 @@
 #include "forth.h"
 #include "memory.h"
 #include "vm.h"
+#include <algorithm>
 #include <cstring>
 
 Mem::Mem() {
-    memset(data_, 0, sizeof(data_));
+    data_ = new char[MEM_SZ];
+    memset(data_, 0, MEM_SZ);
     bottom_ = 0;
-    top_ = static_cast<int>(sizeof(data_));
+    top_ = MEM_SZ;
+    heap_mutex_ = std::make_shared<std::mutex>();
 }
 
-uint Mem::addr(const char* ptr) const {
-    uint addr = check_addr(static_cast<uint>(ptr - data_));
+Mem::Mem(Mem& shared)
+    : data_(shared.data_), top_(shared.top_), bottom_(shared.bottom_),
+      owner_(false), heap_mutex_(shared.heap_mutex_) {
+}
+
+Mem::~Mem() {
+    if (owner_) {
+        delete[] data_;
+    }
+}
+
+ucell Mem::addr(const char* ptr) const {
+    ucell addr = check_addr(static_cast<ucell>(ptr - data_));
     return addr;
 }
 
-uint Mem::addr(const int* ptr) const {
-    uint addr = check_addr(static_cast<uint>(reinterpret_cast<const char*>
+ucell Mem::addr(const cell* ptr) const {
+    ucell addr = check_addr(static_cast<ucell>(reinterpret_cast<const char*>
                            (ptr) - data_));
     return addr;
 }
 
-char* Mem::char_ptr(uint addr, uint size) {
+char* Mem::char_ptr(ucell addr, ucell size) {
     addr = check_addr(addr, size);
     return data_ + addr;
 }
 
-int* Mem::int_ptr(uint addr, uint size) {
+cell* Mem::int_ptr(ucell addr, ucell size) {
     if ((addr % CELL_SZ) != 0) {
         error(Error::AddressAlignmentException);
         return nullptr;
     }
     addr = check_addr(addr, size);
-    return reinterpret_cast<int*>(data_ + addr);
+    return reinterpret_cast<cell*>(data_ + addr);
 }
 
-double* Mem::float_ptr(uint addr, uint size) {
+double* Mem::float_ptr(ucell addr, ucell size) {
     if ((addr % CELL_SZ) != 0) {
         error(Error::AddressAlignmentException);
         return nullptr;
@@ -50,7 +64,7 @@ double* Mem::float_ptr(uint addr, uint size) {
     return reinterpret_cast<double*>(data_ + addr);
 }
 
-float* Mem::sfloat_ptr(uint addr, uint size) {
+float* Mem::sfloat_ptr(ucell addr, ucell size) {
     if ((addr % CELL_SZ) != 0) {
         error(Error::AddressAlignmentException);
         return nullptr;
@@ -59,62 +73,62 @@ float* Mem::sfloat_ptr(uint addr, uint size) {
     return reinterpret_cast<float*>(data_ + addr);
 }
 
-int Mem::fetch(uint addr) {
+cell Mem::fetch(ucell addr) {
     return *int_ptr(addr, CELL_SZ);
 }
 
-void Mem::store(uint addr, int value) {
+void Mem::store(ucell addr, cell value) {
     *int_ptr(addr, CELL_SZ) = value;
 }
 
-dint Mem::dfetch(uint addr) {
-    int hi = fetch(addr);
-    int lo = fetch(addr + CELL_SZ);
+dint Mem::dfetch(ucell addr) {
+    cell hi = fetch(addr);
+    cell lo = fetch(addr + CELL_SZ);
     return mk_dcell(hi, lo);
 }
 
-void Mem::dstore(uint addr, dint value) {
+void Mem::dstore(ucell addr, dint value) {
     store(addr, dcell_hi(value));
     store(addr + CELL_SZ, dcell_lo(value));
 }
 
-void Mem::fstore(uint addr, double value) {
+void Mem::fstore(ucell addr, double value) {
     *float_ptr(addr) = value;
 }
 
-double Mem::ffetch(uint addr) {
+double Mem::ffetch(ucell addr) {
     return *float_ptr(addr);
 }
 
-void Mem::sfstore(uint addr, float value) {
+void Mem::sfstore(ucell addr, float value) {
     *sfloat_ptr(addr) = value;
 }
 
-float Mem::sffetch(uint addr) {
+float Mem::sffetch(ucell addr) {
     return *sfloat_ptr(addr);
 }
 
-int Mem::cfetch(uint addr) {
+cell Mem::cfetch(ucell addr) {
     return static_cast<uchar>(data_[check_addr(addr, CHAR_SZ)]);
 }
 
-void Mem::cstore(uint addr, int value) {
+void Mem::cstore(ucell addr, cell value) {
     data_[check_addr(addr, CHAR_SZ)] = value;
 }
 
-void Mem::fill(uint addr, uint size, char c) {
+void Mem::fill(ucell addr, ucell size, char c) {
     memset(char_ptr(addr), c, size);
 }
 
-void Mem::erase(uint addr, uint size) {
+void Mem::erase(ucell addr, ucell size) {
     fill(addr, size, 0);
 }
 
-void Mem::move(int src, int dst, uint size) {
+void Mem::move(cell src, cell dst, ucell size) {
     memmove(char_ptr(dst), char_ptr(src), size);
 }
 
-char* Mem::alloc_bottom(uint size) {
+char* Mem::alloc_bottom(ucell size) {
     size = aligned(size);
     if (bottom_ + size >= top_) {
         error(Error::DictionaryOverflow);
@@ -124,7 +138,7 @@ char* Mem::alloc_bottom(uint size) {
     return ret;
 }
 
-char* Mem::alloc_top(uint size) {
+char* Mem::alloc_top(ucell size) {
     size = aligned(size);
     if (bottom_ + size >= top_) {
         error(Error::DictionaryOverflow);
@@ -133,8 +147,14 @@ char* Mem::alloc_top(uint size) {
     return char_ptr(top_);
 }
 
-int Mem::check_addr(uint addr, uint size) const {
-    if (addr + size > static_cast<int>(sizeof(data_))) {
+std::atomic<cell>* Mem::atomic_ptr(ucell addr) {
+    static_assert(sizeof(std::atomic<cell>) == sizeof(cell),
+                  "atomic cells should have the size of a cell");
+    return reinterpret_cast<std::atomic<cell>*>(int_ptr(addr, CELL_SZ));
+}
+
+cell Mem::check_addr(ucell addr, ucell size) const {
+    if (addr > MEM_SZ || size > MEM_SZ - addr) {
         error(Error::InvalidMemoryAddress);
         return 0;
     }
@@ -146,26 +166,26 @@ int Mem::check_addr(uint addr, uint size) const {
 //-----------------------------------------------------------------------------
 
 void f_fill() {
-    int c = pop();
-    int n = pop();
-    uint addr = pop();
+    cell c = pop();
+    cell n = pop();
+    ucell addr = pop();
     if (n > 0) {
         memset(mem_char_ptr(addr, n), c, n);
     }
 }
 
 void f_erase() {
-    int n = pop();
-    uint addr = pop();
+    cell n = pop();
+    ucell addr = pop();
     if (n > 0) {
         memset(mem_char_ptr(addr, n), 0, n);
     }
 }
 
 void f_move() {
-    int n = pop();
-    int dst = pop();
-    int src = pop();
+    cell n = pop();
+    cell dst = pop();
+    cell src = pop();
     if (n > 0) {
         memmove(mem_char_ptr(dst, n), mem_char_ptr(src, n), n);
     }
@@ -175,19 +195,58 @@ void f_move() {
 
 // initialize the heap with a single large free block
 void Heap::init() {
-    size_ = vm.heap_hi_mem - vm.heap_lo_mem;
-    pool_ = vm.heap_lo_mem;
-    Block* free_block = reinterpret_cast<Block*>(mem_char_ptr(pool_));
+    size_ = vm->heap_hi_mem - vm->heap_lo_mem;
+    pool_ = vm->heap_lo_mem;
+    Block* free_block = block(pool_);
     free_block->size = size_ - sizeof(Block);
     free_block->free = true;
     free_block->next = 0;
+    for (auto& blocks : cache_) {
+        blocks.clear();
+    }
 }
 
-// allocate memory using first fit strategy
-uint Heap::allocate(uint size) {
+void Heap::share(const Heap& other) {
+    pool_ = other.pool_;
+    size_ = other.size_;
+    for (auto& blocks : cache_) {
+        blocks.clear();
+    }
+}
+
+Heap::Block* Heap::block(ucell addr) {
+    return reinterpret_cast<Block*>(mem_char_ptr(addr));
+}
+
+ucell Heap::allocate(ucell size) {
     size = aligned(size);
 
-    Block* curr = reinterpret_cast<Block*>(mem_char_ptr(pool_));
+    // reuse a block of the same size freed by this thread
+    if (size <= MAX_CACHED_SZ) {
+        std::vector<ucell>& blocks = cache_[size / CELL_SZ];
+        if (!blocks.empty()) {
+            ucell ptr = blocks.back();
+            blocks.pop_back();
+            return ptr;
+        }
+    }
+
+    ucell ptr;
+    {
+        std::lock_guard<std::mutex> lock(vm->mem.heap_mutex());
+        ptr = allocate_block(size);
+    }
+    if (ptr == 0) {
+        flush();        // the cached blocks may coalesce in a large enough one
+        std::lock_guard<std::mutex> lock(vm->mem.heap_mutex());
+        ptr = allocate_block(size);
+    }
+    return ptr;
+}
+
+// allocate memory using first fit strategy
+ucell Heap::allocate_block(ucell size) {
+    Block* curr = block(pool_);
     while (curr) {
         if (curr->free && curr->size >= size) {
             // Split block if there's enough space
@@ -205,28 +264,46 @@ uint Heap::allocate(uint size) {
             curr->free = false;
             return mem_addr(reinterpret_cast<char*>(curr)) + sizeof(Block);
         }
-        Block* next_block =
-            curr->next ? reinterpret_cast<Block*>(mem_char_ptr(curr->next)) :
-            nullptr;
-        curr = next_block;
+        curr = curr->next ? block(curr->next) : nullptr;
     }
     return 0; // no suitable block found
 }
 
-void Heap::free(uint ptr) {
+void Heap::free(ucell ptr) {
     if (ptr == 0) {
         return;
     }
 
-    char* block_addr = mem_char_ptr(ptr) - sizeof(Block);
-    Block* block = reinterpret_cast<Block*>(block_addr);
-    block->free = true;
+    Block* freed = block(ptr - sizeof(Block));
+    if (freed->size <= MAX_CACHED_SZ) {
+        std::vector<ucell>& blocks = cache_[freed->size / CELL_SZ];
+        if (blocks.size() < MAX_CACHED_BLOCKS) {
+            blocks.push_back(ptr);
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(vm->mem.heap_mutex());
+    freed->free = true;
+    coalesce();
+}
 
-    // Coalesce adjacent free blocks
-    Block* curr = reinterpret_cast<Block*>(mem_char_ptr(pool_));
+void Heap::flush() {
+    std::lock_guard<std::mutex> lock(vm->mem.heap_mutex());
+    for (auto& blocks : cache_) {
+        for (ucell ptr : blocks) {
+            block(ptr - sizeof(Block))->free = true;
+        }
+        blocks.clear();
+    }
+    coalesce();
+}
+
+// merge adjacent free blocks
+void Heap::coalesce() {
+    Block* curr = block(pool_);
     while (curr != nullptr && curr->next != 0) {
-        Block* next_block =
-            reinterpret_cast<Block*>(mem_char_ptr(curr->next));
+        Block* next_block = block(curr->next);
         if (curr->free && next_block && next_block->free) {
             curr->size += sizeof(Block) + next_block->size;
             curr->next = next_block->next;
@@ -237,22 +314,21 @@ void Heap::free(uint ptr) {
     }
 }
 
-uint Heap::resize(uint ptr, uint new_size) {
+ucell Heap::resize(ucell ptr, ucell new_size) {
     new_size = aligned(new_size);
     if (ptr == 0) {
         return allocate(new_size);
     }
 
-    char* block_addr = mem_char_ptr(ptr) - sizeof(Block);
-    Block* block = reinterpret_cast<Block*>(block_addr);
-    if (block->size >= new_size) {
+    Block* old_block = block(ptr - sizeof(Block));
+    if (old_block->size >= new_size) {
         return ptr; // Current block is sufficient
     }
 
     // allocate a new block and copy data
-    uint new_ptr = allocate(new_size);
+    ucell new_ptr = allocate(new_size);
     if (new_ptr) {
-        memcpy(mem_char_ptr(new_ptr), mem_char_ptr(ptr), block->size);
+        memcpy(mem_char_ptr(new_ptr), mem_char_ptr(ptr), old_block->size);
         free(ptr);
     }
 
@@ -262,40 +338,247 @@ uint Heap::resize(uint ptr, uint new_size) {
 //-----------------------------------------------------------------------------
 
 void f_allocate() {
-    uint size = pop();
-    uint ptr = vm.heap.allocate(size);
+    ucell size = pop();
+    ucell ptr = vm->heap.allocate(size);
     if (ptr) {
         push(ptr);
         push(0); // no error
     }
     else {
         push(0); // invalid address
-        push(static_cast<int>(Error::AllocateException));
+        push(static_cast<cell>(Error::AllocateException));
     }
 }
 
 void f_free() {
-    uint ptr = pop();
+    ucell ptr = pop();
     if (ptr != 0) {
-        vm.heap.free(ptr);
+        vm->heap.free(ptr);
         push(0); // no error
     }
     else {
-        push(static_cast<int>(Error::FreeException));
+        push(static_cast<cell>(Error::FreeException));
     }
 }
 
 void f_resize() {
-    uint new_size = pop();
-    uint ptr = pop();
-    uint new_ptr = vm.heap.resize(ptr, new_size);
+    ucell new_size = pop();
+    ucell ptr = pop();
+    ucell new_ptr = vm->heap.resize(ptr, new_size);
     if (new_ptr) {
         push(new_ptr);
         push(0); // no error
     }
     else {
         push(ptr); // did not resize
-        push(static_cast<int>(Error::ResizeException));
+        push(static_cast<cell>(Error::ResizeException));
+    }
+}
+
+
+// size and bytes used of the arena, followed by the data
+static const ucell ARENA_HEADER_SZ = 2 * CELL_SZ;
+
+void f_arena() {
+    ucell size = pop();
+    if (size > MEM_SZ) {
+        error(Error::AllocateException);
+    }
+    size = aligned(size);
+    ucell arena = vm->heap.allocate(ARENA_HEADER_SZ + size);
+    if (arena == 0) {
+        error(Error::AllocateException);
+    }
+    store(arena, size);
+    store(arena + CELL_SZ, 0);
+    push(arena);
+}
+
+// the bytes used are bumped atomically, so that the threads of
+// PARALLEL-FOR can allot from the same arena
+void f_arena_allot() {
+    ucell size = pop();
+    ucell arena = pop();
+    ucell arena_size = fetch(arena);
+    std::atomic<cell>* used = vm->mem.atomic_ptr(arena + CELL_SZ);
+    cell offset = used->load();
+    do {
+        if (size > arena_size - offset) {
+            error(Error::AllocateException);
+        }
+    }
+    while (!used->compare_exchange_weak(offset, offset + aligned(size)));
+    push(arena + ARENA_HEADER_SZ + offset);
+}
+
+void f_arena_mark() {
+    ucell arena = pop();
+    push(arena + ARENA_HEADER_SZ + fetch(arena + CELL_SZ));
+}
+
+void f_arena_release() {
+    ucell mark = pop();
+    ucell arena = pop();
+    ucell used = fetch(arena + CELL_SZ);
+    if (mark < arena + ARENA_HEADER_SZ ||
+            mark > arena + ARENA_HEADER_SZ + used) {
+        error(Error::InvalidNumericArgument, std::to_string(mark));
+    }
+    store(arena + CELL_SZ, mark - arena - ARENA_HEADER_SZ);
+}
+
+void f_arena_reset() {
+    ucell arena = pop();
+    store(arena + CELL_SZ, 0);
+}
+
+// cells of the pool: item size, items per chunk, first free item and first
+// chunk; each chunk starts with the link to the next one, followed by the
+// items, and each free item starts with the link to the next free one
+enum {
+    POOL_ITEM_SIZE, POOL_COUNT, POOL_FREE_LIST, POOL_CHUNKS, POOL_HEADER_CELLS
+};
+
+static ucell pool_field(ucell pool, int field) {
+    return pool + field * CELL_SZ;
+}
+
+// fill the free items with garbage in debug builds, to catch their use
+// after POOL-FREE
+static void pool_poison(ucell item, ucell item_size) {
+#ifndef NDEBUG
+    memset(mem_char_ptr(item, item_size), 0xDD, item_size);
+#else
+    (void)item;
+    (void)item_size;
+#endif
+}
+
+// allocate a chunk and add its items to the free list
+static void pool_grow(ucell pool) {
+    ucell item_size = fetch(pool_field(pool, POOL_ITEM_SIZE));
+    ucell count = fetch(pool_field(pool, POOL_COUNT));
+    ucell chunk = vm->heap.allocate(CELL_SZ + item_size * count);
+    if (chunk == 0) {
+        error(Error::AllocateException);
+    }
+
+    ucell first = chunk + CELL_SZ;
+    ucell last = first + (count - 1) * item_size;
+    for (ucell item = first; item <= last; item += item_size) {
+        pool_poison(item, item_size);
+        store(item, item + item_size);
     }
+
+    std::lock_guard<std::mutex> lock(vm->mem.heap_mutex());
+    store(chunk, fetch(pool_field(pool, POOL_CHUNKS)));
+    store(pool_field(pool, POOL_CHUNKS), chunk);
+    store(last, fetch(pool_field(pool, POOL_FREE_LIST)));
+    store(pool_field(pool, POOL_FREE_LIST), first);
 }
 
+void f_pool() {
+    cell count = pop();
+    cell item_size = pop();
+    if (item_size <= 0) {
+        error(Error::InvalidNumericArgument, std::to_string(item_size));
+    }
+    if (count <= 0) {
+        error(Error::InvalidNumericArgument, std::to_string(count));
+    }
+    item_size = std::max(aligned(item_size), static_cast<cell>(CELL_SZ));
+    if (static_cast<ucell>(item_size) > MEM_SZ ||
+            static_cast<ucell>(count) > MEM_SZ / item_size) {
+        error(Error::AllocateException);
+    }
+
+    ucell pool = vm->heap.allocate(POOL_HEADER_CELLS * CELL_SZ);
+    if (pool == 0) {
+        error(Error::AllocateException);
+    }
+    store(pool_field(pool, POOL_ITEM_SIZE), item_size);
+    store(pool_field(pool, POOL_COUNT), count);
+    store(pool_field(pool, POOL_FREE_LIST), 0);
+    store(pool_field(pool, POOL_CHUNKS), 0);
+    try {
+        pool_grow(pool);
+    }
+    catch (...) {
+        vm->heap.free(pool);
+        throw;
+    }
+    push(pool);
+}
+
+// the free list is shared by the threads of PARALLEL-FOR, and guarded by
+// the heap lock
+void f_pool_alloc() {
+    ucell pool = pop();
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(vm->mem.heap_mutex());
+            ucell item = fetch(pool_field(pool, POOL_FREE_LIST));
+            if (item != 0) {
+                store(pool_field(pool, POOL_FREE_LIST), fetch(item));
+                push(item);
+                return;
+            }
+        }
+        pool_grow(pool);
+    }
+}
+
+void f_pool_free() {
+    ucell pool = pop();
+    ucell item = pop();
+    if (item == 0) {
+        error(Error::FreeException);
+    }
+    pool_poison(item, fetch(pool_field(pool, POOL_ITEM_SIZE)));
+
+    std::lock_guard<std::mutex> lock(vm->mem.heap_mutex());
+    store(item, fetch(pool_field(pool, POOL_FREE_LIST)));
+    store(pool_field(pool, POOL_FREE_LIST), item);
+}
+
+void f_pool_destroy() {
+    ucell pool = pop();
+    ucell chunk = fetch(pool_field(pool, POOL_CHUNKS));
+    while (chunk != 0) {
+        ucell next = fetch(chunk);
+        vm->heap.free(chunk);
+        chunk = next;
+    }
+    vm->heap.free(pool);
+}
+
+// atomic access to cells shared by the threads of PARALLEL-FOR
+void f_atomic_fetch() {
+    ucell addr = pop();
+    push(vm->mem.atomic_ptr(addr)->load());
+}
+
+void f_atomic_store() {
+    ucell addr = pop();
+    cell value = pop();
+    vm->mem.atomic_ptr(addr)->store(value);
+}
+
+void f_atomic_plus_store() {
+    ucell addr = pop();
+    cell value = pop();
+    vm->mem.atomic_ptr(addr)->fetch_add(value);
+}
+
+void f_cas() {
+    ucell addr = pop();
+    cell new_value = pop();
+    cell old_value = pop();
+    bool ok = vm->mem.atomic_ptr(addr)->compare_exchange_strong(old_value,
+              new_value);
+    push(f_bool(ok));
+}
+
+void f_fence() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
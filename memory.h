@@ -6,69 +6,127 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 class Mem {
 public:
     Mem();
+    explicit Mem(Mem& shared);      // use the memory of shared
+    virtual ~Mem();
+    Mem(const Mem&) = delete;
+    Mem& operator=(const Mem&) = delete;
 
     // pointer - address conversion
-    uint addr(const char* ptr) const;
-    uint addr(const int* ptr) const;
-    char* char_ptr(uint addr, uint size = 0);
-    int* int_ptr(uint addr, uint size = 0);
-    double* float_ptr(uint addr, uint size = 0);
-    float* sfloat_ptr(uint addr, uint size = 0);
+    ucell addr(const char* ptr) const;
+    ucell addr(const cell* ptr) const;
+    char* char_ptr(ucell addr, ucell size = 0);
+    cell* int_ptr(ucell addr, ucell size = 0);
+    double* float_ptr(ucell addr, ucell size = 0);
+    float* sfloat_ptr(ucell addr, ucell size = 0);
 
     // access memory
-    int fetch(uint addr);
-    void store(uint addr, int value);
-    dint dfetch(uint addr);
-    void dstore(uint addr, dint value);
-    void fstore(uint addr, double value);
-    double ffetch(uint addr);
-    void sfstore(uint addr, float value);
-    float sffetch(uint addr);
-    int cfetch(uint addr);
-    void cstore(uint addr, int value);
+    cell fetch(ucell addr);
+    void store(ucell addr, cell value);
+    dint dfetch(ucell addr);
+    void dstore(ucell addr, dint value);
+    void fstore(ucell addr, double value);
+    double ffetch(ucell addr);
+    void sfstore(ucell addr, float value);
+    float sffetch(ucell addr);
+    cell cfetch(ucell addr);
+    void cstore(ucell addr, cell value);
 
     // block operations
-    void fill(uint addr, uint size, char c);
-    void erase(uint addr, uint size);
-    void move(int src, int dst, uint size);
+    void fill(ucell addr, ucell size, char c);
+    void erase(ucell addr, ucell size);
+    void move(cell src, cell dst, ucell size);
 
     // allocate memory for data structures
-    char* alloc_bottom(uint size);
-    char* alloc_top(uint size);
+    char* alloc_bottom(ucell size);
+    char* alloc_top(ucell size);
+
+    // cell accessed atomically by the threads that share the memory
+    std::atomic<cell>* atomic_ptr(ucell addr);
+
+    // guards the block list of the heap, shared with the memory
+    std::mutex& heap_mutex() {
+        return *heap_mutex_;
+    }
 
 private:
-    char data_[MEM_SZ];
-    uint top_;
-    uint bottom_;
+    char* data_;            // MEM_SZ bytes
+    ucell top_;
+    ucell bottom_;
+    bool owner_{ true };    // data_ is deleted by the destructor
+    std::shared_ptr<std::mutex> heap_mutex_;
 
-    int check_addr(uint addr, uint size = 0) const;
+    cell check_addr(ucell addr, ucell size = 0) const;
 };
 
 void f_fill();
 void f_erase();
 void f_move();
 
+void f_atomic_fetch();
+void f_atomic_store();
+void f_atomic_plus_store();
+void f_cas();
+void f_fence();
+
+// first-fit list of blocks in the heap region, shared by the VMs of the
+// threads of PARALLEL-FOR and guarded by the heap mutex of the memory;
+// each VM keeps the small blocks it frees in a cache by size, to reuse
+// them without taking the lock
 class Heap {
 public:
     void init();
-    uint allocate(uint size);
-    void free(uint ptr);
-    uint resize(uint, uint new_size);
+    ucell allocate(ucell size);
+    void free(ucell ptr);
+    ucell resize(ucell, ucell new_size);
+
+    // use the block list of other, with an empty cache
+    void share(const Heap& other);
+
+    // return the cached blocks to the list
+    void flush();
 
 private:
     struct Block {
-        uint size;
-        int free;
-        uint next;
+        ucell size;
+        cell free;
+        ucell next;
     };
 
-    uint pool_{ 0 };
-    uint size_{ 0 };
+    static const ucell MAX_CACHED_SZ = 256;         // bytes of a cached block
+    static const size_t MAX_CACHED_BLOCKS = 64;     // blocks of each size
+
+    ucell pool_{ 0 };
+    ucell size_{ 0 };
+    std::vector<ucell> cache_[MAX_CACHED_SZ / CELL_SZ + 1];
+
+    Block* block(ucell addr);
+    ucell allocate_block(ucell size);
+    void coalesce();
 };
 
 void f_allocate();
 void f_free();
 void f_resize();
+
+// an arena is a heap block with its size and the bytes used, followed by
+// the data, allotted by bumping the bytes used; free it with FREE
+void f_arena();
+void f_arena_allot();
+void f_arena_mark();
+void f_arena_release();
+void f_arena_reset();
+
+// a pool hands out items of the same size from a free list linked through
+// the free items, growing by chunks of items allocated from the heap
+void f_pool();
+void f_pool_alloc();
+void f_pool_free();
+void f_pool_destroy();
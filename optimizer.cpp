@@ -0,0 +1,603 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#include "control.h"
+#include "dict.h"
+#include "math.h"
+#include "optimizer.h"
+#include "vm.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <set>
+#include <vector>
+
+static const ucell num_ids =
+#define CONST(word, name, flags, value) 1 +
+#define VAR(word, name, flags, value)   1 +
+#define CODE(word, name, flags, c_code) 1 +
+#include "words.def"
+    0;
+
+struct Effect {
+    bool known{ false };
+    cell in{ 0 };
+    cell out{ 0 };
+};
+
+struct Fusion {
+    ucell super;
+    ucell first;
+    ucell second;
+    ucell third;        // 0 for a pair
+};
+
+// stack effects of primitives indexed by id
+static std::vector<Effect> make_primitive_effects() {
+    std::vector<Effect> effects(num_ids);
+#define CONST(word, name, flags, value) effects[id##name] = Effect{ true, 0, 1 };
+#define VAR(word, name, flags, value)   effects[id##name] = Effect{ true, 0, 1 };
+#include "words.def"
+#define EFFECT(name, in, out)           effects[id##name] = Effect{ true, in, out };
+#include "optimizer.def"
+    return effects;
+}
+
+// built once, shared by the VMs of all threads
+static const std::vector<Effect>& primitive_effects() {
+    static const std::vector<Effect> effects = make_primitive_effects();
+    return effects;
+}
+
+// fusion rules, built after the dictionary exists
+static std::vector<Fusion> make_fusions() {
+    std::vector<Fusion> rules;
+#define FUSE(super, first, second)  rules.push_back({ xt##super, xt##first, xt##second, 0 });
+#define FUSE3(super, first, second, third) \
+    rules.push_back({ xt##super, xt##first, xt##second, xt##third });
+#include "optimizer.def"
+    return rules;
+}
+
+// the xts of the built-in words are the same in all VMs
+static const std::vector<Fusion>& fusions() {
+    static const std::vector<Fusion> rules = make_fusions();
+    return rules;
+}
+
+ucell unfused_xt(ucell xt) {
+    for (auto& rule : fusions()) {
+        if (rule.super == xt) {
+            return rule.first;
+        }
+    }
+    return xt;
+}
+
+static ucell fused_xt(ucell first, ucell second, ucell third = 0) {
+    for (auto& rule : fusions()) {
+        if (rule.first == first && rule.second == second &&
+                rule.third == third) {
+            return rule.super;
+        }
+    }
+    return 0;
+}
+
+// number of xts replaced by a superinstruction
+static size_t fused_length(ucell super) {
+    for (auto& rule : fusions()) {
+        if (rule.super == super) {
+            return rule.third == 0 ? 2 : 3;
+        }
+    }
+    return 1;
+}
+
+static bool is_valid_xt(ucell xt) {
+    return xt >= vm->dict_lo_mem && xt < vm->here &&
+           (xt % CELL_SZ) == 0 && static_cast<ucell>(fetch(xt)) < num_ids;
+}
+
+static Effect word_effect(ucell xt) {
+    ucell code = fetch(xt);
+    if (code == idXDOCOL) {
+        Header* header = Header::header(xt);
+        if (header->flags.effect) {
+            return Effect{ true, header->effect_in, header->effect_out };
+        }
+        else {
+            return Effect{};
+        }
+    }
+    else {
+        return primitive_effects()[code];
+    }
+}
+
+bool get_stack_effect(ucell xt, cell& in, cell& out) {
+    if (!is_valid_xt(xt)) {
+        return false;
+    }
+    Effect effect = word_effect(xt);
+    in = effect.in;
+    out = effect.out;
+    return effect.known;
+}
+
+// one decoded instruction of a colon definition
+struct Insn {
+    ucell addr{ 0 };         // address of the xt
+    ucell xt{ 0 };           // xt, with superinstructions unfused
+    ucell size{ 0 };         // size including inline operands
+    ucell target{ 0 };       // jump target, if any
+};
+
+// primitives with the frame size or the offset of a local as operand
+bool is_local_op(ucell xt) {
+    return xt == xtXENTER_FRAME ||
+           xt == xtXLOCAL_FETCH || xt == xtXLOCAL_STORE ||
+           xt == xtXTWO_LOCAL_FETCH || xt == xtXTWO_LOCAL_STORE ||
+           xt == xtXF_LOCAL_FETCH || xt == xtXF_LOCAL_STORE;
+}
+
+static ucell operand_size(ucell xt) {
+    if (xt == xtXLITERAL || xt == xtXTAIL_CALL ||
+            xt == xtBRANCH || xt == xtZBRANCH ||
+            xt == xtXDO || xt == xtXQUERY_DO || xt == xtXLOOP ||
+            xt == xtXPLUS_LOOP || xt == xtXLEAVE || xt == xtXOF ||
+            xt == xtXDOT_QUOTE || xt == xtXSLITERAL ||
+            xt == xtXABORT_QUOTE || xt == xtXC_QUOTE ||
+            is_local_op(xt)) {
+        return CELL_SZ;
+    }
+    else if (xt == xtX2LITERAL) {
+        return DCELL_SZ;
+    }
+    else if (xt == xtXFLITERAL) {
+        return FCELL_SZ;
+    }
+    else if (xt == xtXDOES_DEFINE) {
+        return 2 * CELL_SZ;
+    }
+    else {
+        return 0;
+    }
+}
+
+static bool is_relative_jump(ucell xt) {
+    return xt == xtBRANCH || xt == xtZBRANCH ||
+           xt == xtXDO || xt == xtXQUERY_DO ||
+           xt == xtXLOOP || xt == xtXPLUS_LOOP ||
+           xt == xtXLEAVE || xt == xtXOF;
+}
+
+// instructions after which control does not simply fall through
+static bool ends_block(ucell xt) {
+    return xt == xtBRANCH || xt == xtZBRANCH ||
+           xt == xtXQUERY_DO || xt == xtXLOOP || xt == xtXPLUS_LOOP ||
+           xt == xtXLEAVE || xt == xtXOF ||
+           xt == xtEXIT || xt == xtXDOES_DEFINE;
+}
+
+// decode [body, end), return false if the code contains data that is not
+// an xt, e.g. compiled with [ ... , ]
+static bool decode(ucell body, ucell end, std::vector<Insn>& insns, bool& has_does,
+                   bool stop_at_exit = false) {
+    has_does = false;
+    ucell ptr = body;
+    while (ptr < end) {
+        ucell xt = fetch(ptr);
+        if (!is_valid_xt(xt)) {
+            return false;
+        }
+
+        Insn insn;
+        insn.addr = ptr;
+        insn.xt = unfused_xt(xt);
+        insn.size = CELL_SZ + operand_size(insn.xt);
+        if (is_relative_jump(insn.xt)) {
+            ucell operand = ptr + CELL_SZ;
+            insn.target = operand + fetch(operand);
+        }
+        else if (insn.xt == xtXDOES_DEFINE) {
+            insn.target = fetch(ptr + 2 * CELL_SZ);
+            has_does = true;
+        }
+
+        if (insn.target != 0 && (insn.target < body || insn.target > end)) {
+            return false;
+        }
+
+        insns.push_back(insn);
+        ptr += insn.size;
+
+        if (stop_at_exit && insn.xt == xtEXIT) {
+            return true;
+        }
+    }
+    return ptr == end;
+}
+
+// basic blocks start at the body, at jump targets and after jumps
+static std::set<ucell> find_leaders(ucell body, const std::vector<Insn>& insns) {
+    std::set<ucell> leaders;
+    leaders.insert(body);
+    for (auto& insn : insns) {
+        if (insn.target != 0) {
+            leaders.insert(insn.target);
+        }
+        if (ends_block(insn.xt)) {
+            leaders.insert(insn.addr + insn.size);
+        }
+    }
+    return leaders;
+}
+
+// replace pairs and triples of xts inside a basic block by superinstructions
+static void fuse(const std::vector<Insn>& insns, const std::set<ucell>& leaders) {
+    size_t i = 0;
+    while (i + 1 < insns.size()) {
+        const Insn& first = insns[i];
+        const Insn& second = insns[i + 1];
+        ucell xt = fetch(first.addr);
+        if (xt != first.xt) {
+            i += fused_length(xt);  // already fused, e.g. copied by inliner
+            continue;
+        }
+        if (i + 2 < insns.size() && leaders.count(second.addr) == 0 &&
+                leaders.count(insns[i + 2].addr) == 0) {
+            ucell super = fused_xt(first.xt, second.xt, insns[i + 2].xt);
+            if (super != 0) {
+                store(first.addr, super);
+                i += 3;
+                continue;
+            }
+        }
+        if (leaders.count(second.addr) == 0) {
+            ucell super = fused_xt(first.xt, second.xt);
+            if (super != 0) {
+                store(first.addr, super);
+                i += 2;
+                continue;
+            }
+        }
+        i++;
+    }
+}
+
+// follow the data stack depth through all paths of the control flow graph
+static Effect analyse(const std::vector<Insn>& insns) {
+    const cell unset = INT_MIN;
+    std::vector<cell> depth(insns.size(), unset);
+    std::vector<size_t> work;
+    cell min_depth = 0;
+    cell exit_depth = unset;
+
+    auto index_of = [&insns](ucell addr) -> cell {
+        for (size_t i = 0; i < insns.size(); ++i) {
+            if (insns[i].addr == addr) {
+                return static_cast<cell>(i);
+            }
+        }
+        return -1;
+    };
+
+    auto flow = [&](cell i, cell d) -> bool {
+        if (i < 0) {
+            return false;           // fell off the end
+        }
+        if (depth[i] == unset) {
+            depth[i] = d;
+            work.push_back(i);
+            return true;
+        }
+        return depth[i] == d;       // paths must agree
+    };
+
+    if (insns.empty() || !flow(0, 0)) {
+        return Effect{};
+    }
+
+    while (!work.empty()) {
+        size_t i = work.back();
+        work.pop_back();
+        const Insn& insn = insns[i];
+        cell d = depth[i];
+        cell next = (i + 1 < insns.size()) ? static_cast<cell>(i + 1) : -1;
+
+        if (insn.xt == xtXOF) {     // ( x1 x2 -- | x1 )
+            min_depth = std::min(min_depth, d - 2);
+            if (!flow(next, d - 2) || !flow(index_of(insn.target), d - 1)) {
+                return Effect{};
+            }
+            continue;
+        }
+
+        Effect effect = insn.xt == xtXTAIL_CALL ?
+                        word_effect(fetch(insn.addr + CELL_SZ)) :
+                        word_effect(insn.xt);
+        if (!effect.known) {
+            return Effect{};
+        }
+        min_depth = std::min(min_depth, d - effect.in);
+        cell new_d = d - effect.in + effect.out;
+
+        if (insn.xt == xtEXIT) {
+            if (exit_depth == unset) {
+                exit_depth = new_d;
+            }
+            else if (exit_depth != new_d) {
+                return Effect{};
+            }
+        }
+        else if (insn.xt == xtBRANCH || insn.xt == xtXLEAVE) {
+            if (!flow(index_of(insn.target), new_d)) {
+                return Effect{};
+            }
+        }
+        else if (insn.xt == xtZBRANCH || insn.xt == xtXQUERY_DO ||
+                 insn.xt == xtXLOOP || insn.xt == xtXPLUS_LOOP) {
+            if (!flow(next, new_d) || !flow(index_of(insn.target), new_d)) {
+                return Effect{};
+            }
+        }
+        else if (!flow(next, new_d)) {
+            return Effect{};
+        }
+    }
+
+    if (exit_depth == unset) {
+        return Effect{};
+    }
+    return Effect{ true, -min_depth, exit_depth - min_depth };
+}
+
+void optimize_definition(Header* header) {
+    if (vm->user->TRACE) {
+        return;                     // keep the code as written
+    }
+
+    ucell body = header->body();
+    ucell end = vm->here;
+    std::vector<Insn> insns;
+    bool has_does;
+    if (!decode(body, end, insns, has_does)) {
+        return;
+    }
+
+    fuse(insns, find_leaders(body, insns));
+
+    if (!has_does) {
+        Effect effect = analyse(insns);
+        if (effect.known && effect.in <= UCHAR_MAX && effect.out <= UCHAR_MAX) {
+            header->flags.effect = true;
+            header->effect_in = static_cast<uchar>(effect.in);
+            header->effect_out = static_cast<uchar>(effect.out);
+        }
+    }
+}
+
+// return the code of a colon definition that can be copied into the caller,
+// [body, end) excluding the final EXIT
+static bool inline_region(Header* header, ucell& end) {
+    if (header->code != idXDOCOL || header->flags.smudge) {
+        return false;
+    }
+
+    ucell body = header->body();
+    std::vector<Insn> insns;
+    bool has_does;
+    if (!decode(body, body + header->get_size(), insns, has_does, true) ||
+            has_does || insns.empty() || insns.back().xt != xtEXIT) {
+        return false;
+    }
+    end = insns.back().addr;
+
+    for (auto& insn : insns) {
+        if (insn.target > end) {
+            return false;           // EXIT in the middle
+        }
+        else if (insn.xt == header->xt()) {
+            return false;           // RECURSE
+        }
+        else if (insn.xt == xtXTAIL_CALL || insn.xt == xtACTIVATE) {
+            return false;           // does not return to the caller
+        }
+        else if (insn.xt == xtTOR || insn.xt == xtFROMR ||
+                 insn.xt == xtR_FETCH || insn.xt == xtRDROP ||
+                 insn.xt == xtTWO_TO_R || insn.xt == xtTWO_R_TO ||
+                 insn.xt == xtTWO_R_FETCH || insn.xt == xtN_TO_R ||
+                 insn.xt == xtN_R_FROM) {
+            return false;           // return stack access
+        }
+        else if (insn.xt == xtXENTER_FRAME || insn.xt == xtXLEAVE_FRAME) {
+            return false;           // locals need a frame
+        }
+    }
+
+    // DO-loops use the loop stack, not the return stack, so I and J see the
+    // same loop whether the code is called or copied
+    return true;
+}
+
+bool compile_inline(ucell xt) {
+    if (vm->user->TRACE || !is_valid_xt(xt)) {
+        return false;
+    }
+
+    Header* header = Header::header(xt);
+    ucell end;
+    if (!inline_region(header, end)) {
+        return false;
+    }
+
+    ucell body = header->body();
+    ucell size = end - body;
+    if (!header->flags.inline_always &&
+            size > static_cast<ucell>(vm->user->INLINE_LIMIT) * CELL_SZ) {
+        return false;
+    }
+
+    // copy code and the inlined regions it contains
+    ucell start = vm->here;
+    vm->dict.allot(size);
+    memcpy(mem_char_ptr(start, size), mem_char_ptr(body, size), size);
+
+    for (auto it = vm->inlined.lower_bound(body);
+            it != vm->inlined.end() && it->first < end; ++it) {
+        vm->inlined[it->first - body + start] =
+            InlinedCode{ it->second.end - body + start, it->second.xt };
+    }
+    vm->inlined[start] = InlinedCode{ vm->here, xt };
+    return true;
+}
+
+void compile_literal(cell value) {
+    vm->literals.push_back(vm->here);
+    comma(xtXLITERAL);
+    comma(value);
+}
+
+// evaluate xt at compile time on literal arguments
+static bool fold_unary(ucell xt, cell a, cell& result) {
+#define FOLD1(name, expr)   if (xt == xt##name) { result = (expr); return true; }
+#include "optimizer.def"
+    return false;
+}
+
+static bool fold_binary(ucell xt, cell a, cell b, cell& result) {
+#define FOLD2(name, expr)   if (xt == xt##name) { result = (expr); return true; }
+#include "optimizer.def"
+    return false;
+}
+
+// replace the literals just compiled and xt by a single literal, unless
+// a jump lands between them
+static bool compile_folded(ucell xt) {
+    size_t n = vm->literals.size();
+    if (vm->user->TRACE || n == 0 ||
+            vm->literals[n - 1] != vm->here - 2 * CELL_SZ) {
+        return false;
+    }
+
+    cell result;
+    ucell last = vm->literals[n - 1];
+    cell b = fetch(last + CELL_SZ);
+    ucell prev_add = last - 3 * CELL_SZ;
+    if (xt == xtPLUS && n >= 2 && vm->literals[n - 2] == prev_add &&
+            static_cast<ucell>(fetch(last - CELL_SZ)) == xtPLUS &&
+            !is_jump_target(prev_add, vm->here)) {
+        // n1 + n2 + becomes n1+n2 +
+        store(prev_add + CELL_SZ, fetch(prev_add + CELL_SZ) + b);
+        vm->literals.resize(n - 1);
+        vm->here = last;
+        return true;
+    }
+    else if (n >= 2 && vm->literals[n - 2] == last - 2 * CELL_SZ &&
+            !is_jump_target(last - 2 * CELL_SZ, vm->here) &&
+            fold_binary(xt, fetch(last - CELL_SZ), b, result)) {
+        vm->literals.resize(n - 2);
+        vm->here = last - 2 * CELL_SZ;
+    }
+    else if (!is_jump_target(last, vm->here) && fold_unary(xt, b, result)) {
+        vm->literals.resize(n - 1);
+        vm->here = last;
+    }
+    else {
+        return false;
+    }
+
+    compile_literal(result);
+    return true;
+}
+
+// compile a reference to a constant as a literal, to a variable as the
+// literal address of its body and to a structure field as the addition
+// of its offset
+static bool compile_constant(ucell xt) {
+    if (vm->user->TRACE || !is_valid_xt(xt)) {
+        return false;
+    }
+
+    ucell body = xt + CELL_SZ;
+    switch (fetch(xt)) {
+    case idXDOCONST:
+        compile_literal(fetch(body));
+        return true;
+    case idXDO2CONST:
+        comma(xtX2LITERAL);
+        dcomma(dfetch(body));
+        return true;
+    case idXDOFCONST:
+        comma(xtXFLITERAL);
+        fcomma(ffetch(body));
+        return true;
+    case idXDOVAR:
+    case idXDOFVAR:
+        compile_literal(body);
+        return true;
+    case idXPLUS_FIELD:
+        if (fetch(body) != 0) {
+            compile_literal(fetch(body));
+            compile_xt(xtPLUS);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+void compile_xt(ucell xt) {
+    if (xt == xtEXIT) {
+        compile_exit();
+    }
+    else if (!compile_folded(xt) && !compile_constant(xt) &&
+             !compile_inline(xt)) {
+        comma(xt);
+        if (fetch(xt) == idXDOCOL) {
+            vm->last_call = vm->here - CELL_SZ;
+        }
+    }
+}
+
+void forget_inlined(ucell here) {
+    vm->inlined.erase(vm->inlined.lower_bound(here), vm->inlined.end());
+}
+
+void f_inline() {
+    Header* header = reinterpret_cast<Header*>(
+                         mem_char_ptr(vm->latest_word));
+    ucell end;
+    if (!inline_region(header, end)) {
+        error(Error::CannotInline, header->name()->to_string());
+    }
+    header->flags.inline_always = true;
+}
+
+void f_xfused_zbranch(bool flag) {
+    // vm->ip points to the 0BRANCH xt, followed by the offset
+    if (flag) {
+        vm->ip += 2 * CELL_SZ;
+    }
+    else {
+        vm->ip += CELL_SZ;
+        vm->ip += fetch(vm->ip);
+    }
+}
+
+void f_stack_effect() {
+    ucell xt = pop();
+    cell in, out;
+    if (get_stack_effect(xt, in, out)) {
+        push(in);
+        push(out);
+        push(F_TRUE);
+    }
+    else {
+        push(F_FALSE);
+    }
+}
@@ -0,0 +1,42 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "dict.h"
+#include "forth.h"
+
+// code of a colon definition copied into another
+struct InlinedCode {
+    ucell end;           // end address of copied code
+    ucell xt;            // inlined word
+};
+
+// data stack effect of a word, if known
+bool get_stack_effect(ucell xt, cell& in, cell& out);
+
+// optimize the body of a colon definition, called by ;
+void optimize_definition(Header* header);
+
+// map a superinstruction back to the first xt of the fused pair
+ucell unfused_xt(ucell xt);
+
+// primitives with the frame size or the offset of a local as operand
+bool is_local_op(ucell xt);
+
+// compile a literal, folded with the operators that follow it
+void compile_literal(cell value);
+
+// compile xt, copying its code if it is a short colon definition
+void compile_xt(ucell xt);
+bool compile_inline(ucell xt);
+void forget_inlined(ucell here);
+
+// superinstructions
+void f_xfused_zbranch(bool flag);
+
+void f_stack_effect();
+void f_inline();
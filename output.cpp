@@ -4,22 +4,169 @@
 // License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
 //-----------------------------------------------------------------------------
 
+#include "errors.h"
 #include "math.h"
 #include "output.h"
 #include "vm.h"
+#include <charconv>
 #include <cmath>
+#include <cstdio>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
 
+static const char digit_chars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+// "00" "01" ... "99", to convert two decimal digits per division
+struct DecimalPairs {
+    char digits[200];
+
+    constexpr DecimalPairs() : digits() {
+        for (int i = 0; i < 100; ++i) {
+            digits[2 * i] = static_cast<char>('0' + i / 10);
+            digits[2 * i + 1] = static_cast<char>('0' + i % 10);
+        }
+    }
+};
+
+static constexpr DecimalPairs decimal_pairs;
+
+static bool is_valid_base(cell base) {
+    return base >= 2 && base <= 36;
+}
+
+// write the digits of value backwards from end, return the first digit;
+// the 128-bit division of CELL64 is only used for the high digits
+static char* format_digits(char* end, udint value, cell base) {
+    char* p = end;
+    while (static_cast<udint>(static_cast<uint64_t>(value)) != value) {
+        *--p = digit_chars[static_cast<cell>(value % base)];
+        value /= base;
+    }
+
+    uint64_t v = static_cast<uint64_t>(value);
+    if (base == 10) {
+        while (v >= 100) {
+            uint64_t pair = v % 100;
+            v /= 100;
+            p -= 2;
+            memcpy(p, decimal_pairs.digits + 2 * pair, 2);
+        }
+        if (v >= 10) {
+            p -= 2;
+            memcpy(p, decimal_pairs.digits + 2 * v, 2);
+        }
+        else {
+            *--p = static_cast<char>('0' + v);
+        }
+    }
+    else if (base == 16) {
+        do {
+            *--p = digit_chars[v & 0xf];
+            v >>= 4;
+        }
+        while (v != 0);
+    }
+    else {
+        do {
+            *--p = digit_chars[v % base];
+            v /= base;
+        }
+        while (v != 0);
+    }
+    return p;
+}
+
+// room for the digits of a double cell in base 2 and a sign
+static const cell DIGITS_BUFFER_SZ = 2 * CELL_BITS + 2;
+
+// printf-like conversion of a double with the given number of digits after
+// the point, or of significant digits for the general format
+static std::string format_double(double value, std::chars_format format,
+                                 cell precision) {
+    char buffer[BUFFER_SZ];
+    auto res = std::to_chars(buffer, buffer + sizeof(buffer), value, format,
+                             static_cast<int>(precision));
+    if (res.ec == std::errc()) {
+        return std::string(buffer, res.ptr);
+    }
+    else {
+        // does not fit the buffer
+        std::ostringstream oss;
+        if (format == std::chars_format::fixed) {
+            oss << std::fixed;
+        }
+        else if (format == std::chars_format::scientific) {
+            oss << std::scientific;
+        }
+        oss << std::setprecision(precision) << value;
+        return oss.str();
+    }
+}
+
+ConsoleOutput::ConsoleOutput() {
+    setp(data_, data_ + BUFFER_SZ);
+}
+
+ConsoleOutput::~ConsoleOutput() {
+    write_out();
+}
+
+void ConsoleOutput::write_out() {
+    std::size_t size = pptr() - pbase();
+    if (capture_) {
+        captured_.append(pbase(), size);
+    }
+    else {
+        if (size > 0) {
+            std::fwrite(pbase(), 1, size, stdout);
+        }
+        std::fflush(stdout);
+    }
+    setp(data_, data_ + BUFFER_SZ);
+}
+
+ConsoleOutput::int_type ConsoleOutput::overflow(int_type c) {
+    write_out();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize ConsoleOutput::xsputn(const char* s, std::streamsize n) {
+    std::streamsize room = epptr() - pptr();
+    if (n > room) {
+        write_out();
+        if (n > static_cast<std::streamsize>(BUFFER_SZ)) {
+            if (capture_) {
+                captured_.append(s, n);
+            }
+            else {
+                std::fwrite(s, 1, n, stdout);
+            }
+            return n;
+        }
+    }
+    std::memcpy(pptr(), s, n);
+    pbump(static_cast<int>(n));
+    return n;
+}
+
+int ConsoleOutput::sync() {
+    write_out();
+    return 0;
+}
+
 void NumberOutput::init() {
-    memset(vm.number_output_data, BL, NUMBER_OUTPUT_SZ);
+    memset(vm->number_output_data, BL, NUMBER_OUTPUT_SZ);
     start();
 }
 
 void NumberOutput::start() {
-    vm.number_output_ptr = NUMBER_OUTPUT_SZ;
+    vm->number_output_ptr = NUMBER_OUTPUT_SZ;
 }
 
 void NumberOutput::add_digit() {
@@ -27,9 +174,9 @@ void NumberOutput::add_digit() {
     udint value = dpop();
 
     // can use % instead of f_mod because value is assumed positive
-    int digit = static_cast<int>(value % vm.user->BASE);
+    cell digit = static_cast<cell>(value % vm->user->BASE);
 
-    value /= vm.user->BASE;
+    value /= vm->user->BASE;
     dpush(value);
 
     // output it
@@ -42,108 +189,114 @@ void NumberOutput::add_digit() {
 }
 
 void NumberOutput::add_digits() {
-    dint value;
-    do {
-        add_digit();
-        value = dpeek();
+    cell base = vm->user->BASE;
+    if (is_valid_base(base)) {
+        char buffer[DIGITS_BUFFER_SZ];
+        char* end = buffer + sizeof(buffer);
+        char* p = format_digits(end, dpop(), base);
+        dpush(0);
+        add_string(p, static_cast<ucell>(end - p));
+    }
+    else {
+        dint value;
+        do {
+            add_digit();
+            value = dpeek();
+        }
+        while (value != 0);
     }
-    while (value != 0);
 }
 
 void NumberOutput::add_char(char c) {
-    if (vm.number_output_ptr < 1) {
+    if (vm->number_output_ptr < 1) {
         error(Error::PicturedNumericOutputStringOverflow);
     }
     else {
-        vm.number_output_data[--vm.number_output_ptr] = c;
+        vm->number_output_data[--vm->number_output_ptr] = c;
     }
 }
 
-void NumberOutput::add_sign(int sign) {
+void NumberOutput::add_sign(cell sign) {
     if (sign < 0) {
         add_char('-');
     }
 }
 
 void NumberOutput::add_string(const std::string& str) {
-    add_string(str.c_str(), static_cast<uint>(str.size()));
+    add_string(str.c_str(), static_cast<ucell>(str.size()));
 }
 
-void NumberOutput::add_string(const char* str, uint size) {
-    for (int i = size - 1; i >= 0; --i) {
+void NumberOutput::add_string(const char* str, ucell size) {
+    for (cell i = size - 1; i >= 0; --i) {
         add_char(str[i]);
     }
 }
 
 void NumberOutput::end() const {
     dpop();     // drop number
-    push(mem_addr(vm.number_output_data + vm.number_output_ptr));
-    push(NUMBER_OUTPUT_SZ - vm.number_output_ptr);
+    push(mem_addr(vm->number_output_data + vm->number_output_ptr));
+    push(NUMBER_OUTPUT_SZ - vm->number_output_ptr);
 }
 
 void NumberOutput::end_print() const {
     dpop();     // drop number
-    const char* str = vm.number_output_data + vm.number_output_ptr;
-    uint size = NUMBER_OUTPUT_SZ - vm.number_output_ptr;
+    const char* str = vm->number_output_data + vm->number_output_ptr;
+    ucell size = NUMBER_OUTPUT_SZ - vm->number_output_ptr;
     print_string(str, size);
 }
 
-static std::string print_dint_uint(int sign) {
-    vm.number_output.start();
-    vm.number_output.add_char(BL);
-    vm.number_output.add_digits();
-    vm.number_output.add_sign(sign);
-    vm.number_output.end();
-    uint size = pop();
-    uint addr = pop();
+static std::string print_dint_uint(cell sign) {
+    vm->number_output.start();
+    vm->number_output.add_char(BL);
+    vm->number_output.add_digits();
+    vm->number_output.add_sign(sign);
+    vm->number_output.end();
+    ucell size = pop();
+    ucell addr = pop();
     char* str = mem_char_ptr(addr, size);
     return std::string(str, str + size);
 }
 
-static std::string print_dint_uint_aligned(int width, int sign) {
-    vm.number_output.start();
+static std::string print_dint_uint_aligned(cell width, cell sign) {
+    vm->number_output.start();
 
     dint d;
     do {
-        vm.number_output.add_digit();
+        vm->number_output.add_digit();
         width--;
         d = dpeek();
     }
     while (d != 0);
 
     if (sign < 0) {
-        vm.number_output.add_sign(sign);
+        vm->number_output.add_sign(sign);
         width--;
     }
 
     while (width-- > 0) {
-        vm.number_output.add_char(BL);
+        vm->number_output.add_char(BL);
     }
 
-    vm.number_output.end();
-    uint size = pop();
-    uint addr = pop();
+    vm->number_output.end();
+    ucell size = pop();
+    ucell addr = pop();
     char* str = mem_char_ptr(addr, size);
     return std::string(str, str + size);
 }
 
 std::string char_to_string(char c) {
-    std::ostringstream oss;
-    oss << c;
-    return oss.str();
+    return std::string(1, c);
 }
 
 void print_char(char c) {
-    std::cout << char_to_string(c);
+    vm->out.put(c);
 }
 
 void print_string(const std::string& str) {
-    for (char c : str) {
-        print_char(c);
-    }
+    vm->out.write(str.data(), str.size());
 }
 
-std::string spaces_to_string(int count) {
+std::string spaces_to_string(cell count) {
     if (count < 1) {
         return "";
     }
@@ -152,44 +305,88 @@ std::string spaces_to_string(int count) {
     }
 }
 
-void print_spaces(int count) {
+void print_spaces(cell count) {
     print_string(spaces_to_string(count));
 }
 
-std::string string_to_string(uint addr, uint size) {
+std::string string_to_string(ucell addr, ucell size) {
     return string_to_string(mem_char_ptr(addr, size), size);
 }
 
-std::string string_to_string(const char* str, uint size) {
-    std::ostringstream oss;
-    for (uint i = 0; i < size; ++i) {
-        oss << str[i];
-    }
-    return oss.str();
+std::string string_to_string(const char* str, ucell size) {
+    return std::string(str, str + size);
 }
 
-void print_string(uint addr, uint size) {
+void print_string(ucell addr, ucell size) {
     print_string(mem_char_ptr(addr, size), size);
 }
 
-void print_string(const char* str, uint size) {
-    print_string(string_to_string(str, size));
+void print_string(const char* str, ucell size) {
+    vm->out.write(str, size);
+}
+
+// digits of value in BASE, with a minus sign if negative, and a space
+static std::string format_number(udint value, bool negative) {
+    cell base = vm->user->BASE;
+    if (!is_valid_base(base)) {
+        dpush(value);
+        return print_dint_uint(negative ? -1 : 1);
+    }
+
+    char buffer[DIGITS_BUFFER_SZ + 1];
+    char* end = buffer + sizeof(buffer);
+    *(end - 1) = BL;
+    char* p = format_digits(end - 1, value, base);
+    if (negative) {
+        *--p = '-';
+    }
+    return std::string(p, end);
+}
+
+// same as format_number, aligned to the right in width characters
+static std::string format_number(udint value, bool negative, cell width) {
+    cell base = vm->user->BASE;
+    if (!is_valid_base(base)) {
+        dpush(value);
+        return print_dint_uint_aligned(width, negative ? -1 : 1);
+    }
+
+    char buffer[DIGITS_BUFFER_SZ];
+    char* end = buffer + sizeof(buffer);
+    char* p = format_digits(end, value, base);
+    if (negative) {
+        *--p = '-';
+    }
+
+    cell size = static_cast<cell>(end - p);
+    if (size >= width) {
+        return std::string(p, end);
+    }
+    else if (width > NUMBER_OUTPUT_SZ) {
+        error(Error::PicturedNumericOutputStringOverflow);
+        return std::string();
+    }
+    else {
+        std::string number(width - size, BL);
+        number.append(p, end);
+        return number;
+    }
 }
 
-std::string number_to_string(int value) {
-    dpush(std::abs(static_cast<dint>(value)));
-    int sign = value;
-    return print_dint_uint(sign);
+static udint magnitude(dint value) {
+    return value < 0 ? -static_cast<udint>(value) : static_cast<udint>(value);
 }
 
-void print_number(int value) {
+std::string number_to_string(cell value) {
+    return format_number(magnitude(value), value < 0);
+}
+
+void print_number(cell value) {
     print_string(number_to_string(value));
 }
 
 std::string number_to_string(dint value) {
-    dpush(std::abs(value));
-    int sign = value < 0 ? -1 : 1;
-    return print_dint_uint(sign);
+    return format_number(magnitude(value), value < 0);
 }
 
 void print_number(dint value) {
@@ -197,10 +394,8 @@ void print_number(dint value) {
 }
 
 std::string number_to_string(double value) {
-    std::ostringstream oss;
-    oss << std::setprecision(vm.precision - 1)
-        << (std::fabs(value) < EPSILON ? 0 : value);
-    return oss.str();
+    return format_double(std::fabs(value) < EPSILON ? 0 : value,
+                         std::chars_format::general, vm->precision - 1);
 }
 
 void print_number(double value) {
@@ -208,10 +403,9 @@ void print_number(double value) {
 }
 
 std::string number_fixed_to_string(double value) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(vm.precision - 1)
-        << (std::fabs(value) < EPSILON ? 0 : value);
-    std::string number = oss.str();
+    std::string number = format_double(std::fabs(value) < EPSILON ? 0 : value,
+                                       std::chars_format::fixed,
+                                       vm->precision - 1);
     if (number.find('.') == std::string::npos) {
         number.push_back('.');
     }
@@ -232,26 +426,23 @@ std::string number_engineering_to_string(double value) {
         return "0. ";
     }
     else {
-        int exponent = static_cast<int>(std::floor(std::log10(std::fabs(value))));
-        int eng_exponent = exponent >= 0
+        cell exponent = static_cast<cell>(std::floor(std::log10(std::fabs(value))));
+        cell eng_exponent = exponent >= 0
                            ? exponent - (exponent % 3)
                            : exponent - ((exponent % 3 + 3) % 3);
         double significand = value / std::pow(10.0, eng_exponent);
 
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(vm.precision - 1)
-            << significand;
+        std::string significand_str = format_double(
+                                          significand, std::chars_format::fixed,
+                                          vm->precision - 1);
 
         // Trim trailing zeros and decimal point
-        std::string significand_str = oss.str();
         significand_str.erase(significand_str.find_last_not_of('0') + 1);
         if (significand_str.back() == '.') {
             significand_str.pop_back();
         }
 
-        std::ostringstream result;
-        result << significand_str << "E" << eng_exponent << BL;
-        return result.str();
+        return significand_str + "E" + std::to_string(eng_exponent) + BL;
     }
 }
 
@@ -264,25 +455,21 @@ std::string number_scientific_to_string(double value) {
         return "0E+0 ";
     }
     else {
-        int exponent = static_cast<int>(std::floor(std::log10(std::fabs(value))));
+        cell exponent = static_cast<cell>(std::floor(std::log10(std::fabs(value))));
         double significand = value / std::pow(10.0, exponent);
 
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(vm.precision - 1)
-            << significand;
+        std::string significand_str = format_double(
+                                          significand, std::chars_format::fixed,
+                                          vm->precision - 1);
 
         // Trim trailing zeros and decimal point
-        std::string significand_str = oss.str();
         significand_str.erase(significand_str.find_last_not_of('0') + 1);
         if (significand_str.back() == '.') {
             significand_str.pop_back();
         }
 
-        std::ostringstream result;
-        result << significand_str << "E" << (exponent >= 0 ? "+" : "") << exponent <<
-               " ";
-        return result.str();
-        return std::string();
+        return significand_str + "E" + (exponent >= 0 ? "+" : "") +
+               std::to_string(exponent) + BL;
     }
 }
 
@@ -302,10 +489,9 @@ void print_number_dot(dint value) {
 }
 
 std::string number_e_to_string(double value) {
-    std::ostringstream oss;
-    oss << std::setprecision(vm.precision - 1)
-        << (std::fabs(value) < EPSILON ? 0 : value);
-    std::string number = oss.str();
+    std::string number = format_double(std::fabs(value) < EPSILON ? 0 : value,
+                                       std::chars_format::general,
+                                       vm->precision - 1);
     if (number.find('e') == std::string::npos &&
             number.find('E') == std::string::npos) {
         number.push_back('e');
@@ -318,41 +504,34 @@ void print_number_e(double value) {
     print_string(number_e_to_string(value));
 }
 
-std::string number_to_string(int value, int width) {
-    dpush(std::abs(value));
-    return print_dint_uint_aligned(width, value);
+std::string number_to_string(cell value, cell width) {
+    return format_number(magnitude(value), value < 0, width);
 }
 
-void print_number(int value, int width) {
+void print_number(cell value, cell width) {
     print_string(number_to_string(value, width));
 }
 
-std::string number_to_string(dint value, int width) {
-    dpush(std::abs(value));
-    int sign = value < 0 ? -1 : 1;
-    return print_dint_uint_aligned(width, sign);
+std::string number_to_string(dint value, cell width) {
+    return format_number(magnitude(value), value < 0, width);
 }
 
-void print_number(dint value, int width) {
+void print_number(dint value, cell width) {
     print_string(number_to_string(value, width));
 }
 
-std::string unsigned_number_to_string(uint value) {
-    push(value);    // lo
-    push(0);        // hi
-    return print_dint_uint(+1);
+std::string unsigned_number_to_string(ucell value) {
+    return format_number(value, false);
 }
 
-void print_unsigned_number(uint value) {
+void print_unsigned_number(ucell value) {
     print_string(unsigned_number_to_string(value));
 }
 
-std::string unsigned_number_to_string(uint value, int width) {
-    push(value);
-    push(0);
-    return print_dint_uint_aligned(width, 1);
+std::string unsigned_number_to_string(ucell value, cell width) {
+    return format_number(value, false, width);
 }
 
-void print_unsigned_number(uint value, int width) {
+void print_unsigned_number(ucell value, cell width) {
     print_string(unsigned_number_to_string(value, width));
 }
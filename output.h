@@ -6,9 +6,37 @@
 
 #pragma once
 
+#include <streambuf>
 #include <string>
 #include "forth.h"
 
+// console output of a VM is collected here and written to stdout only when
+// the buffer fills or the stream is flushed: std::endl, before reading from
+// the terminal, before KEY, EKEY and MS, before error messages and when the
+// VM is destroyed; the output can also be captured in a string
+class ConsoleOutput : public std::streambuf {
+public:
+    static const ucell BUFFER_SZ = 64 * 1024;
+
+    ConsoleOutput();
+    virtual ~ConsoleOutput();
+
+    void set_capture(bool capture) { capture_ = capture; }
+    std::string& captured() { return captured_; }
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+private:
+    char data_[BUFFER_SZ];
+    bool capture_{ false };
+    std::string captured_;
+
+    void write_out();
+};
+
 class NumberOutput {
 public:
     void init();
@@ -17,30 +45,30 @@ public:
     void add_digit();
     void add_digits();
     void add_char(char c);
-    void add_sign(int sign);
+    void add_sign(cell sign);
     void add_string(const std::string& str);
-    void add_string(const char* str, uint size);
+    void add_string(const char* str, ucell size);
     void end() const;
     void end_print() const;
 
-    // actual data in vm.number_output_data and vm.number_output_ptr
+    // actual data in vm->number_output_data and vm->number_output_ptr
 };
 
 std::string char_to_string(char c);
 void print_char(char c);
 void print_string(const std::string& str);
 
-std::string spaces_to_string(int count);
-void print_spaces(int count);
+std::string spaces_to_string(cell count);
+void print_spaces(cell count);
 
-std::string string_to_string(uint addr, uint size);
-std::string string_to_string(const char* str, uint size);
+std::string string_to_string(ucell addr, ucell size);
+std::string string_to_string(const char* str, ucell size);
 
-void print_string(uint addr, uint size);
-void print_string(const char* str, uint size);
+void print_string(ucell addr, ucell size);
+void print_string(const char* str, ucell size);
 
-std::string number_to_string(int value);
-void print_number(int value);
+std::string number_to_string(cell value);
+void print_number(cell value);
 
 std::string number_to_string(dint value);
 void print_number(dint value);
@@ -63,14 +91,14 @@ void print_number_dot(dint value);
 std::string number_e_to_string(double value);
 void print_number_e(double value);
 
-std::string number_to_string(int value, int width);
-void print_number(int value, int width);
+std::string number_to_string(cell value, cell width);
+void print_number(cell value, cell width);
 
-std::string number_to_string(dint value, int width);
-void print_number(dint value, int width);
+std::string number_to_string(dint value, cell width);
+void print_number(dint value, cell width);
 
-std::string unsigned_number_to_string(uint value);
-void print_unsigned_number(uint value);
+std::string unsigned_number_to_string(ucell value);
+void print_unsigned_number(ucell value);
 
-std::string unsigned_number_to_string(uint value, int width);
-void print_unsigned_number(uint value, int width);
+std::string unsigned_number_to_string(ucell value, cell width);
+void print_unsigned_number(ucell value, cell width);
@@ -0,0 +1,336 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#include "errors.h"
+#include "parallel.h"
+#include "vm.h"
+#include <algorithm>
+#include <cstring>
+
+static std::atomic<int> num_parallel_threads{ 0 };
+
+// each thread takes its part of the range in about this many chunks, so
+// that there is work left to steal when the iterations take uneven time
+static const cell CHUNKS_PER_THREAD = 8;
+
+// buffers and user variables of a worker, allocated in the heap of the
+// caller during each loop
+static ucell area_size() {
+    return aligned(WORDBUF_SZ) + aligned(PAD_SZ) +
+           aligned(NUMBER_OUTPUT_SZ) + aligned(TIB_SZ) +
+           aligned(sizeof(User));
+}
+
+static ucell area_user_offset() {
+    return area_size() - aligned(sizeof(User));
+}
+
+void set_parallel_threads(int num_threads) {
+    num_parallel_threads = num_threads;
+}
+
+Workers::~Workers() {
+    clear();
+}
+
+void Workers::clear() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    start_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+    quit_ = false;
+    started_ = false;
+}
+
+void Workers::for_each(ucell xt, cell lo, cell hi) {
+    run(xt, 0, false, 0, lo, hi);
+}
+
+cell Workers::reduce(ucell xt, ucell combine, cell x0, cell lo, cell hi) {
+    return run(xt, combine, true, x0, lo, hi);
+}
+
+cell Workers::run(ucell xt, ucell combine, bool reduce, cell x0,
+                  cell lo, cell hi) {
+    if (!started_ && !nested_) {
+        start();
+    }
+
+    // nested loops and loops of one iteration run in the calling thread
+    size_t num_parts = threads_.size() + 1;
+    if (nested_ || busy_ || hi - lo < 2) {
+        num_parts = 1;
+    }
+    if (num_parts == 1) {
+        if (reduce) {
+            push(x0);
+        }
+        for (cell i = lo; i < hi; i++) {
+            push(i);
+            f_execute(xt);
+            if (reduce) {
+                f_execute(combine);
+            }
+        }
+        return reduce ? pop() : 0;
+    }
+
+    size_t num_workers = num_parts - 1;
+    areas_ = vm->heap.allocate(area_size() * num_workers);
+    if (areas_ == 0) {
+        error(Error::AllocateException);
+    }
+    for (size_t i = 0; i < num_workers; i++) {
+        ucell user = areas_ + i * area_size() + area_user_offset();
+        memcpy(mem_char_ptr(user, sizeof(User)), vm->user, sizeof(User));
+    }
+
+    // split the range in equal parts
+    cell count = hi - lo;
+    cell part_size = count / num_parts;
+    cell extra = count % num_parts;
+    cell next = lo;
+    for (size_t i = 0; i < num_parts; i++) {
+        ranges_[i].next = next;
+        next += part_size + (static_cast<cell>(i) < extra ? 1 : 0);
+        ranges_[i].end = next;
+    }
+
+    xt_ = xt;
+    combine_ = combine;
+    reduce_ = reduce;
+    x0_ = x0;
+    grain_ = std::max<cell>(1, part_size / CHUNKS_PER_THREAD);
+    results_.assign(num_parts, x0);
+    cancel_ = false;
+    error_code_ = 0;
+    error_message_.clear();
+    busy_ = true;
+
+    vm->out.flush();        // output of the caller before the workers'
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_++;
+        num_running_ = num_workers;
+    }
+    start_.notify_all();
+
+    // the caller works on part 0, then waits for the workers even if it
+    // is unwound by a task switch
+    auto finish = [&]() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&]() {
+            return num_running_ == 0;
+        });
+        busy_ = false;
+        vm->heap.free(areas_);
+        areas_ = 0;
+    };
+    try {
+        work(0);
+    }
+    catch (...) {
+        cancel_ = true;
+        finish();
+        throw;
+    }
+    finish();
+
+    if (error_code_ != 0) {
+        vm->error_message = error_message_;
+        f_throw(error_code_);
+    }
+
+    if (!reduce) {
+        return 0;
+    }
+    push(results_[0]);
+    for (size_t i = 1; i < num_parts; i++) {
+        push(results_[i]);
+        f_execute(combine);
+    }
+    return pop();
+}
+
+void Workers::start() {
+    int num_threads = num_parallel_threads;
+    if (num_threads < 1) {
+        num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    num_threads = std::max(1, num_threads);
+
+    parent_ = vm;
+    ranges_.reset(new Range[num_threads]);
+    for (int i = 0; i + 1 < num_threads; i++) {
+        threads_.emplace_back(&Workers::thread_main, this, i, generation_);
+    }
+    started_ = true;
+}
+
+// point the buffers and the user variables of the worker VM to its area,
+// and copy the dictionary pointers of the caller
+void Workers::attach(size_t worker) {
+    const VM& parent = *parent_;
+    char* area = mem_char_ptr(areas_ + worker * area_size(), area_size());
+    vm->wordbuf_data = area;
+    area += aligned(WORDBUF_SZ);
+    vm->pad_data = area;
+    area += aligned(PAD_SZ);
+    vm->number_output_data = area;
+    area += aligned(NUMBER_OUTPUT_SZ);
+    vm->tib_data = area;
+    vm->user = reinterpret_cast<User*>(mem_char_ptr(
+                   areas_ + worker * area_size() + area_user_offset()));
+
+    vm->wordbuf.init();
+    vm->pad.init();
+    vm->number_output.init();
+    vm->input.init();
+    vm->tasks.init();
+
+    vm->precision = parent.precision;
+    vm->dict_lo_mem = parent.dict_lo_mem;
+    vm->dict_hi_mem = parent.dict_hi_mem;
+    vm->heap_lo_mem = parent.heap_lo_mem;
+    vm->heap_hi_mem = parent.heap_hi_mem;
+    vm->latest_word = parent.latest_word;
+    vm->wordlists = parent.wordlists;
+    vm->search_order = parent.search_order;
+    vm->definitions_wid = parent.definitions_wid;
+    vm->here = parent.here;
+    vm->names = parent.names;
+    vm->heap.share(parent.heap);
+    vm->recognizers = parent.recognizers;
+    vm->callbacks = parent.callbacks;
+
+    vm->ip = 0;
+    vm->stack.clear();
+    vm->r_stack.clear();
+    vm->loop_stack.clear();
+    vm->except_stack.clear();
+    vm->f_stack.clear();
+    vm->locals.clear();
+}
+
+// run chunks of the range of part, then of the ranges of the others
+void Workers::work(size_t part) {
+    cell result = x0_;
+    cell error_code = catch_error([&]() {
+        if (reduce_) {
+            push(x0_);
+        }
+        cell lo, hi;
+        while (!cancel_.load(std::memory_order_relaxed) &&
+                next_chunk(part, lo, hi)) {
+            for (cell i = lo; i < hi; i++) {
+                push(i);
+                f_execute(xt_);
+                if (reduce_) {
+                    f_execute(combine_);
+                }
+            }
+        }
+        if (reduce_) {
+            result = pop();
+        }
+    });
+
+    results_[part] = result;
+    if (error_code != 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_code_ == 0) {
+            error_code_ = error_code;
+            error_message_ = vm->error_message;
+        }
+        cancel_ = true;
+    }
+}
+
+// take the next chunk of the own range, or steal the upper half of the
+// range of another thread
+bool Workers::next_chunk(size_t part, cell& lo, cell& hi) {
+    Range& own = ranges_[part];
+    {
+        std::lock_guard<std::mutex> lock(own.lock);
+        if (own.next < own.end) {
+            lo = own.next;
+            hi = (own.end - lo > grain_) ? lo + grain_ : own.end;
+            own.next = hi;
+            return true;
+        }
+    }
+
+    size_t num_parts = results_.size();
+    for (size_t i = 1; i < num_parts; i++) {
+        Range& victim = ranges_[(part + i) % num_parts];
+        cell next, end;
+        {
+            std::lock_guard<std::mutex> lock(victim.lock);
+            cell left = victim.end - victim.next;
+            if (left <= 0) {
+                continue;
+            }
+            next = victim.next + left / 2;
+            end = victim.end;
+            victim.end = next;
+        }
+
+        lo = next;
+        hi = (end - lo > grain_) ? lo + grain_ : end;
+        std::lock_guard<std::mutex> lock(own.lock);
+        own.next = hi;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
+
+void Workers::thread_main(size_t worker, ucell generation) {
+    VM worker_vm(*parent_);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        start_.wait(lock, [&]() {
+            return quit_ || generation_ != generation;
+        });
+        if (quit_) {
+            break;
+        }
+        generation = generation_;
+        lock.unlock();
+
+        attach(worker);
+        work(worker + 1);
+        vm->heap.flush();
+        vm->out.flush();
+
+        lock.lock();
+        if (--num_running_ == 0) {
+            done_.notify_one();
+        }
+    }
+}
+
+void f_parallel_for() {
+    cell hi = pop();
+    cell lo = pop();
+    ucell xt = pop();
+    vm->workers.for_each(xt, lo, hi);
+}
+
+void f_parallel_reduce() {
+    cell hi = pop();
+    cell lo = pop();
+    ucell combine = pop();
+    ucell xt = pop();
+    cell x0 = pop();
+    push(vm->workers.reduce(xt, combine, x0, lo, hi));
+}
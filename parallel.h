@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "forth.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct VM;
+
+// number of threads that run PARALLEL-FOR, including the caller; 0 uses
+// one per processor; read when a VM starts its workers
+void set_parallel_threads(int num_threads);
+
+// pool of threads that run the iterations of PARALLEL-FOR and
+// PARALLEL-REDUCE together with the caller; each thread has a VM that
+// shares the memory and the dictionary of the caller, with its own stacks,
+// buffers and user variables; the index range is split among the threads
+// and a thread that runs out of work steals half of the range of another
+class Workers {
+public:
+    Workers() = default;
+    Workers(const Workers&) = delete;
+    Workers& operator=(const Workers&) = delete;
+    virtual ~Workers();
+
+    // stop the threads, started again by the next loop
+    void clear();
+
+    // loops in the VM of a worker run only in its thread
+    void set_nested() {
+        nested_ = true;
+    }
+
+    // call xt ( i -- ) for i from lo to hi-1
+    void for_each(ucell xt, cell lo, cell hi);
+
+    // call xt ( i -- x ) for i from lo to hi-1 and fold the results with
+    // combine ( x1 x2 -- x3 ), starting from x0 in each thread
+    cell reduce(ucell xt, ucell combine, cell x0, cell lo, cell hi);
+
+private:
+    // part of the index range owned by a thread
+    struct alignas(64) Range {
+        std::mutex lock;
+        cell next{ 0 };
+        cell end{ 0 };
+    };
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable start_;     // a loop started or stop threads
+    std::condition_variable done_;      // a worker finished its part
+    ucell generation_{ 0 };             // number of loops started
+    size_t num_running_{ 0 };           // workers still in the loop
+    bool quit_{ false };
+    bool started_{ false };
+    bool nested_{ false };
+    bool busy_{ false };                // a loop is running
+
+    // current loop
+    VM* parent_{ nullptr };
+    ucell xt_{ 0 };
+    ucell combine_{ 0 };
+    bool reduce_{ false };
+    cell x0_{ 0 };
+    cell grain_{ 1 };                   // iterations taken at a time
+    ucell areas_{ 0 };                  // buffers and user variables
+    std::unique_ptr<Range[]> ranges_;
+    std::vector<cell> results_;
+    std::atomic<bool> cancel_{ false };
+    cell error_code_{ 0 };
+    std::string error_message_;
+
+    cell run(ucell xt, ucell combine, bool reduce, cell x0, cell lo, cell hi);
+    void start();
+    void attach(size_t worker);
+    void work(size_t part);
+    bool next_chunk(size_t part, cell& lo, cell& hi);
+    void thread_main(size_t worker, ucell generation);
+};
+
+void f_parallel_for();
+void f_parallel_reduce();
@@ -6,8 +6,12 @@
 
 #include "errors.h"
 #include "forth.h"
+#include "optimizer.h"
 #include "parser.h"
 #include "vm.h"
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
 
 // ignore all control characters as spaces
 bool is_space(char c) {
@@ -18,8 +22,8 @@ bool is_print(char c) {
     return c >= BL && c < 0x7f;
 }
 
-static bool only_blanks(const char* str, uint size) {
-    for (uint i = 0; i < size; ++i) {
+static bool only_blanks(const char* str, ucell size) {
+    for (ucell i = 0; i < size; ++i) {
         if (!is_space(str[i])) {
             return false;
         }
@@ -27,57 +31,70 @@ static bool only_blanks(const char* str, uint size) {
     return true;
 }
 
-// return digit value of character, or -1 if not a digit
-static int char_digit(char c) {
-    if (c >= '0' && c <= '9') {
-        return c - '0';
-    }
-    else if (c >= 'A' && c <= 'Z') {
-        return c - 'A' + 10;
-    }
-    else if (c >= 'a' && c <= 'z') {
-        return c - 'a' + 10;
-    }
-    else {
-        return -1;    // not a digit
+// digit value of each character, or -1 if not a digit
+struct DigitTable {
+    signed char value[256];
+
+    constexpr DigitTable() : value() {
+        for (int c = 0; c < 256; ++c) {
+            if (c >= '0' && c <= '9') {
+                value[c] = c - '0';
+            }
+            else if (c >= 'A' && c <= 'Z') {
+                value[c] = c - 'A' + 10;
+            }
+            else if (c >= 'a' && c <= 'z') {
+                value[c] = c - 'a' + 10;
+            }
+            else {
+                value[c] = -1;
+            }
+        }
     }
+};
+
+static constexpr DigitTable digit_table;
+
+// return digit value of character, or -1 if not a digit
+static cell char_digit(char c) {
+    return digit_table.value[static_cast<uchar>(c)];
 }
 
 static void skip_blanks() {
-    const char* buffer = vm.input.buffer();
+    const char* buffer = vm->input.buffer();
 
-    while (vm.user->TO_IN < vm.user->NR_IN  && is_space(buffer[vm.user->TO_IN])) {
-        ++vm.user->TO_IN;
+    while (vm->user->TO_IN < vm->user->NR_IN  && is_space(buffer[vm->user->TO_IN])) {
+        ++vm->user->TO_IN;
     }
 }
 
-static int skip_to_delimiter(char delimiter, bool& found) {
+static cell skip_to_delimiter(char delimiter, bool& found) {
     found = false;
-    const char* buffer = vm.input.buffer();
+    const char* buffer = vm->input.buffer();
 
-    int end = vm.user->TO_IN;
+    cell end = vm->user->TO_IN;
     if (delimiter == BL) {
-        while (vm.user->TO_IN < vm.user->NR_IN && !is_space(buffer[vm.user->TO_IN])) {
-            ++vm.user->TO_IN;
+        while (vm->user->TO_IN < vm->user->NR_IN && !is_space(buffer[vm->user->TO_IN])) {
+            ++vm->user->TO_IN;
         }
 
-        end = vm.user->TO_IN;
+        end = vm->user->TO_IN;
 
-        if (vm.user->TO_IN < vm.user->NR_IN && is_space(buffer[vm.user->TO_IN])) {
+        if (vm->user->TO_IN < vm->user->NR_IN && is_space(buffer[vm->user->TO_IN])) {
             found = true;
-            ++vm.user->TO_IN;    // skip delimiter
+            ++vm->user->TO_IN;    // skip delimiter
         }
     }
     else {
-        while (vm.user->TO_IN < vm.user->NR_IN && buffer[vm.user->TO_IN] != delimiter) {
-            ++vm.user->TO_IN;
+        while (vm->user->TO_IN < vm->user->NR_IN && buffer[vm->user->TO_IN] != delimiter) {
+            ++vm->user->TO_IN;
         }
 
-        end = vm.user->TO_IN;
+        end = vm->user->TO_IN;
 
-        if (vm.user->TO_IN < vm.user->NR_IN && buffer[vm.user->TO_IN] == delimiter) {
+        if (vm->user->TO_IN < vm->user->NR_IN && buffer[vm->user->TO_IN] == delimiter) {
             found = true;
-            ++vm.user->TO_IN;    // skip delimiter
+            ++vm->user->TO_IN;    // skip delimiter
         }
 
     }
@@ -85,15 +102,15 @@ static int skip_to_delimiter(char delimiter, bool& found) {
     return end;	// end of word, char before delimiter
 }
 
-const char* parse_word(uint& size, char delimiter) {
+const char* parse_word(ucell& size, char delimiter) {
     if (delimiter == BL) {
         skip_blanks();    // skip blanks before word
     }
 
-    const char* buffer = vm.input.buffer();
-    uint start = vm.user->TO_IN;
+    const char* buffer = vm->input.buffer();
+    ucell start = vm->user->TO_IN;
     bool found;
-    uint end = skip_to_delimiter(delimiter, found);
+    ucell end = skip_to_delimiter(delimiter, found);
 
     size = end - start;
     const char* word = &buffer[start];
@@ -101,26 +118,26 @@ const char* parse_word(uint& size, char delimiter) {
 }
 
 CString* parse_cword(char delimiter) {
-    uint size = 0;
+    ucell size = 0;
     const char* word = parse_word(size, delimiter);
-    CString* cword = vm.wordbuf.append_cstring(word, size);
+    CString* cword = vm->wordbuf.append_cstring(word, size);
     return cword;
 }
 
 std::string parse_backslash_string() {
-    const char* buffer = vm.input.buffer();
+    const char* buffer = vm->input.buffer();
     std::string message;
-    for (; vm.user->TO_IN < vm.user->NR_IN; ++vm.user->TO_IN) {
-        if (buffer[vm.user->TO_IN] == '\"') {
-            ++vm.user->TO_IN;
+    for (; vm->user->TO_IN < vm->user->NR_IN; ++vm->user->TO_IN) {
+        if (buffer[vm->user->TO_IN] == '\"') {
+            ++vm->user->TO_IN;
             break;
         }
 
-        switch (buffer[vm.user->TO_IN]) {
+        switch (buffer[vm->user->TO_IN]) {
         case '\\':
-            ++vm.user->TO_IN;
-            if (vm.user->TO_IN < vm.user->NR_IN) {
-                switch (buffer[vm.user->TO_IN]) {
+            ++vm->user->TO_IN;
+            if (vm->user->TO_IN < vm->user->NR_IN) {
+                switch (buffer[vm->user->TO_IN]) {
                 case 'a':
                     message.push_back('\a');
                     break;
@@ -165,15 +182,15 @@ std::string parse_backslash_string() {
                     message.push_back('\\');
                     break;
                 case 'x':
-                    ++vm.user->TO_IN;
-                    if (vm.user->TO_IN + 1 < vm.user->NR_IN &&
-                            isxdigit(buffer[vm.user->TO_IN]) &&
-                            isxdigit(buffer[vm.user->TO_IN + 1])
+                    ++vm->user->TO_IN;
+                    if (vm->user->TO_IN + 1 < vm->user->NR_IN &&
+                            isxdigit(buffer[vm->user->TO_IN]) &&
+                            isxdigit(buffer[vm->user->TO_IN + 1])
                        ) {
-                        std::string hex_str = std::string(&buffer[vm.user->TO_IN],
-                                                          &buffer[vm.user->TO_IN + 2]);
-                        ++vm.user->TO_IN;
-                        int char_value = std::stoi(hex_str, nullptr, 16);
+                        std::string hex_str = std::string(&buffer[vm->user->TO_IN],
+                                                          &buffer[vm->user->TO_IN + 2]);
+                        ++vm->user->TO_IN;
+                        cell char_value = std::stoi(hex_str, nullptr, 16);
                         message.push_back(char_value);
                     }
                     break;
@@ -183,13 +200,13 @@ std::string parse_backslash_string() {
             }
             break;
         default:
-            message.push_back(buffer[vm.user->TO_IN]);
+            message.push_back(buffer[vm->user->TO_IN]);
         }
     }
     return message;
 }
 
-static bool parse_sign(const char*& p, const char* end, int& sign) {
+static bool parse_sign(const char*& p, const char* end, cell& sign) {
     bool found_sign = false;
     while (p < end) {
         switch (*p) {
@@ -210,11 +227,11 @@ static bool parse_sign(const char*& p, const char* end, int& sign) {
     return found_sign;
 }
 
-static int parse_digits(const char*& p, const char* end, int base,
+static cell parse_digits(const char*& p, const char* end, cell base,
                         dint& value) {
-    int num_digits = 0;
+    cell num_digits = 0;
     while (p < end) {
-        int digit = char_digit(*p);
+        cell digit = char_digit(*p);
         if (digit >= 0 && digit < base) {
             ++p;
             ++num_digits;
@@ -229,7 +246,7 @@ static int parse_digits(const char*& p, const char* end, int base,
 }
 
 bool parse_number(const std::string& text, bool& is_double, dint& value) {
-    return parse_number(text.c_str(), static_cast<uint>(text.size()), is_double,
+    return parse_number(text.c_str(), static_cast<ucell>(text.size()), is_double,
                         value);
 }
 
@@ -238,13 +255,13 @@ bool parse_number(const std::string& text, bool& is_double, dint& value) {
 // skip punctuation ( , . + - / : )
 // if punctuation found, set DPL to number of digits after last punctuation, return double cell
 // return true if ok, false if error
-bool parse_number(const char* text, uint size, bool& is_double, dint& value) {
+bool parse_number(const char* text, ucell size, bool& is_double, dint& value) {
     static const std::string punctuation = ",.+-/:";
 
     // init output vars
-    int sign = 1;
-    int base = vm.user->BASE;
-    vm.user->DPL = 0;
+    cell sign = 1;
+    cell base = vm->user->BASE;
+    vm->user->DPL = 0;
     const char* p = text;
     const char* end = text + size;
     is_double = false;
@@ -283,19 +300,29 @@ bool parse_number(const char* text, uint size, bool& is_double, dint& value) {
     // check sign after number prefix
     parse_sign(p, end, sign);
 
+    // plain digits, the common case, fit in 64 bits
+    if (p < end && base >= 2 && base <= 36) {
+        uint64_t digits = 0;
+        auto res = std::from_chars(p, end, digits, static_cast<int>(base));
+        if (res.ec == std::errc() && res.ptr == end) {
+            value = sign * static_cast<dint>(digits);
+            return true;
+        }
+    }
+
     // collect digits
     bool found_digits = false;
     while (p < end) {
-        int num_digits = parse_digits(p, end, base, value);
+        cell num_digits = parse_digits(p, end, base, value);
         if (num_digits > 0) {
             found_digits = true;
             if (is_double) {
-                vm.user->DPL += num_digits;
+                vm->user->DPL += num_digits;
             }
         }
         else if (punctuation.find(*p) != std::string::npos) {
             ++p;
-            vm.user->DPL = 0;
+            vm->user->DPL = 0;
             is_double = true;
         }
         else {
@@ -311,31 +338,120 @@ bool parse_number(const char* text, uint size, bool& is_double, dint& value) {
     return true;
 }
 
+// cheap test for tokens that look like integers: digits in BASE after
+// optional signs and base prefix, and no sign after the first digit, so
+// that they cannot be parsed as floats with an exponent
+bool is_number_led(const char* text, ucell size) {
+    const char* p = text;
+    const char* end = text + size;
+    cell base = vm->user->BASE;
+
+    while (p < end && (*p == '-' || *p == '+')) {
+        ++p;
+    }
+    if (p < end) {
+        switch (*p) {
+        case '#':
+            base = 10;
+            p++;
+            break;
+        case '$':
+            base = 16;
+            p++;
+            break;
+        case '%':
+            base = 2;
+            p++;
+            break;
+        }
+    }
+    while (p < end && (*p == '-' || *p == '+')) {
+        ++p;
+    }
+
+    cell digit = p < end ? char_digit(*p) : -1;
+    if (digit < 0 || digit >= base) {
+        return false;
+    }
+    return memchr(p, '-', end - p) == nullptr &&
+           memchr(p, '+', end - p) == nullptr;
+}
+
+// convert the sign, mantissa and exponent collected by parse_float; values
+// out of range are converted by strtod to infinity, zero or a denormal
+static double convert_float(cell sign, const char* start_mantissa,
+                            const char* end_mantissa, cell exp_sign,
+                            const char* start_exponent, const char* end_exponent) {
+    // sign, mantissa, 'e', exponent sign, exponent and null terminator
+    ucell mantissa_size = static_cast<ucell>(end_mantissa - start_mantissa);
+    ucell exponent_size = static_cast<ucell>(end_exponent - start_exponent);
+    ucell size = mantissa_size + exponent_size + 4;
+
+    char buffer[64];
+    std::string long_buffer;
+    char* first = buffer;
+    if (size > sizeof(buffer)) {
+        long_buffer.resize(size);
+        first = &long_buffer[0];
+    }
+
+    char* p = first;
+    if (sign < 0) {
+        *p++ = '-';
+    }
+    memcpy(p, start_mantissa, mantissa_size);
+    p += mantissa_size;
+    if (exponent_size > 0) {
+        *p++ = 'e';
+        if (exp_sign < 0) {
+            *p++ = '-';
+        }
+        memcpy(p, start_exponent, exponent_size);
+        p += exponent_size;
+    }
+    *p = '\0';
+
+    double value = 0.0;
+    auto res = std::from_chars(first, p, value);
+    if (res.ec != std::errc()) {
+        value = strtod(first, nullptr);
+    }
+    return value;
+}
+
+// skip decimal digits, return the number of digits
+static cell skip_decimal_digits(const char*& p, const char* end) {
+    const char* start = p;
+    while (p < end && *p >= '0' && *p <= '9') {
+        ++p;
+    }
+    return static_cast<cell>(p - start);
+}
+
 bool parse_float(const std::string& text, double& value, bool needs_exp) {
-    return parse_float(text.c_str(), static_cast<uint>(text.size()), value,
+    return parse_float(text.c_str(), static_cast<ucell>(text.size()), value,
                        needs_exp);
 }
 
-bool parse_float(const char* text, uint size, double& value, bool needs_exp) {
+bool parse_float(const char* text, ucell size, double& value, bool needs_exp) {
     value = 0.0;
-    if (vm.user->BASE != 10) {
+    if (vm->user->BASE != 10) {
         return false;
     }
 
     const char* p = text;
     const char* end = text + size;
-    int sign = 1;
-    int exp_sign = 1;
-    dint dummy = 0;
+    cell sign = 1;
+    cell exp_sign = 1;
 
     // start with a sign, digits*, '.'?, digits*
     parse_sign(p, end, sign);
 
     const char* start_mantissa = p;
-    int num_digits = parse_digits(p, end, 10, dummy);
+    cell num_digits = skip_decimal_digits(p, end);
     if (p < end && *p == '.') {
         ++p;
-        num_digits += parse_digits(p, end, 10, dummy);
+        num_digits += skip_decimal_digits(p, end);
     }
     const char* end_mantissa = p;
 
@@ -349,13 +465,9 @@ bool parse_float(const char* text, uint size, double& value, bool needs_exp) {
     }
 
     // optional exponent 'e' 'd' or sign, digits+
-    if (p >= end) {
-        std::string number = sign < 0 ? "-" : "";
-        number += std::string(start_mantissa, end_mantissa);
-        value = std::stod(number);
-        return true;
-    }
-    else {
+    const char* start_exponent = end;
+    const char* end_exponent = end;
+    if (p < end) {
         if (toupper(*p) != 'D' && toupper(*p) != 'E' &&
                 *p != '-' && *p != '+') {
             return false;
@@ -367,48 +479,41 @@ bool parse_float(const char* text, uint size, double& value, bool needs_exp) {
 
         parse_sign(p, end, exp_sign);
 
-        const char* start_exponent = p;
-        int num_digits_exp = parse_digits(p, end, 10, dummy);
-        const char* end_exponent = p;
+        start_exponent = p;
+        skip_decimal_digits(p, end);
+        end_exponent = p;
 
         if (p < end) {
             return false;    // extra characters after number
         }
-        else {
-            std::string number = sign < 0 ? "-" : "";
-            number += std::string(start_mantissa, end_mantissa);
-            if (num_digits_exp > 0) {
-                number += "e";
-                number += exp_sign < 0 ? "-" : "";
-                number += std::string(start_exponent, end_exponent);
-            }
-            value = std::stod(number);
-            return true;
-        }
     }
+
+    value = convert_float(sign, start_mantissa, end_mantissa, exp_sign,
+                          start_exponent, end_exponent);
+    return true;
 }
 
-int f_word(char delimiter) {
+cell f_word(char delimiter) {
     CString* word = parse_cword(delimiter);
     return mem_addr(word);
 }
 
 void f_parse(char delimiter) {
-    uint size;
+    ucell size;
     const char* word = parse_word(size, delimiter);
     push(mem_addr(word));
     push(size);
 }
 
 void f_parse_name() {
-    uint size;
+    ucell size;
     const char* word = parse_word(size, BL);
     push(mem_addr(word));
     push(size);
 }
 
-int f_char(char delimiter) {
-    uint size = 0;
+cell f_char(char delimiter) {
+    ucell size = 0;
     const char* str = parse_word(size, delimiter);
     if (size == 0) {
         return 0;
@@ -419,14 +524,13 @@ int f_char(char delimiter) {
 }
 
 void f_bracket_char(char delimiter) {
-    int c = f_char(delimiter);
-    comma(xtXLITERAL);
-    comma(c);
+    cell c = f_char(delimiter);
+    compile_literal(c);
 }
 
-static int _number(bool do_error) {
-    uint size = pop();
-    uint addr = pop();
+static cell _number(bool do_error) {
+    ucell size = pop();
+    ucell addr = pop();
     dint value;
     bool is_double;
     if (parse_number(mem_char_ptr(addr, size), size, is_double, value)) {
@@ -449,7 +553,7 @@ static int _number(bool do_error) {
 }
 
 void f_number_q() {
-    int num_cells = _number(false);
+    cell num_cells = _number(false);
     push(num_cells);
 }
 
@@ -458,28 +562,29 @@ void f_number() {
 }
 
 void f_to_number() {
-    uint size = pop();
-    uint addr = pop();
+    ucell size = pop();
+    ucell addr = pop();
     udint n = (udint)dpop();
-    int digit;
-    while (size > 0 && (digit = char_digit(cfetch(addr))) >= 0
-            && digit < vm.user->BASE) {
-        n = n * vm.user->BASE + digit;
-        addr++;
-        size--;
+    cell base = vm->user->BASE;
+    const char* str = mem_char_ptr(addr, size);
+    ucell i = 0;
+    cell digit;
+    while (i < size && (digit = char_digit(str[i])) >= 0 && digit < base) {
+        n = n * base + digit;
+        i++;
     }
     dpush(n);
-    push(addr);
-    push(size);
+    push(addr + i);
+    push(size - i);
 }
 
 void f_convert() {
-    uint addr = pop() + 1;
+    ucell addr = pop() + 1;
     udint n = (udint)dpop();
-    int digit;
+    cell digit;
     while ((digit = char_digit(cfetch(addr))) >= 0 &&
-            digit < vm.user->BASE) {
-        n = n * vm.user->BASE + digit;
+            digit < vm->user->BASE) {
+        n = n * vm->user->BASE + digit;
         addr++;
     }
     dpush(n);
@@ -487,14 +592,14 @@ void f_convert() {
 }
 
 void f_open_paren() {
-    if (vm.input.source_id() != 0) {
+    if (vm->input.source_id() != 0) {
         bool found = false;
         while (!found) {
             skip_to_delimiter(')', found);
             if (found) {
                 break;
             }
-            else if (vm.input.refill()) {
+            else if (vm->input.refill()) {
                 continue;
             }
             else {
@@ -509,8 +614,8 @@ void f_open_paren() {
 }
 
 void f_backslash() {
-    if (vm.user->BLK > 0) {
-        vm.user->TO_IN = (vm.user->TO_IN + BLOCK_COLS - 1) & ~(BLOCK_COLS - 1);
+    if (vm->user->BLK > 0) {
+        vm->user->TO_IN = (vm->user->TO_IN + BLOCK_COLS - 1) & ~(BLOCK_COLS - 1);
     }
     else {
         bool found;
@@ -519,8 +624,8 @@ void f_backslash() {
 }
 
 void f_to_float() {
-    uint size = pop();
-    uint addr = pop();
+    ucell size = pop();
+    ucell addr = pop();
     const char* str = mem_char_ptr(addr, size);
     if (only_blanks(str, size)) {
         fpush(0.0);
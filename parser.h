@@ -13,21 +13,22 @@
 bool is_space(char c);
 bool is_print(char c);
 
-const char* parse_word(uint& size, char delimiter = BL);
+const char* parse_word(ucell& size, char delimiter = BL);
 CString* parse_cword(char delimiter = BL);
 std::string parse_backslash_string();
 
 bool parse_number(const std::string& text, bool& is_double, dint& value);
-bool parse_number(const char* text, uint size, bool& is_double, dint& value);
+bool parse_number(const char* text, ucell size, bool& is_double, dint& value);
+bool is_number_led(const char* text, ucell size);
 
 bool parse_float(const std::string& text, double& value, bool needs_exp);
-bool parse_float(const char* text, uint size, double& value, bool needs_exp);
+bool parse_float(const char* text, ucell size, double& value, bool needs_exp);
 
-int f_word(char delimiter);
+cell f_word(char delimiter);
 void f_parse(char delimiter);
 void f_parse_name();
 
-int f_char(char delimiter);
+cell f_char(char delimiter);
 void f_bracket_char(char delimiter);
 
 void f_number_q();
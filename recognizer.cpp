@@ -0,0 +1,303 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#include "dict.h"
+#include "errors.h"
+#include "forth.h"
+#include "optimizer.h"
+#include "output.h"
+#include "parser.h"
+#include "recognizer.h"
+#include "vm.h"
+#include <iostream>
+
+static ucell create_rectype(ucell int_xt, ucell comp_xt, ucell post_xt) {
+    align();
+    ucell rectype = vm->here;
+    comma(int_xt);
+    comma(comp_xt);
+    comma(post_xt);
+    return rectype;
+}
+
+// the tables of the built-in types are allotted after the built-in words
+void Recognizers::init() {
+    rectype_null_ = create_rectype(xtXREC_NULL, xtXREC_NULL, xtXREC_NULL);
+    rectype_name_ = create_rectype(xtXREC_NAME_INT, xtXREC_NAME_COMP,
+                                   xtXREC_NAME_POST);
+    rectype_num_ = create_rectype(xtXREC_NOOP, xtLITERAL, xtXREC_NUM_POST);
+    rectype_dnum_ = create_rectype(xtXREC_NOOP, xtTWO_LITERAL,
+                                   xtXREC_DNUM_POST);
+    rectype_float_ = create_rectype(xtXREC_NOOP, xtFLITERAL,
+                                    xtXREC_FLOAT_POST);
+    set_default();
+}
+
+void Recognizers::set_default() {
+    set_stack({ xtREC_NUMBER, xtREC_FLOAT, xtREC_NAME });
+}
+
+void Recognizers::set_stack(const std::vector<ucell>& stack) {
+    stack_ = stack;
+    is_default_ = stack_.size() == 3 &&
+                  stack_[0] == xtREC_NUMBER &&
+                  stack_[1] == xtREC_FLOAT &&
+                  stack_[2] == xtREC_NAME;
+}
+
+ucell Recognizers::recognize(const char* word, ucell size) {
+    // tokens that look like integers are parsed before trying floats, and
+    // the name filter rules out most of them without walking the wordlists
+    if (is_default_ && is_number_led(word, size)) {
+        ucell rectype = rec_name(word, size);
+        if (rectype == rectype_null_) {
+            rectype = rec_number(word, size);
+        }
+        if (rectype == rectype_null_) {
+            rectype = rec_float(word, size);
+        }
+        return rectype;
+    }
+
+    for (auto it = stack_.rbegin(); it != stack_.rend(); ++it) {
+        ucell rectype = recognize(*it, word, size);
+        if (rectype != rectype_null_) {
+            return rectype;
+        }
+    }
+    return rectype_null_;
+}
+
+// call the built-in recognizers directly
+ucell Recognizers::recognize(ucell rec_xt, const char* word, ucell size) {
+    if (rec_xt == xtREC_NAME) {
+        return rec_name(word, size);
+    }
+    else if (rec_xt == xtREC_NUMBER) {
+        return rec_number(word, size);
+    }
+    else if (rec_xt == xtREC_FLOAT) {
+        return rec_float(word, size);
+    }
+    else {
+        // the token may not be in the VM memory
+        CString* str = vm->wordbuf.append_cstring(word, size);
+        push(mem_addr(str->str()));
+        push(size);
+        f_execute(rec_xt);
+        return pop();
+    }
+}
+
+void Recognizers::interpret(const char* word, ucell size) {
+    ucell rectype = recognize(word, size);
+    bool interpreting = vm->user->STATE == STATE_INTERPRET;
+
+    if (rectype == rectype_null_) {
+        error(Error::UndefinedWord, std::string(word, word + size));
+    }
+    else if (rectype == rectype_name_) {
+        if (interpreting) {
+            f_xrec_name_int();
+        }
+        else {
+            f_xrec_name_comp();
+        }
+    }
+    else if (rectype == rectype_num_) {
+        if (!interpreting) {
+            compile_literal(pop());
+        }
+        else if (vm->user->TRACE) {
+            vm->out << ">>" << BL << peek() << BL;
+            vm->stack.print_debug(vm->out);
+            vm->out << std::endl;
+        }
+    }
+    else if (rectype == rectype_dnum_) {
+        if (!interpreting) {
+            comma(xtX2LITERAL);
+            dcomma(dpop());
+        }
+        else if (vm->user->TRACE) {
+            vm->out << ">>" << BL << number_to_string(dpeek());
+            vm->stack.print_debug(vm->out);
+            vm->out << std::endl;
+        }
+    }
+    else if (rectype == rectype_float_) {
+        if (!interpreting) {
+            comma(xtXFLITERAL);
+            fcomma(fpop());
+        }
+        else if (vm->user->TRACE) {
+            vm->out << ">>" << BL << fpeek() << BL;
+            vm->f_stack.print_debug(vm->out);
+            vm->out << std::endl;
+        }
+    }
+    else {
+        ucell field = interpreting ? RECTYPE_INT : RECTYPE_COMP;
+        f_execute(fetch(rectype + field * CELL_SZ));
+    }
+}
+
+void Recognizers::postpone(const char* word, ucell size) {
+    ucell rectype = recognize(word, size);
+    if (rectype == rectype_null_) {
+        error(Error::UndefinedWord, std::string(word, word + size));
+    }
+    else {
+        f_execute(fetch(rectype + RECTYPE_POST * CELL_SZ));
+    }
+}
+
+ucell rec_name(const char* word, ucell size) {
+    Header* header = vm->dict.find_word(word, size);
+    if (header == nullptr) {
+        return vm->recognizers.rectype_null();
+    }
+    else {
+        push(header->xt());
+        push(header->flags.immediate ? 1 : -1);
+        return vm->recognizers.rectype_name();
+    }
+}
+
+ucell rec_number(const char* word, ucell size) {
+    bool is_double = false;
+    dint value = 0;
+    if (!parse_number(word, size, is_double, value)) {
+        return vm->recognizers.rectype_null();
+    }
+    else if (is_double) {
+        dpush(value);
+        return vm->recognizers.rectype_dnum();
+    }
+    else {
+        push(dcell_lo(value));
+        return vm->recognizers.rectype_num();
+    }
+}
+
+ucell rec_float(const char* word, ucell size) {
+    double value = 0.0;
+    if (!parse_float(word, size, value, true)) {
+        return vm->recognizers.rectype_null();
+    }
+    else {
+        fpush(value);
+        return vm->recognizers.rectype_float();
+    }
+}
+
+void f_xrec_null() {
+    error(Error::UndefinedWord);
+}
+
+void f_xrec_name_int() {
+    pop();
+    f_execute(pop());
+}
+
+void f_xrec_name_comp() {
+    cell flag = pop();
+    ucell xt = pop();
+    if (flag > 0) {
+        f_execute(xt);
+    }
+    else {
+        compile_xt(xt);
+    }
+}
+
+// same code as POSTPONE name
+void f_xrec_name_post() {
+    cell flag = pop();
+    ucell xt = pop();
+    if (flag > 0) {
+        comma(xt);
+    }
+    else {
+        comma(xtXLITERAL);
+        comma(xt);
+        comma(xtCOMMA);
+    }
+}
+
+void f_xrec_num_post() {
+    comma(xtXLITERAL);
+    comma(pop());
+    comma(xtLITERAL);
+}
+
+void f_xrec_dnum_post() {
+    comma(xtX2LITERAL);
+    dcomma(dpop());
+    comma(xtTWO_LITERAL);
+}
+
+void f_xrec_float_post() {
+    comma(xtXFLITERAL);
+    fcomma(fpop());
+    comma(xtFLITERAL);
+}
+
+static void call_recognizer(ucell (*rec)(const char* word, ucell size)) {
+    ucell size = pop();
+    ucell addr = pop();
+    push(rec(mem_char_ptr(addr, size), size));
+}
+
+void f_rec_name() {
+    call_recognizer(rec_name);
+}
+
+void f_rec_number() {
+    call_recognizer(rec_number);
+}
+
+void f_rec_float() {
+    call_recognizer(rec_float);
+}
+
+void f_rectype_colon() {
+    vm->dict.parse_create(idXDOVAR, 0);
+    ucell post_xt = pop();
+    ucell comp_xt = pop();
+    ucell int_xt = pop();
+    comma(int_xt);
+    comma(comp_xt);
+    comma(post_xt);
+}
+
+void f_recognize() {
+    ucell size = pop();
+    ucell addr = pop();
+    push(vm->recognizers.recognize(mem_char_ptr(addr, size), size));
+}
+
+void f_get_recognizers() {
+    const std::vector<ucell>& stack = vm->recognizers.stack();
+    for (ucell xt : stack) {
+        push(xt);
+    }
+    push(static_cast<ucell>(stack.size()));
+}
+
+void f_set_recognizers() {
+    cell n = pop();
+    if (n < 0) {
+        vm->recognizers.set_default();
+    }
+    else {
+        std::vector<ucell> stack(n);
+        for (cell i = n - 1; i >= 0; --i) {
+            stack[i] = pop();
+        }
+        vm->recognizers.set_stack(stack);
+    }
+}
@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "forth.h"
+#include <vector>
+
+// a recognizer is a word ( c-addr u -- i*x rectype ) that converts a token
+// into data; the rectype is the address of three xts that interpret,
+// compile and postpone that data, RECTYPE-NULL if the token was not
+// recognized
+enum { RECTYPE_INT, RECTYPE_COMP, RECTYPE_POST, RECTYPE_CELLS };
+
+class Recognizers {
+public:
+    void init();
+    void set_default();
+
+    ucell rectype_null() const { return rectype_null_; }
+    ucell rectype_name() const { return rectype_name_; }
+    ucell rectype_num() const { return rectype_num_; }
+    ucell rectype_dnum() const { return rectype_dnum_; }
+    ucell rectype_float() const { return rectype_float_; }
+
+    // recognizer stack, the last one is tried first
+    const std::vector<ucell>& stack() const { return stack_; }
+    void set_stack(const std::vector<ucell>& stack);
+
+    // run the recognizers, leave the data on the stacks, return the rectype
+    ucell recognize(const char* word, ucell size);
+
+    // interpret or compile the token depending on STATE
+    void interpret(const char* word, ucell size);
+
+    // compile the compilation semantics of the token
+    void postpone(const char* word, ucell size);
+
+private:
+    std::vector<ucell> stack_;
+    bool is_default_{ false };      // REC-NUMBER REC-FLOAT REC-NAME
+    ucell rectype_null_{ 0 };
+    ucell rectype_name_{ 0 };
+    ucell rectype_num_{ 0 };
+    ucell rectype_dnum_{ 0 };
+    ucell rectype_float_{ 0 };
+
+    ucell recognize(ucell rec_xt, const char* word, ucell size);
+};
+
+// built-in recognizers
+ucell rec_name(const char* word, ucell size);
+ucell rec_number(const char* word, ucell size);
+ucell rec_float(const char* word, ucell size);
+
+// built-in translations
+void f_xrec_null();
+void f_xrec_name_int();
+void f_xrec_name_comp();
+void f_xrec_name_post();
+void f_xrec_num_post();
+void f_xrec_dnum_post();
+void f_xrec_float_post();
+
+void f_rec_name();
+void f_rec_number();
+void f_rec_float();
+void f_rectype_colon();
+void f_recognize();
+void f_get_recognizers();
+void f_set_recognizers();
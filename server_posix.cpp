@@ -0,0 +1,155 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#include "libforth.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <algorithm>
+#include <csignal>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// the request is all the client writes before shutting down its side
+static bool read_request(int fd, std::string& text) {
+    char buffer[4096];
+    while (true) {
+        ssize_t size = read(fd, buffer, sizeof(buffer));
+        if (size > 0) {
+            text.append(buffer, size);
+        }
+        else if (size == 0) {
+            return true;
+        }
+        else if (errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+static void write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written > 0) {
+            data += written;
+            size -= written;
+        }
+        else if (written < 0 && errno != EINTR) {
+            return;
+        }
+    }
+}
+
+static std::string response(ForthVM* vm, int status) {
+    std::ostringstream oss;
+    oss << "status: " << status << "\n";
+    if (status != 0) {
+        oss << "message: " << forth_error_message(vm) << "\n";
+    }
+
+    std::vector<forth_cell> cells(forth_depth(vm));
+    for (auto it = cells.rbegin(); it != cells.rend(); ++it) {
+        *it = forth_pop(vm);
+    }
+    oss << "stack:";
+    for (forth_cell value : cells) {
+        oss << ' ' << value;
+    }
+    oss << "\n";
+
+    std::vector<double> floats(forth_fdepth(vm));
+    for (auto it = floats.rbegin(); it != floats.rend(); ++it) {
+        *it = forth_fpop(vm);
+    }
+    oss << "fstack:" << std::setprecision(17);
+    for (double value : floats) {
+        oss << ' ' << value;
+    }
+    oss << "\n\n";
+
+    size_t size = 0;
+    const char* output = forth_output(vm, &size);
+    oss.write(output, size);
+    return oss.str();
+}
+
+static void serve_requests(int listen_fd, const ForthSnapshot* snapshot) {
+    ForthVM* vm = forth_create();
+    forth_capture_output(vm, 1);
+    while (true) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+
+        std::string text;
+        if (read_request(fd, text)) {
+            forth_restore_snapshot(vm, snapshot);
+            forth_clear_output(vm);
+            int status = forth_evaluate(vm, text.c_str());
+            std::string reply = response(vm, status);
+            write_all(fd, reply.data(), reply.size());
+        }
+        close(fd);
+    }
+    forth_destroy(vm);
+}
+
+int forth_serve(ForthVM* vm, const char* socket_path, int num_workers) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        std::cerr << "Error: socket path too long: " << socket_path << std::endl;
+        return -1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        std::cerr << "Error: socket: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    unlink(socket_path);
+    if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            listen(listen_fd, SOMAXCONN) < 0) {
+        std::cerr << "Error: " << socket_path << ": " << strerror(errno) << std::endl;
+        close(listen_fd);
+        return -1;
+    }
+
+    // a client that goes away must not end the server
+    signal(SIGPIPE, SIG_IGN);
+
+    if (num_workers < 1) {
+        num_workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    ForthSnapshot* snapshot = forth_save_snapshot(vm);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < num_workers; i++) {
+        workers.emplace_back(serve_requests, listen_fd, snapshot);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    forth_free_snapshot(snapshot);
+    close(listen_fd);
+    return 0;
+}
+
+#endif
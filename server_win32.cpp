@@ -0,0 +1,20 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#include "libforth.h"
+
+#ifdef _WIN32
+#include <iostream>
+
+int forth_serve(ForthVM* vm, const char* socket_path, int num_workers) {
+    (void)vm;
+    (void)num_workers;
+    std::cerr << "Error: " << socket_path
+              << ": Unix domain sockets are not supported" << std::endl;
+    return -1;
+}
+
+#endif
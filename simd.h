@@ -0,0 +1,21 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+// x86 SIMD kernels are compiled with per-function target attributes and
+// selected at runtime, other compilers and CPUs use the scalar code
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86
+#include <immintrin.h>
+#endif
+
+enum class SimdLevel {
+    Scalar, SSE2, AVX2
+};
+
+// best instruction set supported by the CPU
+SimdLevel simd_level();
@@ -8,9 +8,10 @@
 
 #include "errors.h"
 #include "forth.h"
-#include <iostream>
+#include <ostream>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 template<typename T>
@@ -26,15 +27,21 @@ public:
         sp_ = 0;    // keep the data for catch
     }
 
-    uint size() const {
-        return static_cast<uint>(sp_);
+    ucell size() const {
+        return static_cast<ucell>(sp_);
     }
 
     bool empty() const {
         return sp_ == 0;
     }
 
-    void resize(uint new_size) {
+    // exchange the contents with another stack, e.g. of another task
+    void swap(Stack& other) {
+        data_.swap(other.data_);
+        std::swap(sp_, other.sp_);
+    }
+
+    void resize(ucell new_size) {
         if (new_size > data_.size()) {
             data_.resize(new_size);
         }
@@ -59,7 +66,7 @@ public:
         return value;
     }
 
-    const T& peek(uint depth = 0) const {
+    const T& peek(ucell depth = 0) const {
         static T empty{};
         if (depth >= sp_) {
             error(err_underflow_);
@@ -71,7 +78,18 @@ public:
         }
     }
 
-    void poke(uint depth, const T& value) {
+    T& top() {
+        static T empty{};
+        if (sp_ == 0) {
+            error(err_underflow_);
+            return empty;
+        }
+        else {
+            return data_[sp_ - 1];
+        }
+    }
+
+    void poke(ucell depth, const T& value) {
         if (depth >= sp_) {
             error(err_underflow_);
         }
@@ -81,7 +99,7 @@ public:
         }
     }
 
-    void roll(uint depth) {
+    void roll(ucell depth) {
         if (depth >= sp_) {
             error(err_underflow_);
         }
@@ -98,28 +116,28 @@ public:
         }
     }
 
-    void print() const {
-        std::cout << "(";
+    void print(std::ostream& out) const {
+        out << "(";
         if (prefix_ != '\0') {
-            std::cout << prefix_ << ":";
+            out << prefix_ << ":";
         }
-        std::cout << BL;
-        for (uint i = 0; i < sp_; ++i) {
+        out << BL;
+        for (ucell i = 0; i < sp_; ++i) {
             print_number(data_[i]);
         }
-        std::cout << ") ";
+        out << ") ";
     }
 
-    void print_debug() const {
-        std::cout << "(";
+    void print_debug(std::ostream& out) const {
+        out << "(";
         if (prefix_ != '\0') {
-            std::cout << prefix_ << ":";
+            out << prefix_ << ":";
         }
-        std::cout << BL;
-        for (uint i = 0; i < sp_; ++i) {
-            std::cout << data_[i] << BL;
+        out << BL;
+        for (ucell i = 0; i < sp_; ++i) {
+            out << data_[i] << BL;
         }
-        std::cout << ") ";
+        out << ") ";
     }
 
 private:
@@ -11,7 +11,7 @@
 #include <algorithm>
 #include <cstring>
 
-uint CString::size() const {
+ucell CString::size() const {
     return size_;
 }
 
@@ -23,7 +23,7 @@ std::string CString::to_string() const {
     return std::string(str_, str_ + size_);
 }
 
-uint CString::alloc_size(uint num_chars) {
+ucell CString::alloc_size(ucell num_chars) {
     if (num_chars > MAX_CSTRING_SZ) {
         error(Error::ParsedStringOverflow, std::to_string(num_chars));
     }
@@ -31,7 +31,7 @@ uint CString::alloc_size(uint num_chars) {
     return aligned(1 + num_chars + 1); // count + chars + BL after string
 }
 
-void CString::set_cstring(const char* str, uint size) {
+void CString::set_cstring(const char* str, ucell size) {
     if (size > MAX_CSTRING_SZ) {
         error(Error::ParsedStringOverflow, std::string(str, str + size));
     }
@@ -42,14 +42,14 @@ void CString::set_cstring(const char* str, uint size) {
 }
 
 void CString::set_cstring(const std::string& str) {
-    set_cstring(str.c_str(), static_cast<uint>(str.size()));
+    set_cstring(str.c_str(), static_cast<ucell>(str.size()));
 }
 
 std::string LongString::to_string() const {
     return std::string(str_, str_ + size_);
 }
 
-uint LongString::alloc_size(uint num_chars) {
+ucell LongString::alloc_size(ucell num_chars) {
     if (num_chars > BUFFER_SZ) {
         error(Error::InputBufferOverflow, std::to_string(num_chars));
     }
@@ -58,7 +58,7 @@ uint LongString::alloc_size(uint num_chars) {
                    1); // count + chars + BL after string
 }
 
-void LongString::set_string(const char* str, uint size) {
+void LongString::set_string(const char* str, ucell size) {
     if (size > BUFFER_SZ) {
         error(Error::InputBufferOverflow, std::string(str, str + size));
     }
@@ -69,29 +69,29 @@ void LongString::set_string(const char* str, uint size) {
 }
 
 void LongString::set_string(const std::string& str) {
-    set_string(str.c_str(), static_cast<uint>(str.size()));
+    set_string(str.c_str(), static_cast<ucell>(str.size()));
 }
 
 void Wordbuf::init() {
-    memset(vm.wordbuf_data, BL, WORDBUF_SZ);
-    vm.wordbuf_ptr = 0;
+    memset(vm->wordbuf_data, BL, WORDBUF_SZ);
+    vm->wordbuf_ptr = 0;
 }
 
 CString* Wordbuf::append_cstring(const std::string& str) {
-    return append_cstring(str.c_str(), static_cast<uint>(str.size()));
+    return append_cstring(str.c_str(), static_cast<ucell>(str.size()));
 }
 
-CString* Wordbuf::append_cstring(const char* str, uint size) {
+CString* Wordbuf::append_cstring(const char* str, ucell size) {
     if (size > MAX_CSTRING_SZ) {
         error(Error::ParsedStringOverflow, std::string(str, str + size));
     }
 
-    uint alloc_size = CString::alloc_size(size);
-    if (vm.wordbuf_ptr + alloc_size > WORDBUF_SZ) {
-        vm.wordbuf_ptr = 0;
+    ucell alloc_size = CString::alloc_size(size);
+    if (vm->wordbuf_ptr + alloc_size > WORDBUF_SZ) {
+        vm->wordbuf_ptr = 0;
     }
-    CString* cstring = reinterpret_cast<CString*>(vm.wordbuf_data + vm.wordbuf_ptr);
-    vm.wordbuf_ptr += alloc_size;
+    CString* cstring = reinterpret_cast<CString*>(vm->wordbuf_data + vm->wordbuf_ptr);
+    vm->wordbuf_ptr += alloc_size;
 
     cstring->set_cstring(str, size);
 
@@ -99,47 +99,35 @@ CString* Wordbuf::append_cstring(const char* str, uint size) {
 }
 
 LongString* Wordbuf::append_long_string(const std::string& str) {
-    return append_long_string(str.c_str(), static_cast<uint>(str.size()));
+    return append_long_string(str.c_str(), static_cast<ucell>(str.size()));
 }
 
-LongString* Wordbuf::append_long_string(const char* str, uint size) {
+LongString* Wordbuf::append_long_string(const char* str, ucell size) {
     if (size > BUFFER_SZ) {
         error(Error::InputBufferOverflow, std::string(str, str + size));
     }
 
-    uint alloc_size = LongString::alloc_size(size);
-    if (vm.wordbuf_ptr + alloc_size > WORDBUF_SZ) {
-        vm.wordbuf_ptr = 0;
+    ucell alloc_size = LongString::alloc_size(size);
+    if (vm->wordbuf_ptr + alloc_size > WORDBUF_SZ) {
+        vm->wordbuf_ptr = 0;
     }
     LongString* lstring = reinterpret_cast<LongString*>(
-                              vm.wordbuf_data + vm.wordbuf_ptr);
-    vm.wordbuf_ptr += alloc_size;
+                              vm->wordbuf_data + vm->wordbuf_ptr);
+    vm->wordbuf_ptr += alloc_size;
 
     lstring->set_string(str, size);
 
     return lstring;
 }
 
-static char to_lower(char c) {
-    return tolower(static_cast<unsigned char>(c));
-}
-
 bool case_insensitive_equal(const std::string& a, const std::string& b) {
-    return case_insensitive_equal(a.c_str(), static_cast<uint>(a.size()),
-                                  b.c_str(), static_cast<uint>(b.size()));
+    return case_insensitive_equal(a.c_str(), static_cast<ucell>(a.size()),
+                                  b.c_str(), static_cast<ucell>(b.size()));
 }
 
-bool case_insensitive_equal(const char* a_str, uint a_size, const char* b_str,
-                            uint b_size) {
-    if (a_size != b_size) {
-        return false;
-    }
-    for (uint i = 0; i < a_size; ++i) {
-        if (to_lower(a_str[i]) != to_lower(b_str[i])) {
-            return false;
-        }
-    }
-    return true;
+bool case_insensitive_equal(const char* a_str, ucell a_size, const char* b_str,
+                            ucell b_size) {
+    return a_size == b_size && mismatch(a_str, b_str, a_size, true) == a_size;
 }
 
 std::string to_upper(const std::string& str) {
@@ -149,17 +137,17 @@ std::string to_upper(const std::string& str) {
 }
 
 void f_count() {
-    uint addr = pop();
-    int len = cfetch(addr++);
+    ucell addr = pop();
+    cell len = cfetch(addr++);
     push(addr);
     push(len);
 }
 
 void f_dot_quote() {
-    uint size;
+    ucell size;
     const char* message = parse_word(size, '"');
-    if (vm.user->STATE == STATE_COMPILE) {
-        int str_addr = vm.dict.alloc_string(message, size);
+    if (vm->user->STATE == STATE_COMPILE) {
+        cell str_addr = vm->dict.alloc_string(message, size);
         comma(xtXDOT_QUOTE);
         comma(str_addr);
     }
@@ -169,23 +157,23 @@ void f_dot_quote() {
 }
 
 void f_xdot_quote() {
-    int str_addr = fetch(vm.ip);
-    vm.ip += CELL_SZ;
+    cell str_addr = fetch(vm->ip);
+    vm->ip += CELL_SZ;
     const LongString* message = reinterpret_cast<const LongString*>(mem_char_ptr(
                                     str_addr));
     print_string(message->str(), message->size());
 }
 
 void f_s_quote() {
-    uint size;
+    ucell size;
     const char* message = parse_word(size, '"');
-    if (vm.user->STATE == STATE_COMPILE) {
-        int str_addr = vm.dict.alloc_string(message, size);
+    if (vm->user->STATE == STATE_COMPILE) {
+        cell str_addr = vm->dict.alloc_string(message, size);
         comma(xtXSLITERAL);
         comma(str_addr);
     }
     else {
-        LongString* lstring = vm.wordbuf.append_long_string(message, size);
+        LongString* lstring = vm->wordbuf.append_long_string(message, size);
         push(mem_addr(lstring->str()));
         push(lstring->size());
     }
@@ -193,22 +181,22 @@ void f_s_quote() {
 
 void f_s_backslash_quote() {
     std::string message = parse_backslash_string();
-    if (vm.user->STATE == STATE_COMPILE) {
-        int str_addr = vm.dict.alloc_string(message.c_str(),
-                                            static_cast<uint>(message.size()));
+    if (vm->user->STATE == STATE_COMPILE) {
+        cell str_addr = vm->dict.alloc_string(message.c_str(),
+                                            static_cast<ucell>(message.size()));
         comma(xtXSLITERAL);
         comma(str_addr);
     }
     else {
-        LongString* lstring = vm.wordbuf.append_long_string(message);
+        LongString* lstring = vm->wordbuf.append_long_string(message);
         push(mem_addr(lstring->str()));
         push(lstring->size());
     }
 }
 
 void f_xsliteral() {
-    int str_addr = fetch(vm.ip);
-    vm.ip += CELL_SZ;
+    cell str_addr = fetch(vm->ip);
+    vm->ip += CELL_SZ;
     const LongString* message = reinterpret_cast<const LongString*>(mem_char_ptr(
                                     str_addr));
     push(mem_addr(message->str()));
@@ -217,8 +205,8 @@ void f_xsliteral() {
 
 void f_c_quote() {
     const CString* message = parse_cword('"');
-    if (vm.user->STATE == STATE_COMPILE) {
-        int str_addr = vm.dict.alloc_cstring(message);
+    if (vm->user->STATE == STATE_COMPILE) {
+        cell str_addr = vm->dict.alloc_cstring(message);
         comma(xtXC_QUOTE);
         comma(str_addr);
     }
@@ -228,54 +216,49 @@ void f_c_quote() {
 }
 
 void f_xc_quote() {
-    int str_addr = fetch(vm.ip);
-    vm.ip += CELL_SZ;
+    cell str_addr = fetch(vm->ip);
+    vm->ip += CELL_SZ;
     const CString* message = reinterpret_cast<const CString*>(mem_char_ptr(
                                  str_addr));
     push(mem_addr(message));
 }
 
 void f_dot_paren() {
-    uint size;
+    ucell size;
     const char* message = parse_word(size, ')');
     print_string(message, size);
 }
 
 void f_minus_trailing() {
-    uint size = pop();
-    uint addr = pop();
+    ucell size = pop();
+    ucell addr = pop();
     const char* str = mem_char_ptr(addr, size);
 
-    while (size > 0 && is_space(str[size - 1])) {
-        size--;
-    }
-
-    addr = mem_addr(str);
     push(addr);
-    push(size);
+    push(trailing_size(str, size));
 }
 
 void f_slash_string() {
-    int n = pop();
-    uint size = pop();
-    uint addr = pop();
+    cell n = pop();
+    ucell size = pop();
+    ucell addr = pop();
 
     push(addr + n);
     push(size - n);
 }
 
 void f_blank() {
-    int n = pop();
-    uint addr = pop();
+    cell n = pop();
+    ucell addr = pop();
     if (n > 0) {
         memset(mem_char_ptr(addr, n), BL, n);
     }
 }
 
 void f_cmove() {
-    int n = pop();
-    uint dst_addr = pop();
-    uint src_addr = pop();
+    cell n = pop();
+    ucell dst_addr = pop();
+    ucell src_addr = pop();
     if (n > 0) {
         const char* src = mem_char_ptr(src_addr, n);
         char* dst = mem_char_ptr(dst_addr, n);
@@ -287,9 +270,9 @@ void f_cmove() {
 }
 
 void f_cmove_to() {
-    int n = pop();
-    uint dst_addr = pop();
-    uint src_addr = pop();
+    cell n = pop();
+    ucell dst_addr = pop();
+    ucell src_addr = pop();
     if (n > 0) {
         const char* src = mem_char_ptr(src_addr, n) + n;
         char* dst = mem_char_ptr(dst_addr, n) + n;
@@ -300,95 +283,62 @@ void f_cmove_to() {
     }
 }
 
-void f_compare() {
-    uint len2 = pop();
-    uint addr2 = pop();
+static void compare(bool ignore_case) {
+    ucell len2 = pop();
+    ucell addr2 = pop();
     const char* str2 = mem_char_ptr(addr2, len2);
 
-    uint len1 = pop();
-    uint addr1 = pop();
+    ucell len1 = pop();
+    ucell addr1 = pop();
     const char* str1 = mem_char_ptr(addr1, len1);
 
-    if (len1 < len2) {
-        int cmp = memcmp(str1, str2, len1);
-        if (cmp == 0) {
-            push(-1);
-        }
-        else if (cmp < 0) {
-            push(-1);
-        }
-        else {
-            push(1);
-        }
-    }
-    else if (len1 > len2) {
-        int cmp = memcmp(str1, str2, len2);
-        if (cmp == 0) {
-            push(1);
-        }
-        else if (cmp < 0) {
-            push(-1);
-        }
-        else {
-            push(1);
-        }
-    }
-    else {
-        int cmp = memcmp(str1, str2, len1);
-        if (cmp == 0) {
-            push(0);
-        }
-        else if (cmp < 0) {
-            push(-1);
-        }
-        else {
-            push(1);
-        }
-    }
+    push(compare_strings(str1, len1, str2, len2, ignore_case));
 }
 
-void f_search() {
-    uint len2 = pop();
-    uint addr2 = pop();
+void f_compare() {
+    compare(false);
+}
+
+void f_icompare() {
+    compare(true);
+}
+
+static void search(bool ignore_case) {
+    ucell len2 = pop();
+    ucell addr2 = pop();
     const char* str2 = mem_char_ptr(addr2, len2);
-    uint len1 = pop();
-    uint addr1 = pop();
+    ucell len1 = pop();
+    ucell addr1 = pop();
     const char* str1 = mem_char_ptr(addr1, len1);
 
-    if (len2 == 0) {
-        // empty string always matches at start
-        push(addr1);          // address of match
-        push(len1);          // length of match to end
+    const char* p = search_string(str1, len1, str2, len2, ignore_case);
+    if (p != nullptr) {
+        push(mem_addr(p));                      // address of match
+        push(static_cast<cell>(str1 + len1 - p));// length of match to end
         push(F_TRUE);
     }
-    else if (len1 == 0 || len2 > len1) {
-        // empty string or str2 longer than str1 never matches
+    else {
         push(addr1);
         push(len1);
         push(F_FALSE);
     }
-    else {
-        const char* p = std::search(str1, str1 + len1, str2, str2 + len2);
-        if (p != str1 + len1) {
-            push(mem_addr(p));                      // address of match
-            push(static_cast<int>(str1 + len1 - p));// length of match to end
-            push(F_TRUE);
-        }
-        else {
-            push(addr1);
-            push(len1);
-            push(F_FALSE);
-        }
-    }
+}
+
+void f_search() {
+    search(false);
+}
+
+void f_isearch() {
+    search(true);
 }
 
 void f_sliteral() {
-    uint size = pop();
-    uint addr = pop();
+    ucell size = pop();
+    ucell addr = pop();
     const char* str = mem_char_ptr(addr, size);
 
     // save copy of the string in names space
-    uint saved_addr = vm.dict.alloc_string(str, size);
+    ucell saved_addr = vm->dict.alloc_string(str, size);
 
     // save execution code
     comma(xtXSLITERAL);
@@ -396,22 +346,22 @@ void f_sliteral() {
 }
 
 void f_replaces() {
-    uint name_len = pop();
-    uint name_addr = pop();
+    ucell name_len = pop();
+    ucell name_addr = pop();
     const char* name_str = mem_char_ptr(name_addr, name_len);
     std::string name = std::string(name_str, name_str + name_len);
 
-    uint text_len = pop();
-    uint text_addr = pop();
+    ucell text_len = pop();
+    ucell text_addr = pop();
     const char* text_str = mem_char_ptr(text_addr, text_len);
     std::string text = std::string(text_str, text_str + text_len);
 
-    vm.substitutions[to_upper(name)] = text;
+    vm->substitutions[to_upper(name)] = text;
 }
 
 static std::string substitute(const std::string& input,
                               const std::unordered_map<std::string, std::string>& substitutions,
-                              int& count) {
+                              cell& count) {
     std::string result;
     size_t pos = 0;
     count = 0;
@@ -471,42 +421,42 @@ static std::string escape_percents(const std::string& input) {
 }
 
 void f_substitute() {
-    uint buffer_len = pop();
-    uint buffer_addr = pop();
+    ucell buffer_len = pop();
+    ucell buffer_addr = pop();
     char* buffer_str = mem_char_ptr(buffer_addr, buffer_len);
 
-    uint str_len = pop();
-    uint str_addr = pop();
+    ucell str_len = pop();
+    ucell str_addr = pop();
     const char* str_str = mem_char_ptr(str_addr, str_len);
     std::string str = std::string(str_str, str_str + str_len);
 
-    int count = 0;
-    std::string result = substitute(str, vm.substitutions, count);
-    if (static_cast<uint>(result.size()) > buffer_len) {
+    cell count = 0;
+    std::string result = substitute(str, vm->substitutions, count);
+    if (static_cast<ucell>(result.size()) > buffer_len) {
         push(0);
         push(0);
-        push(static_cast<int>(Error::SubstituteException));
+        push(static_cast<cell>(Error::SubstituteException));
     }
     else {
         memcpy(buffer_str, result.c_str(), result.size());
         push(buffer_addr);
-        push(static_cast<int>(result.size()));
+        push(static_cast<cell>(result.size()));
         push(count);
     }
 }
 
 void f_unescape() {
-    uint buffer_addr = pop();
+    ucell buffer_addr = pop();
     char* buffer_str = mem_char_ptr(buffer_addr);
 
-    uint str_len = pop();
-    uint str_addr = pop();
+    ucell str_len = pop();
+    ucell str_addr = pop();
     const char* str_str = mem_char_ptr(str_addr, str_len);
     std::string str = std::string(str_str, str_str + str_len);
 
     std::string result = escape_percents(str);
     memcpy(buffer_str, result.c_str(), result.size());
     push(buffer_addr);
-    push(static_cast<int>(result.size()));
+    push(static_cast<cell>(result.size()));
 }
 
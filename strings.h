@@ -11,14 +11,14 @@
 
 class CString {
 public:
-    uint size() const;
+    ucell size() const;
     const char* str() const;
 
     std::string to_string() const;
-    static uint alloc_size(uint num_chars);
+    static ucell alloc_size(ucell num_chars);
 
     // user must allocate alloc_size() bytes
-    void set_cstring(const char* str, uint size);
+    void set_cstring(const char* str, ucell size);
     void set_cstring(const std::string& str);
 
 private:
@@ -29,7 +29,7 @@ private:
 
 class LongString {
 public:
-    uint size() const {
+    ucell size() const {
         return size_;
     }
     const char* str() const {
@@ -37,14 +37,14 @@ public:
     }
 
     std::string to_string() const;
-    static uint alloc_size(uint num_chars);
+    static ucell alloc_size(ucell num_chars);
 
     // user must allocate alloc_size() bytes
-    void set_string(const char* str, uint size);
+    void set_string(const char* str, ucell size);
     void set_string(const std::string& str);
 
 private:
-    uint size_;      // size of string
+    ucell size_;      // size of string
     char str_[1];   // flexible array member
 };
 
@@ -54,22 +54,32 @@ public:
     void init();
 
     CString* append_cstring(const std::string& str);
-    CString* append_cstring(const char* str, uint size);
+    CString* append_cstring(const char* str, ucell size);
 
     LongString* append_long_string(const std::string& str);
-    LongString* append_long_string(const char* str, uint size);
+    LongString* append_long_string(const char* str, ucell size);
 
-    // data stored in vm.wordbuf_data and pointed by vm.wordbuf_ptr
+    // data stored in vm->wordbuf_data and pointed by vm->wordbuf_ptr
 };
 
 
 bool case_insensitive_equal(const std::string& a, const std::string& b);
 bool case_insensitive_equal(
-    const char* a_str, uint a_size,
-    const char* b_str, uint b_size);
+    const char* a_str, ucell a_size,
+    const char* b_str, ucell b_size);
 
 std::string to_upper(const std::string& str);
 
+// string scanning with SIMD kernels, letters are compared folded to lower
+// case if ignore_case
+ucell mismatch(const char* a, const char* b, ucell size, bool ignore_case);
+ucell trailing_size(const char* str, ucell size);
+const char* search_string(const char* str, ucell size,
+                          const char* pattern, ucell pattern_size,
+                          bool ignore_case);
+cell compare_strings(const char* a, ucell a_size, const char* b,
+                     ucell b_size, bool ignore_case);
+
 void f_count();
 void f_dot_quote();
 void f_xdot_quote();
@@ -85,7 +95,9 @@ void f_blank();
 void f_cmove();
 void f_cmove_to();
 void f_compare();
+void f_icompare();
 void f_search();
+void f_isearch();
 void f_sliteral();
 void f_replaces();
 void f_substitute();
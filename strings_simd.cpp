@@ -0,0 +1,362 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#include "simd.h"
+#include "strings.h"
+#include <cstdint>
+#include <cstring>
+
+// needles from this size are searched with Boyer-Moore-Horspool, whose
+// skips grow with the needle
+static const ucell HORSPOOL_MIN_SIZE = 32;
+
+static uchar fold(char c) {
+    uchar u = static_cast<uchar>(c);
+    return (u >= 'A' && u <= 'Z') ? u + ('a' - 'A') : u;
+}
+
+static bool is_blank(char c) {
+    return static_cast<uchar>(c) <= BL;
+}
+
+//-----------------------------------------------------------------------------
+// scalar fallback, 8 bytes at a time in a 64-bit word
+
+static uint64_t load8(const char* p) {
+    uint64_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+// fold 'A'..'Z' to lower case in the 8 bytes of x
+static uint64_t fold8(uint64_t x) {
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t high = 0x8080808080808080ULL;
+    uint64_t low7 = x & ~high;
+    uint64_t ge_a = low7 + (0x80 - 'A') * ones;         // high bit if >= 'A'
+    uint64_t gt_z = low7 + (0x80 - 'Z' - 1) * ones;     // high bit if > 'Z'
+    uint64_t is_upper = ge_a & ~gt_z & ~x & high;
+    return x | (is_upper >> 2);
+}
+
+static ucell mismatch_scalar(const char* a, const char* b, ucell size,
+                             bool ignore_case) {
+    ucell i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t x = load8(a + i);
+        uint64_t y = load8(b + i);
+        if (ignore_case ? fold8(x) != fold8(y) : x != y) {
+            break;
+        }
+    }
+    for (; i < size; i++) {
+        if (ignore_case ? fold(a[i]) != fold(b[i]) : a[i] != b[i]) {
+            return i;
+        }
+    }
+    return size;
+}
+
+static ucell trailing_scalar(const char* str, ucell size) {
+    while (size > 0 && is_blank(str[size - 1])) {
+        size--;
+    }
+    return size;
+}
+
+static const char* search_scalar(const char* str, ucell size,
+                                 const char* pattern, ucell pattern_size,
+                                 bool ignore_case) {
+    uchar first = ignore_case ? fold(pattern[0]) : pattern[0];
+    for (ucell i = 0; i + pattern_size <= size; i++) {
+        uchar c = ignore_case ? fold(str[i]) : str[i];
+        if (c == first &&
+                mismatch_scalar(str + i + 1, pattern + 1, pattern_size - 1,
+                                ignore_case) == pattern_size - 1) {
+            return str + i;
+        }
+    }
+    return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Boyer-Moore-Horspool
+
+static const char* search_horspool(const char* str, ucell size,
+                                   const char* pattern, ucell pattern_size,
+                                   bool ignore_case) {
+    ucell skip[256];
+    for (auto& s : skip) {
+        s = pattern_size;
+    }
+    for (ucell i = 0; i + 1 < pattern_size; i++) {
+        uchar c = ignore_case ? fold(pattern[i]) : pattern[i];
+        skip[c] = pattern_size - 1 - i;
+    }
+
+    uchar last = ignore_case ? fold(pattern[pattern_size - 1])
+                 : pattern[pattern_size - 1];
+    ucell i = 0;
+    while (i + pattern_size <= size) {
+        char c_str = str[i + pattern_size - 1];
+        uchar c = ignore_case ? fold(c_str) : c_str;
+        if (c == last &&
+                mismatch_scalar(str + i, pattern, pattern_size - 1,
+                                ignore_case) == pattern_size - 1) {
+            return str + i;
+        }
+        i += skip[c];
+    }
+    return nullptr;
+}
+
+#ifdef SIMD_X86
+
+//-----------------------------------------------------------------------------
+// SSE2, 16 bytes per register
+
+__attribute__((target("sse2")))
+static __m128i fold_sse2(__m128i v) {
+    __m128i is_upper = _mm_and_si128(
+                           _mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                           _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(v, _mm_and_si128(is_upper, _mm_set1_epi8(0x20)));
+}
+
+__attribute__((target("sse2")))
+static unsigned equal_mask_sse2(const char* a, const char* b,
+                                bool ignore_case) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+    __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    if (ignore_case) {
+        x = fold_sse2(x);
+        y = fold_sse2(y);
+    }
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+}
+
+__attribute__((target("sse2")))
+static ucell mismatch_sse2(const char* a, const char* b, ucell size,
+                           bool ignore_case) {
+    ucell i = 0;
+    for (; i + 16 <= size; i += 16) {
+        unsigned diff = ~equal_mask_sse2(a + i, b + i, ignore_case) & 0xFFFF;
+        if (diff != 0) {
+            return i + __builtin_ctz(diff);
+        }
+    }
+    return i + mismatch_scalar(a + i, b + i, size - i, ignore_case);
+}
+
+__attribute__((target("sse2")))
+static ucell trailing_sse2(const char* str, ucell size) {
+    const __m128i bl = _mm_set1_epi8(BL);
+    while (size >= 16) {
+        __m128i v = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(str + size - 16));
+        __m128i blank = _mm_cmpeq_epi8(_mm_min_epu8(v, bl), v);
+        unsigned non_blank = ~_mm_movemask_epi8(blank) & 0xFFFF;
+        if (non_blank != 0) {
+            return size - 16 + (31 - __builtin_clz(non_blank)) + 1;
+        }
+        size -= 16;
+    }
+    return trailing_scalar(str, size);
+}
+
+// compare the first and last bytes of the pattern with 16 positions at
+// once, check the rest only where both match
+__attribute__((target("sse2")))
+static const char* search_sse2(const char* str, ucell size,
+                               const char* pattern, ucell pattern_size,
+                               bool ignore_case) {
+    uchar first_c = ignore_case ? fold(pattern[0]) : pattern[0];
+    uchar last_c = ignore_case ? fold(pattern[pattern_size - 1])
+                   : pattern[pattern_size - 1];
+    const __m128i first = _mm_set1_epi8(static_cast<char>(first_c));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(last_c));
+    ucell i = 0;
+    for (; i + pattern_size - 1 + 16 <= size; i += 16) {
+        __m128i block_first = _mm_loadu_si128(
+                                  reinterpret_cast<const __m128i*>(str + i));
+        __m128i block_last = _mm_loadu_si128(
+                                 reinterpret_cast<const __m128i*>(str + i + pattern_size - 1));
+        if (ignore_case) {
+            block_first = fold_sse2(block_first);
+            block_last = fold_sse2(block_last);
+        }
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                              _mm_cmpeq_epi8(block_last, last))));
+        while (mask != 0) {
+            ucell pos = i + __builtin_ctz(mask);
+            if (pattern_size <= 2 ||
+                    mismatch_sse2(str + pos + 1, pattern + 1, pattern_size - 2,
+                                  ignore_case) == pattern_size - 2) {
+                return str + pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+    const char* found = search_scalar(str + i, size - i, pattern, pattern_size,
+                                      ignore_case);
+    return found;
+}
+
+//-----------------------------------------------------------------------------
+// AVX2, 32 bytes per register
+
+__attribute__((target("avx2")))
+static __m256i fold_avx2(__m256i v) {
+    __m256i is_upper = _mm256_and_si256(
+                           _mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                           _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+    return _mm256_or_si256(v, _mm256_and_si256(is_upper,
+                           _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2")))
+static ucell mismatch_avx2(const char* a, const char* b, ucell size,
+                           bool ignore_case) {
+    ucell i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        if (ignore_case) {
+            x = fold_avx2(x);
+            y = fold_avx2(y);
+        }
+        unsigned diff = ~static_cast<unsigned>(
+                            _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+        if (diff != 0) {
+            return i + __builtin_ctz(diff);
+        }
+    }
+    return i + mismatch_sse2(a + i, b + i, size - i, ignore_case);
+}
+
+__attribute__((target("avx2")))
+static ucell trailing_avx2(const char* str, ucell size) {
+    const __m256i bl = _mm256_set1_epi8(BL);
+    while (size >= 32) {
+        __m256i v = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(str + size - 32));
+        __m256i blank = _mm256_cmpeq_epi8(_mm256_min_epu8(v, bl), v);
+        unsigned non_blank = ~static_cast<unsigned>(_mm256_movemask_epi8(blank));
+        if (non_blank != 0) {
+            return size - 32 + (31 - __builtin_clz(non_blank)) + 1;
+        }
+        size -= 32;
+    }
+    return trailing_sse2(str, size);
+}
+
+__attribute__((target("avx2")))
+static const char* search_avx2(const char* str, ucell size,
+                               const char* pattern, ucell pattern_size,
+                               bool ignore_case) {
+    uchar first_c = ignore_case ? fold(pattern[0]) : pattern[0];
+    uchar last_c = ignore_case ? fold(pattern[pattern_size - 1])
+                   : pattern[pattern_size - 1];
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(first_c));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(last_c));
+    ucell i = 0;
+    for (; i + pattern_size - 1 + 32 <= size; i += 32) {
+        __m256i block_first = _mm256_loadu_si256(
+                                  reinterpret_cast<const __m256i*>(str + i));
+        __m256i block_last = _mm256_loadu_si256(
+                                 reinterpret_cast<const __m256i*>(str + i + pattern_size - 1));
+        if (ignore_case) {
+            block_first = fold_avx2(block_first);
+            block_last = fold_avx2(block_last);
+        }
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first),
+                                 _mm256_cmpeq_epi8(block_last, last))));
+        while (mask != 0) {
+            ucell pos = i + __builtin_ctz(mask);
+            if (pattern_size <= 2 ||
+                    mismatch_avx2(str + pos + 1, pattern + 1, pattern_size - 2,
+                                  ignore_case) == pattern_size - 2) {
+                return str + pos;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return search_sse2(str + i, size - i, pattern, pattern_size, ignore_case);
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+
+ucell mismatch(const char* a, const char* b, ucell size, bool ignore_case) {
+    switch (simd_level()) {
+#ifdef SIMD_X86
+    case SimdLevel::AVX2:
+        return mismatch_avx2(a, b, size, ignore_case);
+    case SimdLevel::SSE2:
+        return mismatch_sse2(a, b, size, ignore_case);
+#endif
+    default:
+        return mismatch_scalar(a, b, size, ignore_case);
+    }
+}
+
+ucell trailing_size(const char* str, ucell size) {
+    switch (simd_level()) {
+#ifdef SIMD_X86
+    case SimdLevel::AVX2:
+        return trailing_avx2(str, size);
+    case SimdLevel::SSE2:
+        return trailing_sse2(str, size);
+#endif
+    default:
+        return trailing_scalar(str, size);
+    }
+}
+
+const char* search_string(const char* str, ucell size,
+                          const char* pattern, ucell pattern_size,
+                          bool ignore_case) {
+    if (pattern_size == 0) {
+        return str;
+    }
+    else if (pattern_size > size) {
+        return nullptr;
+    }
+    else if (pattern_size >= HORSPOOL_MIN_SIZE) {
+        return search_horspool(str, size, pattern, pattern_size, ignore_case);
+    }
+
+    switch (simd_level()) {
+#ifdef SIMD_X86
+    case SimdLevel::AVX2:
+        return search_avx2(str, size, pattern, pattern_size, ignore_case);
+    case SimdLevel::SSE2:
+        return search_sse2(str, size, pattern, pattern_size, ignore_case);
+#endif
+    default:
+        return search_scalar(str, size, pattern, pattern_size, ignore_case);
+    }
+}
+
+cell compare_strings(const char* a, ucell a_size, const char* b,
+                     ucell b_size, bool ignore_case) {
+    ucell size = a_size < b_size ? a_size : b_size;
+    ucell i = mismatch(a, b, size, ignore_case);
+    if (i < size) {
+        uchar x = ignore_case ? fold(a[i]) : a[i];
+        uchar y = ignore_case ? fold(b[i]) : b[i];
+        return x < y ? -1 : 1;
+    }
+    else if (a_size == b_size) {
+        return 0;
+    }
+    else {
+        return a_size < b_size ? -1 : 1;
+    }
+}
@@ -116,6 +116,13 @@ forth_ok(": x 10 0 DO I . I 5 = IF LEAVE THEN I 1 = IF LEAVE THEN LOOP .S ; x",
 
 forth_ok(": x 10 0 DO I . I 5 = IF UNLOOP EXIT THEN LOOP ; x", "0 1 2 3 4 5 ");
 
+forth_ok(<<'END', "0 1 2 -1 10 11 ( )");
+	: x 5 0 DO I . I 2 = THROW LOOP ;
+	' x CATCH .
+	: y 12 10 DO I . LOOP ;  y
+	.S
+END
+
 # John Hayes failing test
 forth_ok(<<'END', "( 1 0 -1 -2 -3 -4 6 )");
 VARIABLE ITERS
@@ -398,11 +398,11 @@ END
 forth_ok("MARKER x SEE x UNUSED 1024 / . 'k' EMIT CR", <<'END');
 
 MARKER x
-Latest:    36200 
-Here:      36232 
-Names:     1054120 
-Wordlists: 36200 
-993 k
+Latest:    39532 
+Here:      39624 
+Names:     1052816 
+Wordlists: 39532 
+989 k
 END
 
 note "Test TRACE";
@@ -39,4 +39,7 @@ forth_ok("$code : x ['] test CATCH ; 0 0 error ! x .S",
 forth_ok("$code : x ['] test CATCH ; 0 1 error ! x .S", 
 		"( 0 1 ) "); 
 
+note "Check THROW after a CATCH that returned normally";
+forth_nok(": x 1 ; ' x CATCH DROP 1 THROW", "\nError: 1\n");
+
 end_test;
@@ -470,6 +470,73 @@ forth_nok(<<END, "\nError: FILE-STATUS exception\n");
 S" $test.dat" FILE-STATUS THROW
 END
 
+note "Test READ-FILE-ASYNC";
+note "Test WRITE-FILE-ASYNC";
+note "Test AWAIT";
+forth_ok(<<END, "5 6 ( ) ");
+S" $test.dat" W/O CREATE-FILE THROW CONSTANT file_id
+S" hello " file_id WRITE-FILE-ASYNC
+S" world" file_id WRITE-FILE-ASYNC
+AWAIT THROW . AWAIT THROW .
+file_id CLOSE-FILE THROW .S
+END
+is path("$test.dat")->slurp, "hello world", "file written";
+
+forth_ok(<<END, "6 5 hello |world| ( ) ");
+CREATE buf1 6 ALLOT  CREATE buf2 80 ALLOT
+S" $test.dat" R/O OPEN-FILE THROW CONSTANT file_id
+buf1 6 file_id READ-FILE-ASYNC
+buf2 80 file_id READ-FILE-ASYNC
+SWAP AWAIT THROW . AWAIT THROW .
+buf1 6 TYPE '|' EMIT buf2 5 TYPE '|' EMIT SPACE
+file_id CLOSE-FILE THROW .S
+END
+
+note "Check several files in flight";
+for my $i (1..8) { path("$test.$i.dat")->spew(($i x 1000)."\n"); }
+forth_ok(<<END, "8000 ");
+8 CONSTANT n
+CREATE fids n CELLS ALLOT  CREATE reqs n CELLS ALLOT
+CREATE bufs n 1000 * ALLOT
+: fname ( i -- addr u ) >R S" $test.x.dat" 2DUP + 5 - R> '1' + SWAP C! ;
+: open-all n 0 DO I fname R/O OPEN-FILE THROW fids I CELLS + ! LOOP ;
+: read-all n 0 DO bufs I 1000 * + 1000 fids I CELLS + @ READ-FILE-ASYNC
+                  reqs I CELLS + ! LOOP ;
+: sum-all 0 n 0 DO reqs I CELLS + @ AWAIT THROW +
+                   fids I CELLS + @ CLOSE-FILE THROW LOOP ;
+open-all read-all sum-all .
+END
+
+note "Check AWAIT lets the other tasks run";
+forth_ok(<<END, "t 5 ");
+TASK t1
+: go t1 ACTIVATE ." t " ;
+CREATE buf 80 ALLOT
+: main go S" $test.dat" R/O OPEN-FILE THROW >R
+  buf 5 R@ READ-FILE-ASYNC AWAIT THROW . R> CLOSE-FILE THROW ;
+main
+END
+
+note "Check CLOSE-FILE waits for the requests";
+forth_ok(<<END, "( ) ");
+CREATE buf 100000 ALLOT
+S" $test.dat" W/O CREATE-FILE THROW CONSTANT file_id
+buf 100000 file_id WRITE-FILE-ASYNC
+file_id CLOSE-FILE THROW AWAIT THROW 100000 <> THROW .S
+END
+is -s "$test.dat", 100000, "file size";
+
+forth_ok(<<END, "-70 0 -75 0 ");
+PAD 5 99 READ-FILE-ASYNC AWAIT . .
+S" 12345" 99 WRITE-FILE-ASYNC AWAIT . .
+END
+
+forth_nok("99 AWAIT", "\nError: invalid numeric argument: request 99\n");
+forth_nok(<<END, "\nError: invalid numeric argument: request 1\n");
+S" $test.dat" R/O OPEN-FILE THROW CONSTANT file_id
+PAD 5 file_id READ-FILE-ASYNC DUP AWAIT 2DROP AWAIT
+END
+
 unlink "$test.dat", "$test.inc";
 unlink <$test.*.fs>;
 unlink <$test.*.dat>;
@@ -441,4 +441,98 @@ forth_ok("12 SET-PRECISION 10e 3e F/       F.", "3.33333333333");
 forth_ok("6  SET-PRECISION 10e 3e F/ 2e F* F.", "6.66667");
 forth_ok("12 SET-PRECISION 10e 3e F/ 2e F* F.", "6.66666666667");
 
+
+# float arrays: a = 1..n, b = 10 20 .. 10*n, c = 0 0 ..
+my $arrays = <<'END';
+	7 CONSTANT n
+	CREATE a n FLOATS ALLOT  CREATE b n FLOATS ALLOT  CREATE c n FLOATS ALLOT
+	: init n 0 DO I 1+ S>F a I FLOATS + F!  I 1+ 10 * S>F b I FLOATS + F!
+	              0E0 c I FLOATS + F! LOOP ;
+	: .v n 0 DO DUP I FLOATS + F@ F. LOOP DROP ;
+	init
+END
+
+note "Test FV+";
+forth_ok($arrays."a b c n FV+ c .v .S", "11. 22. 33. 44. 55. 66. 77. ( )");
+forth_ok($arrays."a b c 3 FV+ c .v .S", "11. 22. 33. 0. 0. 0. 0. ( )");
+forth_ok($arrays."a a a n FV+ a .v .S", "2. 4. 6. 8. 10. 12. 14. ( )");
+forth_ok($arrays."a b c 0 FV+ c .v .S", "0. 0. 0. 0. 0. 0. 0. ( )");
+forth_nok("0 0 -4 1 FV+", "\nError: invalid memory address\n");
+
+note "Test FV*";
+forth_ok($arrays."a b c n FV* c .v .S", "10. 40. 90. 160. 250. 360. 490. ( )");
+
+note "Test FV-SCALE";
+forth_ok($arrays."0.5E0 a c n FV-SCALE c .v .S .FS",
+         "0.5 1. 1.5 2. 2.5 3. 3.5 ( ) (F: )");
+
+note "Test FV-SQRT";
+forth_ok($arrays."a a a n FV* a c n FV-SQRT c .v .S",
+         "1. 2. 3. 4. 5. 6. 7. ( )");
+
+note "Test FDOT";
+forth_ok($arrays."a b n FDOT F. a b 5 FDOT F. a b 0 FDOT F. .S",
+         "1400. 550. 0. ( )");
+
+note "Test FSUM";
+forth_ok($arrays."a n FSUM F. b 3 FSUM F. a 0 FSUM F. .S", "28. 60. 0. ( )");
+
+
+# matrices compared with a reference implementation with DO loops
+my $matrices = <<'END';
+	: m@ ( addr row col ncols -- ) ( F: -- r ) ROT * + FLOATS + F@ ;
+	: m! ( addr row col ncols -- ) ( F: r -- ) ROT * + FLOATS + F! ;
+	: ref-mat* { a b c m n p | row col -- }
+		m 0 DO I TO row  p 0 DO I TO col
+			0E0 n 0 DO  a row I n m@  b I col p m@  F* F+  LOOP
+			c row col p m!
+		LOOP LOOP ;
+	: ref-mat+ { a b c m n -- }
+		m n * 0 DO  a I FLOATS + F@  b I FLOATS + F@  F+  c I FLOATS + F!  LOOP ;
+	: ref-mat*v { a x y m n | row -- }
+		m 0 DO I TO row
+			0E0 n 0 DO  a row I n m@  x I FLOATS + F@  F* F+  LOOP
+			y row FLOATS + F!
+		LOOP ;
+	: ref-transpose { a b m n | row -- }
+		m 0 DO I TO row  n 0 DO  a row I n m@  b I row m m!  LOOP LOOP ;
+	: fill ( addr n seed -- ) SWAP 0 DO 2DUP I * 7 MOD 3 - S>F I FLOATS + F! LOOP 2DROP ;
+	: same? ( addr1 addr2 n -- flag )
+		TRUE SWAP 0 DO >R 2DUP I FLOATS + F@ I FLOATS + F@ F= R> AND LOOP NIP NIP ;
+	110 CONSTANT m  90 CONSTANT n  100 CONSTANT p
+	CREATE a m n * FLOATS ALLOT  CREATE b n p * FLOATS ALLOT  CREATE d m n * FLOATS ALLOT
+	CREATE c1 m p * FLOATS ALLOT  CREATE c2 m p * FLOATS ALLOT
+	a m n * 3 fill  b n p * 5 fill  d m n * 4 fill
+END
+
+note "Test MAT*";
+forth_ok($matrices.<<'END', "-1 -1 -1 ( )");
+	a b c1 5 7 3 MAT*  a b c2 5 7 3 ref-mat*  c1 c2 15 same? .
+	a b c1 1 n 1 MAT*  a b c2 1 n 1 ref-mat*  c1 c2 1 same? .
+	a b c1 m n p MAT*  a b c2 m n p ref-mat*  c1 c2 m p * same? .
+	.S
+END
+forth_nok("0 0 0 -1 1 1 MAT*", "\nError: invalid memory address\n");
+
+note "Test MAT+";
+forth_ok($matrices.<<'END', "-1 -1 ( )");
+	a d c1 3 5 MAT+  a d c2 3 5 ref-mat+  c1 c2 15 same? .
+	a d c1 m n MAT+  a d c2 m n ref-mat+  c1 c2 m n * same? .
+	.S
+END
+
+note "Test MAT*V";
+forth_ok($matrices.<<'END', "-1 -1 ( )");
+	a b c1 5 7 MAT*V  a b c2 5 7 ref-mat*v  c1 c2 5 same? .
+	a b c1 m n MAT*V  a b c2 m n ref-mat*v  c1 c2 m same? .
+	.S
+END
+
+note "Test MAT-TRANSPOSE";
+forth_ok($matrices.<<'END', "-1 -1 ( )");
+	a c1 5 7 MAT-TRANSPOSE  a c2 5 7 ref-transpose  c1 c2 35 same? .
+	a c1 m 40 MAT-TRANSPOSE  a c2 m 40 ref-transpose  c1 c2 m 40 * same? .
+	.S
+END
+
 end_test;
@@ -0,0 +1,173 @@
+#!/usr/bin/perl
+
+BEGIN { use lib 't'; require 'testlib.pl'; }
+
+my $cc = $ENV{CC} // 'cc';
+my $cxx = $ENV{CXX} // 'c++';
+my $cell64 = (`forth -e "1 CELLS . BYE"` =~ /8/) ? "-DCELL64" : "";
+
+sub libforth_ok {
+	my($c_code, $exp_out) = @_;
+	local $Test::Builder::Level = $Test::Builder::Level + 1; 
+	
+	path("$test.c")->spew($c_code);
+	run_ok("$cc $cell64 -fexceptions -I. -c -o $test.o $test.c");
+	run_ok("$cxx -pthread -o $test.exe $test.o libforth.a");
+	capture_ok("./$test.exe", $exp_out);
+	unlink("$test.c", "$test.o", "$test.exe") if Test::More->builder->is_passing;
+}
+
+note "Check evaluate and stacks";
+libforth_ok(<<'END', <<'END');
+#include "libforth.h"
+#include <stdio.h>
+int main(void) {
+    ForthVM* vm = forth_create();
+    forth_push(vm, 2);
+    forth_push(vm, 3);
+    printf("%d\n", forth_evaluate(vm, ": sq DUP * ; + sq"));
+    printf("%d\n", forth_depth(vm));
+    printf("%ld\n", (long)forth_pop(vm));
+    printf("%ld\n", (long)forth_pop(vm));
+    forth_fpush(vm, 1.5);
+    printf("%d\n", forth_evaluate(vm, "2E0 F*"));
+    printf("%d\n", forth_fdepth(vm));
+    printf("%g\n", forth_fpop(vm));
+    forth_evaluate(vm, ".( hello) CR");
+    forth_destroy(vm);
+    return 0;
+}
+END
+0
+1
+25
+0
+0
+1
+3
+hello
+END
+
+note "Check errors";
+libforth_ok(<<'END', <<'END');
+#include "libforth.h"
+#include <stdio.h>
+int main(void) {
+    ForthVM* vm = forth_create();
+    int err = forth_evaluate(vm, "1 2 nosuchword");
+    printf("%d %s\n", err, forth_error_message(vm));
+    printf("%d\n", forth_depth(vm));
+    err = forth_evaluate(vm, "DROP");
+    printf("%d %s\n", err, forth_error_message(vm));
+    err = forth_evaluate(vm, ": x ABORT\" failed\" ; 1 x");
+    printf("%d %s\n", err, forth_error_message(vm));
+    printf("%d\n", forth_evaluate(vm, "1 2 + ."));
+    forth_destroy(vm);
+    return 0;
+}
+END
+-13 Error: undefined word: nosuchword
+0
+-4 Error: stack underflow
+-2 Aborted: failed
+0
+3
+END
+
+note "Check callbacks";
+libforth_ok(<<'END', <<'END');
+#include "libforth.h"
+#include <stdio.h>
+static void host_add(ForthVM* vm, void* user_data) {
+    forth_cell b = forth_pop(vm);
+    forth_cell a = forth_pop(vm);
+    forth_push(vm, a + b + *(forth_cell*)user_data);
+}
+static void host_fail(ForthVM* vm, void* user_data) {
+    (void)user_data;
+    forth_throw(vm, -24);
+}
+int main(void) {
+    ForthVM* vm = forth_create();
+    forth_cell bias = 100;
+    printf("%d\n", forth_register(vm, "HOST+", host_add, &bias));
+    printf("%d\n", forth_register(vm, "host-fail", host_fail, NULL));
+    printf("%d\n", forth_register(vm, "", host_fail, NULL));
+    printf("%d\n", forth_evaluate(vm, ": x 2 3 host+ 10 * ; x ."));
+    int err = forth_evaluate(vm, "1 HOST+");
+    printf("%d %s\n", err, forth_error_message(vm));
+    err = forth_evaluate(vm, "' HOST-FAIL CATCH . HOST-FAIL");
+    printf("%d %s\n", err, forth_error_message(vm));
+    forth_destroy(vm);
+    return 0;
+}
+END
+0
+0
+-16
+0
+-4 Error: stack underflow
+-24 Error: invalid numeric argument
+1050 -24
+END
+
+note "Check captured output";
+libforth_ok(<<'END', <<'END');
+#include "libforth.h"
+#include <stdio.h>
+int main(void) {
+    ForthVM* vm = forth_create();
+    size_t size;
+    const char* output;
+    forth_capture_output(vm, 1);
+    forth_evaluate(vm, "1 2 + . .\" done\" CR");
+    output = forth_output(vm, &size);
+    printf("[%.*s]\n", (int)size, output);
+    forth_clear_output(vm);
+    forth_evaluate(vm, "42 .");
+    output = forth_output(vm, &size);
+    printf("[%.*s]\n", (int)size, output);
+    forth_capture_output(vm, 0);
+    forth_evaluate(vm, ".( stdout) CR");
+    forth_destroy(vm);
+    return 0;
+}
+END
+[3 done
+]
+[42 ]
+stdout
+END
+
+note "Check channels between VMs in different threads";
+libforth_ok(<<'END', <<'END');
+#include "libforth.h"
+#include <pthread.h>
+#include <stdio.h>
+static forth_cell ch;
+static void* producer(void* arg) {
+    ForthVM* vm = forth_create();
+    (void)arg;
+    forth_push(vm, ch);
+    forth_evaluate(vm, ": produce 10001 1 DO I OVER SEND LOOP 0 SWAP SEND ; produce");
+    forth_destroy(vm);
+    return NULL;
+}
+int main(void) {
+    pthread_t thread;
+    ForthVM* vm = forth_create();
+    forth_evaluate(vm, "16 CHANNEL");
+    ch = forth_pop(vm);
+    pthread_create(&thread, NULL, producer, NULL);
+    forth_push(vm, ch);
+    forth_evaluate(vm, ": consume 0 BEGIN OVER RECEIVE ?DUP WHILE + REPEAT NIP ; consume");
+    pthread_join(thread, NULL);
+    printf("%ld\n", (long)forth_pop(vm));
+    forth_destroy(vm);
+    return 0;
+}
+END
+50005000
+END
+
+end_test;
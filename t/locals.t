@@ -185,4 +185,57 @@ forth_ok(<<'END', "10 ( )");
 	z .S
 END
 
+note "Check locals frames";
+forth_ok(<<'END', "0 10 10 15 ( )");
+	: x DUP 0= IF EXIT THEN { a } a 2* ;
+	0 x . 5 x .
+	: y { a } a 0> IF a 1- RECURSE a + EXIT THEN 0 ;
+	4 y .
+	: z CREATE { a } a , DOES> { b } b @ + ;
+	10 z w  5 w .
+	.S
+END
+
+forth_ok(<<'END', "0 6 -1 7 ( )");
+	: t { a } a 0= THROW a ;
+	: u { b } b t b + ;
+	3 ' u CATCH . .
+	0 ' u CATCH . DROP
+	: v { a } a ;
+	7 v .
+	.S
+END
+
+forth_ok(": x { a } a ; SEE x", <<'END');
+
+: x
+    (ENTER_FRAME) 1
+    (LOCAL!) 0
+    (LOCAL@) 0
+    (LEAVE_FRAME)
+    EXIT
+;
+END
+
+forth_ok(": x { a D: b | F: c } b a c ; SEE x", <<'END');
+
+: x
+    (ENTER_FRAME) 5
+    (2LOCAL!) 0
+    (LOCAL!) 2
+    0e 
+    (FLOCAL!) 3
+    (2LOCAL@) 0
+    (LOCAL@) 2
+    (FLOCAL@) 3
+    (LEAVE_FRAME)
+    EXIT
+;
+END
+
+forth_ok(<<'END', "0. 2.5 3 ( ) ");
+	: x { a | F: f } f F. 2.5e TO f f F. a . ;
+	3 x .S
+END
+
 end_test;
@@ -20,7 +20,7 @@ forth_ok('1234567890123. PAD 2!  PAD 2@ .S', "( 1912276171 287 )");
 note "Test ALLOCATE";
 note "Test RESIZE";
 note "Test FREE";
-forth_ok(<<'END', "1058592 Hello 1058704 Hello 1058916 Hello 1058592 Hello 1059228 Hello 1059740 Hello 1058704 ( )");
+forth_ok(<<'END', "1058596 Hello 1058708 Hello 1058920 Hello 1058596 Hello 1059232 Hello 1059744 Hello 1058708 ( )");
 	100 ALLOCATE THROW VALUE mem1
 	mem1 100 BL FILL
 	mem1 .
@@ -63,7 +63,7 @@ END
 forth_nok("-1 ALLOCATE THROW", "\nError: ALLOCATE exception");
 forth_nok("0      FREE THROW", "\nError: FREE exception");
 
-forth_ok(<<'END', "1058592 Hello 1058592 Hello ( 0 )");
+forth_ok(<<'END', "1058596 Hello 1058596 Hello ( 0 )");
 	100 ALLOCATE THROW VALUE mem1
 	mem1 100 BL FILL
 	mem1 .
@@ -76,4 +76,93 @@ forth_ok(<<'END', "1058592 Hello 1058592 Hello ( 0 )");
 	.S
 END
 
+note "Test ARENA";
+forth_ok("100 ARENA DUP 0<> . FREE .", "-1 0 ");
+forth_nok("-1 ARENA", "\nError: ALLOCATE exception\n");
+forth_nok("4000000 ARENA", "\nError: ALLOCATE exception\n");
+
+note "Test ARENA-ALLOT";
+forth_ok(<<'END', "-1 -1 -1 Hello ");
+	10 CELLS ARENA CONSTANT a
+	a 5 ARENA-ALLOT CONSTANT s1
+	a 1 CELLS ARENA-ALLOT CONSTANT n1
+	s1 ALIGNED s1 = .
+	n1 s1 5 + ALIGNED = .
+	a 1 ARENA-ALLOT n1 CELL+ = .
+	S" Hello" s1 SWAP MOVE s1 5 TYPE SPACE
+END
+forth_nok("3 CELLS ARENA DUP 2 CELLS ARENA-ALLOT DROP 2 CELLS ARENA-ALLOT",
+		  "\nError: ALLOCATE exception\n");
+forth_nok("10 ARENA -1 ARENA-ALLOT", "\nError: ALLOCATE exception\n");
+
+note "Test ARENA-MARK";
+note "Test ARENA-RELEASE";
+forth_ok(<<'END', "-1 -1 -1 -1 ");
+	10 CELLS ARENA CONSTANT a
+	a ARENA-MARK a 3 CELLS ARENA-ALLOT = .
+	a ARENA-MARK CONSTANT m
+	a 3 CELLS ARENA-ALLOT m = .
+	a 4 CELLS ARENA-ALLOT DROP
+	a m ARENA-RELEASE
+	a ARENA-MARK m = .
+	a 7 CELLS ARENA-ALLOT m = .
+END
+forth_nok("10 CELLS ARENA 0 ARENA-RELEASE", "\nError: invalid numeric argument: 0\n");
+
+note "Test ARENA-RESET";
+forth_ok(<<'END', "-1 -1 ");
+	10 CELLS ARENA CONSTANT a
+	a 10 CELLS ARENA-ALLOT CONSTANT p
+	a ARENA-RESET
+	a ARENA-MARK p = .
+	a 10 CELLS ARENA-ALLOT p = .
+END
+
+note "Test POOL";
+forth_ok("3 CELLS 10 POOL DUP 0<> . POOL-DESTROY", "-1 ");
+forth_nok("0 10 POOL", "\nError: invalid numeric argument: 0\n");
+forth_nok("8 0 POOL", "\nError: invalid numeric argument: 0\n");
+forth_nok("8 4000000 POOL", "\nError: ALLOCATE exception\n");
+
+note "Test POOL-ALLOC";
+note "Test POOL-FREE";
+forth_ok(<<'END', "-1 -1 -1 -1 ");
+	5 3 POOL CONSTANT p
+	p POOL-ALLOC CONSTANT a1
+	p POOL-ALLOC CONSTANT a2
+	p POOL-ALLOC CONSTANT a3
+	a1 ALIGNED a1 = .
+	a1 a2 <> a2 a3 <> AND a1 a3 <> AND .
+	a2 p POOL-FREE
+	p POOL-ALLOC a2 = .
+	S" Hello" a1 SWAP MOVE a1 5 S" Hello" COMPARE 0= .
+END
+forth_nok("1 1 POOL 0 SWAP POOL-FREE", "\nError: FREE exception\n");
+
+note "Check the pool grows by chunks";
+forth_ok(<<'END', "4950 0 ");
+	1000 CONSTANT n
+	CREATE ptrs n CELLS ALLOT
+	1 CELLS 10 POOL CONSTANT p
+	: fill n 0 DO p POOL-ALLOC I OVER ! ptrs I CELLS + ! LOOP ;
+	: sum 0 100 0 DO ptrs I CELLS + @ @ + LOOP ;
+	: release n 0 DO ptrs I CELLS + @ p POOL-FREE LOOP ;
+	fill sum . release fill release
+	p POOL-DESTROY DEPTH .
+END
+
+note "Check freed items are poisoned";
+forth_ok(<<'END', "221 221 ");
+	2 CELLS 1 POOL CONSTANT p
+	p POOL-ALLOC CONSTANT a
+	-1 a CELL+ ! a p POOL-FREE
+	a CELL+ C@ . a 2 CELLS + 1- C@ .
+END
+
+note "Test POOL-DESTROY";
+forth_ok(<<'END', "0 ");
+	: churn 100 0 DO 100 10 POOL DUP POOL-ALLOC DROP POOL-DESTROY LOOP ;
+	churn 1000000 ALLOCATE . FREE DROP
+END
+
 end_test;
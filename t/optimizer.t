@@ -0,0 +1,251 @@
+#!/usr/bin/perl
+
+BEGIN { use lib 't'; require 'testlib.pl'; }
+
+note "Check superinstructions";
+forth_ok(<<'END', "13 7 30 -1 0 0 -1 ( )");
+	: x1 10 + ;  3 x1 .
+	: x2 3 - ;  10 x2 .
+	: x3 3 * ;  10 x3 .
+	: x4 5 = ;  5 x4 . 6 x4 .
+	: x5 5 < ;  5 x5 . 4 x5 .
+	.S
+END
+
+forth_ok(<<'END', "42 43 10 ( )");
+	VARIABLE v
+	: x1 42 v ! ;  x1 v @ .
+	: x2 1 v +! ;  x2 v @ .
+	: x3 [ v ] LITERAL @ 33 - ;  x3 .
+	.S
+END
+
+forth_ok(<<'END', "49 ( 3 4 ) ( 1 ) ( 7 ) 10 ( )");
+	: sq DUP * ;  7 sq .
+	: x1 OVER + ;  3 1 x1 .S 2DROP
+	: x2 SWAP - ;  3 4 x2 .S DROP
+	VARIABLE v 5 v !
+	: x3 v @ + ;  2 x3 .S DROP
+	: x4 DUP @ ;  10 v ! v x4 NIP .
+	.S
+END
+
+forth_ok(<<'END', "y n y n y n n n y n y ( )");
+	: x1 = IF ." y " ELSE ." n " THEN ;  1 1 x1 1 2 x1
+	: x2 < IF ." y " ELSE ." n " THEN ;  1 2 x2 2 1 x2
+	: x3 0= IF ." y " ELSE ." n " THEN ;  0 x3 1 x3
+	: x4 0< IF ." y " ELSE ." n " THEN ;  0 x4 1 x4
+	: x5 DUP IF ." y " ELSE ." n " THEN DROP ;  1 x5 0 x5
+	: x6 0> IF ." y " ELSE ." n " THEN ;  1 x6
+	.S
+END
+
+note "Check pairs across basic blocks";
+forth_ok(<<'END', "11 21 ( )");
+	: x IF 10 ELSE 20 THEN 1 + ;
+	1 x . 0 x .
+	.S
+END
+
+forth_ok(<<'END', "10 9 8 7 6 5 4 3 2 1 ( )");
+	: x BEGIN DUP 0> WHILE DUP . 1- REPEAT DROP ;
+	10 x .S
+END
+
+note "Check SEE shows the unfused code";
+forth_ok(": x DUP * 3 + 5 < IF 1 THEN ; SEE x", <<'END');
+
+: x
+    DUP
+    *
+    3
+    +
+    5
+    <
+    0BRANCH  L1
+    1
+L1:
+    EXIT
+;
+END
+
+note "Check constant folding";
+forth_ok(<<'END', "60 7 5 9 ( )");
+	10 CONSTANT k  VARIABLE v  5 VALUE val
+	: x1 k 2 + 3 CELLS 4 * + ;  x1 .
+	: x2 v @ ;  7 v ! x2 .
+	: x3 val ;  x3 . 9 TO val x3 .
+	.S
+END
+
+forth_ok(": x 1 2 + 3 CELLS 4 * + NEGATE ; SEE x", <<'END');
+
+: x
+    -51 
+    EXIT
+;
+END
+
+forth_ok(<<'END', "5 4 5 2 3 ( )");
+	: x1 IF 1 ELSE 2 THEN 3 + ;  0 x1 . -1 x1 .
+	: x2 1 BEGIN 1+ DUP 5 < WHILE REPEAT ;  x2 .
+	: x3 DUP IF DROP 1 THEN 2 + ;  0 x3 . 5 x3 .
+	.S
+END
+
+forth_ok(<<'END', "1.5 2.5 1 3 ( )");
+	1.5E0 FVALUE fv  : x1 fv F. 2.5E0 TO fv fv F. ;  x1
+	1. 2VALUE dv  : x2 dv D. 3. TO dv dv D. ;  x2
+	.S
+END
+
+forth_nok("10 CONSTANT k : x TO k ;", "\nError: invalid name argument\n");
+
+note "Test STACK-EFFECT";
+forth_ok(<<'END', "-1 1 2 -1 1 1 -1 0 0 -1 1 2 0 ( )");
+	: x1 + ;				' x1 STACK-EFFECT . . .
+	: x2 DUP 0< IF NEGATE THEN ;	' x2 STACK-EFFECT . . .
+	: x3 ;					' x3 STACK-EFFECT . . .
+	: x4 x1 DUP * ;			' x4 STACK-EFFECT . . .
+	: x5 ?DUP ;				' x5 STACK-EFFECT .
+	.S
+END
+
+forth_ok(<<'END', "-1 1 3 -1 0 1 -1 1 0 0 ( )");
+	' WITHIN STACK-EFFECT . . .
+	' EMIT STACK-EFFECT . . .
+	VARIABLE v  ' v STACK-EFFECT . . .
+	' EXECUTE STACK-EFFECT .
+	.S
+END
+
+forth_ok(<<'END', "0 0 ( )");
+	: x1 IF 1 THEN ;		' x1 STACK-EFFECT .
+	: x2 CREATE , DOES> @ ;	' x2 STACK-EFFECT .
+	.S
+END
+
+note "Test INLINE-LIMIT";
+forth_ok(<<'END', "49 4 ( )");
+	: sq DUP * ;
+	: x sq ;  7 x .
+	INLINE-LIMIT @ .
+	.S
+END
+
+forth_ok(": sq DUP * ; : x 2 sq + ; SEE x", <<'END');
+
+: x
+    2
+    \ inlined sq
+      DUP
+      *
+    +
+    EXIT
+;
+END
+
+forth_ok("0 INLINE-LIMIT ! : sq DUP * ; : x 2 sq + ; SEE x", <<'END');
+
+: x
+    2
+    sq
+    +
+    EXIT
+;
+END
+
+forth_ok(<<'END', "\n: x\n    sq4 \\ tail call\n    EXIT\n;\n");
+	: sq4 DUP * DUP * DUP * ;
+	: x sq4 ; SEE x
+END
+
+note "Test INLINE";
+forth_ok(<<'END', "256 ( )");
+	: sq4 DUP * DUP * DUP * ; INLINE
+	: x sq4 ;  2 x .
+	.S
+END
+
+forth_ok(": sq4 DUP * DUP * DUP * ; INLINE : x 1+ sq4 ; SEE x", <<'END');
+
+: x
+    1+
+    \ inlined sq4
+      DUP
+      *
+      DUP
+      *
+      DUP
+      *
+    EXIT
+;
+END
+
+forth_ok(<<'END', "0 1 2 3 ( )");
+	: cnt 0 DO I . LOOP ; INLINE
+	: x 4 cnt ;  x
+	.S
+END
+
+forth_ok(<<'END', "0 1 2 ( )");
+	: x I ; INLINE
+	: y 3 0 DO x . LOOP ;  y
+	.S
+END
+
+forth_ok(<<'END', "yes no ( )");
+	: yes? IF ." yes " ELSE ." no " THEN ; INLINE
+	: x yes? ;  1 x 0 x
+	.S
+END
+
+forth_nok(": x >R R> ; INLINE", "\nError: cannot inline word: x\n");
+forth_nok(": x 1 IF EXIT THEN 2 ; INLINE", "\nError: cannot inline word: x\n");
+forth_nok(": x RECURSE ; INLINE", "\nError: cannot inline word: x\n");
+forth_nok(": x { a } a ; INLINE", "\nError: cannot inline word: x\n");
+forth_nok(": x CREATE DOES> ; INLINE", "\nError: cannot inline word: x\n");
+
+note "Check words that are not inlined";
+forth_ok(<<'END', "1 2 3 ( )");
+	: a >R R> ;  : x 1 a ;  x .
+	: b IF 2 EXIT THEN 0 ;  : y -1 b ;  y .
+	: c DUP 3 < IF 1+ RECURSE THEN ;  : z 0 c ;  z .
+	.S
+END
+
+note "Check tail calls";
+forth_ok(<<'END', "(R: 0 ) 0 (R: 0 ) 0 ( )");
+	: cd DUP 0= IF .RS EXIT THEN 1- RECURSE ;
+	1 cd .  1000000 cd .
+	.S
+END
+
+forth_ok(": cd DUP 0> IF 1- RECURSE THEN ; SEE cd", <<'END');
+
+: cd
+    DUP
+    0>
+    0BRANCH L1
+    1-
+    cd \ tail call
+L1:
+    EXIT
+;
+END
+
+forth_ok(<<'END', "10 12 ( )");
+	: a 1+ >R R> ;
+	: b DUP 10 < IF a EXIT THEN a a ;
+	9 b . 10 b .
+	.S
+END
+
+forth_ok(<<'END', "10 ( )");
+	: a { x } x 2* ;
+	: b { y } y a ;
+	5 b .
+	.S
+END
+
+end_test;
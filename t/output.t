@@ -108,4 +108,53 @@ forth_ok("-1 12 U.R", "  4294967295");
 note "Test ?";
 forth_ok("1 ? 2 ? 3 ? .S", "1 2 3 ( 1 2 3 )");
 
+note "Check number conversion against printf";
+srand(39);
+my @ints = (0, 1, -1, 9, 10, 99, 100, -100, 2147483647, -2147483647,
+			map {int(rand(2**32)) - 2**31} 1..200);
+my @doubles = (map {int(rand(2**62)) * (rand() < 0.5 ? -1 : 1)} 1..100);
+
+$forth = ""; $out = "";
+for (@ints) {
+	$forth .= "$_ . CR\n";
+	$out .= sprintf("%d \n", $_);
+	$forth .= "$_ 12 .R CR\n";
+	$out .= sprintf("%12d\n", $_);
+	$forth .= "$_ U. CR\n";
+	$out .= sprintf("%u \n", $_ & 0xffffffff);
+	$forth .= sprintf("HEX %s%X DECIMAL . CR\n", $_ < 0 ? "-" : "", abs($_));
+	$out .= sprintf("%d \n", $_);
+	$forth .= "$_ HEX . DECIMAL CR\n";
+	$out .= sprintf("%s%X \n", $_ < 0 ? "-" : "", abs($_));
+	$forth .= "$_ 2 BASE ! U. DECIMAL CR\n";
+	$out .= sprintf("%b \n", $_ & 0xffffffff);
+}
+for (@doubles) {
+	$forth .= "$_. D. CR\n";
+	$out .= sprintf("%d \n", $_);
+	$forth .= "$_. HEX 24 D.R DECIMAL CR\n";
+	$out .= sprintf("%24s\n", ($_ < 0 ? "-" : "").sprintf("%X", abs($_)));
+	$forth .= "$_. DABS <# #S #> TYPE CR\n";
+	$out .= sprintf("%d\n", abs($_));
+}
+forth_ok($forth, $out);
+
+my @floats = (0.5, 1, -1, 123.456, -0.001, 1e10, 
+			  grep {abs($_) > 1e-9}
+			  map {sprintf("%.6e", (rand() - 0.5) * 10 ** int(rand(20) - 5))} 1..200);
+$forth = ""; $out = "";
+for my $precision (1, 7, 15) {
+	$forth .= "$precision SET-PRECISION\n";
+	for (@floats) {
+		my $fixed = sprintf("%.*f", $precision - 1, $_);
+		$fixed .= "." unless $fixed =~ /\./;
+		$fixed =~ s/0+$//;
+		$forth .= (/e/ ? $_ : "${_}E0")." F. CR\n";
+		$out .= "$fixed \n";
+		$forth .= "S\" $_\" >FLOAT DROP F. CR\n";
+		$out .= "$fixed \n";
+	}
+}
+forth_ok($forth, $out);
+
 end_test;
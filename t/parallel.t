@@ -0,0 +1,165 @@
+#!/usr/bin/perl
+
+BEGIN { use lib 't'; require 'testlib.pl'; }
+
+# run with more threads than processors to exercise stealing
+sub parallel_ok {
+	my($fth, $exp_out) = @_;
+	local $Test::Builder::Level = $Test::Builder::Level + 1;
+	path("$test.fs")->spew($fth);
+	capture_ok("forth --threads 4 $test.fs", $exp_out);
+}
+
+sub parallel_nok {
+	my($fth, $exp_err) = @_;
+	local $Test::Builder::Level = $Test::Builder::Level + 1;
+	path("$test.fs")->spew($fth);
+	capture_nok("forth --threads 4 $test.fs", $exp_err);
+}
+
+note "Test PARALLEL-FOR";
+for my $threads (1, 4) {
+	path("$test.fs")->spew(<<'END');
+CREATE arr 1000 CELLS ALLOT
+: fill-sq ( i -- ) DUP DUP * SWAP CELLS arr + ! ;
+' fill-sq 0 1000 PARALLEL-FOR
+: sum ( -- n ) 0 1000 0 DO I CELLS arr + @ + LOOP ;
+sum . 999 CELLS arr + @ . DEPTH .
+END
+	capture_ok("forth --threads $threads $test.fs", "332833500 998001 0 ");
+}
+
+parallel_ok(<<'END', "0 ");
+' DROP 5 5 PARALLEL-FOR ' DROP 5 0 PARALLEL-FOR DEPTH .
+END
+
+note "Check the threads copy the user variables of the caller";
+parallel_ok(<<'END', "16 16 16 16 ");
+CREATE out 4 CELLS ALLOT
+: base! ( i -- ) BASE @ SWAP CELLS out + ! ;
+: run HEX ['] base! 0 4 PARALLEL-FOR DECIMAL 4 0 DO out I CELLS + @ . LOOP ;
+run
+END
+
+note "Test PARALLEL-REDUCE";
+parallel_ok(<<'END', "333833500 0 ");
+: sq ( i -- x ) DUP * ;
+0 ' sq ' + 0 1001 PARALLEL-REDUCE . DEPTH .
+END
+
+parallel_ok(<<'END', "42 99 ");
+: sq ( i -- x ) DUP * ;
+42 ' sq ' + 5 5 PARALLEL-REDUCE . 
+: id ; 0 ' id ' MAX 0 100 PARALLEL-REDUCE .
+END
+
+note "Check uneven iterations are balanced by stealing";
+parallel_ok(<<'END', "200010000 ");
+: work ( i -- i ) DUP 19900 > IF 10000 0 DO LOOP THEN ;
+0 ' work ' + 0 20001 PARALLEL-REDUCE .
+END
+
+note "Check nested loops run in the calling thread";
+parallel_ok(<<'END', "1000 ");
+: sq ( i -- x ) DUP * ;
+: inner ( i -- x ) DROP 0 ['] sq ['] + 0 10 PARALLEL-REDUCE DROP 1 ;
+0 ' inner ' + 0 1000 PARALLEL-REDUCE .
+END
+
+note "Check errors in the iterations";
+parallel_nok(<<'END', "\nError: division by zero\n");
+: bad ( i -- ) 500 = IF 1 0 / DROP THEN ;
+' bad 0 1000 PARALLEL-FOR
+END
+
+parallel_ok(<<'END', "-10 2 1 ");
+: bad ( i -- ) 500 = IF 1 0 / DROP THEN ;
+: run ['] bad 0 1000 PARALLEL-FOR ;
+1 2 ' run CATCH . . .
+END
+
+parallel_ok(<<'END', "-2 ");
+: bad ( i -- x ) 50 = ABORT" fifty" 0 ;
+: run 0 ['] bad ['] + 0 100 ['] PARALLEL-REDUCE CATCH . ;
+run
+END
+
+note "Test ATOMIC@";
+note "Test ATOMIC!";
+forth_ok("VARIABLE x 5 x ATOMIC! x ATOMIC@ . x @ .", "5 5 ");
+forth_nok("VARIABLE x x 1+ ATOMIC@", "\nError: address alignment exception\n");
+
+note "Test ATOMIC+!";
+forth_ok("VARIABLE x 5 x ! -7 x ATOMIC+! x @ .", "-2 ");
+parallel_ok(<<'END', "100000 ");
+VARIABLE count  0 count !
+: bump ( i -- ) DROP 1 count ATOMIC+! ;
+' bump 0 100000 PARALLEL-FOR count ATOMIC@ .
+END
+
+note "Test CAS";
+forth_ok("VARIABLE x 5 x ! 5 7 x CAS . x @ . 5 9 x CAS . x @ .", "-1 7 0 7 ");
+
+note "Test FENCE";
+forth_ok("1 FENCE .", "1 ");
+parallel_ok(<<'END', "20000 ");
+VARIABLE lock  0 lock !
+VARIABLE count  0 count !
+: acquire ( -- ) BEGIN 0 1 lock CAS UNTIL ;
+: release ( -- ) FENCE 0 lock ATOMIC! ;
+: bump ( i -- ) DROP acquire count @ 1+ count ! release ;
+' bump 0 20000 PARALLEL-FOR count @ .
+END
+
+note "Check the heap is shared by the threads";
+for my $threads (1, 8) {
+	path("$test.fs")->spew(<<'END');
+: churn ( i -- )
+  DUP 13 MOD 1+ 40 * ALLOCATE THROW   ( i a )
+  2DUP !
+  OVER 5 MOD 1+ CELLS ALLOCATE THROW  ( i a b )
+  OVER 100 RESIZE THROW               ( i a b a' )
+  SWAP FREE THROW                     ( i a a' )
+  NIP DUP @ ROT <> ABORT" corrupted"
+  FREE THROW ;
+' churn 0 20000 PARALLEL-FOR
+900000 ALLOCATE THROW FREE THROW ." ok"
+END
+	capture_ok("forth --threads $threads $test.fs", "ok");
+}
+
+parallel_ok(<<'END', "0 ");
+1000 CONSTANT n
+CREATE ptrs n CELLS ALLOT
+: new ( i -- ) DUP 100 MOD 1+ CELLS ALLOCATE THROW 2DUP ! SWAP CELLS ptrs + ! ;
+: check ( i -- ) DUP CELLS ptrs + @ DUP @ ROT <> ABORT" corrupted" FREE THROW ;
+' new 1 n PARALLEL-FOR ' check 1 n PARALLEL-FOR
+900000 ALLOCATE THROW FREE THROW DEPTH .
+END
+
+note "Check the threads allot from the same arena";
+parallel_ok(<<'END', "-1 -59 ");
+1000 CONSTANT n
+n 2* CELLS ARENA CONSTANT a
+a ARENA-MARK CONSTANT m
+CREATE ptrs n CELLS ALLOT
+: new ( i -- ) a 2 CELLS ARENA-ALLOT 2DUP ! SWAP CELLS ptrs + ! ;
+: check ( i -- ) DUP CELLS ptrs + @ @ <> ABORT" corrupted" ;
+' new 0 n PARALLEL-FOR ' check 0 n PARALLEL-FOR
+a ARENA-MARK m n 2* CELLS + = .
+a 1 ' ARENA-ALLOT CATCH NIP NIP .
+END
+
+note "Check the threads share a pool";
+parallel_ok(<<'END', "0 ");
+1000 CONSTANT n
+2 CELLS 16 POOL CONSTANT p
+CREATE ptrs n CELLS ALLOT
+: new ( i -- ) p POOL-ALLOC 2DUP ! SWAP CELLS ptrs + ! ;
+: check ( i -- ) DUP CELLS ptrs + @ DUP @ ROT <> ABORT" corrupted" p POOL-FREE ;
+' new 0 n PARALLEL-FOR ' check 0 n PARALLEL-FOR
+' new 0 n PARALLEL-FOR ' check 0 n PARALLEL-FOR
+p POOL-DESTROY DEPTH .
+END
+
+end_test;
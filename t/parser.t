@@ -261,4 +261,72 @@ forth_ok('S" 9d" >FLOAT .S .FS', "( -1 ) (F: 9 )");
 forth_ok('S" 9d+" >FLOAT .S .FS', "( -1 ) (F: 9 )");
 forth_ok('S" 9d-" >FLOAT .S .FS', "( -1 ) (F: 9 )");
 
+note "Check recognizers";
+forth_ok("1-5 .S .FS", "( ) (F: 1e-05 )");
+forth_ok(": 123 .\" word\" ; 123", "word");
+forth_ok("HEX : ABC 1 ; ABC . DECIMAL", "1 ");
+forth_ok("HEX ABC DECIMAL .", "2748 ");
+
+note "Test REC-NAME";
+forth_ok("S\" DUP\" REC-NAME RECTYPE-NAME = . . ' DUP = .", "-1 -1 -1 ");
+forth_ok("S\" IF\" REC-NAME RECTYPE-NAME = . . DROP", "-1 1 ");
+forth_ok("S\" xyz\" REC-NAME RECTYPE-NULL = .", "-1 ");
+
+note "Test REC-NUMBER";
+forth_ok("S\" 123\" REC-NUMBER RECTYPE-NUM = . .", "-1 123 ");
+forth_ok("S\" 1.5\" REC-NUMBER RECTYPE-DNUM = . D.", "-1 15 ");
+forth_ok("S\" x\" REC-NUMBER RECTYPE-NULL = .", "-1 ");
+
+note "Test REC-FLOAT";
+forth_ok("S\" 1.5E\" REC-FLOAT RECTYPE-FLOAT = . F.", "-1 1.5 ");
+forth_ok("S\" 1.5\" REC-FLOAT RECTYPE-NULL = .", "-1 ");
+
+note "Test RECOGNIZE";
+forth_ok("S\" 12\" RECOGNIZE RECTYPE-NUM = . .", "-1 12 ");
+forth_ok("S\" xyz\" RECOGNIZE RECTYPE-NULL = .", "-1 ");
+
+note "Test RECTYPE>INT";
+forth_ok("RECTYPE-NUM RECTYPE>INT 5 SWAP EXECUTE .", "5 ");
+
+note "Test RECTYPE>COMP";
+forth_ok(": x [ 7 RECTYPE-NUM RECTYPE>COMP EXECUTE ] ; x .", "7 ");
+
+note "Test RECTYPE>POST";
+forth_ok(": x [ 7 RECTYPE-NUM RECTYPE>POST EXECUTE ] ; : y [ x ] ; y .", "7 ");
+forth_ok(": x POSTPONE 42 POSTPONE 1.5 POSTPONE 2.5E ; IMMEDIATE ".
+		 ": y x ; y .S D. F. .", "( 42 15 0 ) 15 2.5 42 ");
+
+note "Test RECTYPE-NULL";
+note "Test RECTYPE-NAME";
+note "Test RECTYPE-NUM";
+note "Test RECTYPE-DNUM";
+note "Test RECTYPE-FLOAT";
+forth_ok("RECTYPE-NULL RECTYPE-NAME <> . RECTYPE-NAME RECTYPE-NUM <> . ".
+		 "RECTYPE-NUM RECTYPE-DNUM <> . RECTYPE-DNUM RECTYPE-FLOAT <> .", 
+		 "-1 -1 -1 -1 ");
+
+note "Test RECTYPE:";
+note "Test GET-RECOGNIZERS";
+note "Test SET-RECOGNIZERS";
+forth_ok("GET-RECOGNIZERS . ' REC-NAME = . ' REC-FLOAT = . ' REC-NUMBER = .",
+		 "3 -1 -1 -1 ");
+$forth = <<'END';
+	:NONAME ; ' LITERAL :NONAME POSTPONE LITERAL ['] LITERAL , ; 
+	RECTYPE: rectype-xt
+	: rec-tick ( c-addr u -- xt rectype-xt | rectype-null )
+		OVER C@ [CHAR] ` <> IF 2DROP RECTYPE-NULL EXIT THEN
+		1 /STRING REC-NAME RECTYPE-NAME <> IF RECTYPE-NULL EXIT THEN
+		DROP rectype-xt ;
+	GET-RECOGNIZERS ' rec-tick SWAP 1+ SET-RECOGNIZERS
+	`DUP ' DUP = .
+	: t `SWAP ; t ' SWAP = .
+	: u POSTPONE `OVER ; IMMEDIATE : v u ; v ' OVER = .
+	GET-RECOGNIZERS . DROP 2DROP DROP
+	-1 SET-RECOGNIZERS GET-RECOGNIZERS . 2DROP DROP
+END
+forth_ok($forth, "-1 -1 -1 4 3 ");
+forth_nok("' REC-NUMBER ' REC-NAME 2 SET-RECOGNIZERS 1.5E", 
+		  "\nError: undefined word: 1.5E\n");
+forth_nok("0 SET-RECOGNIZERS DUP", "\nError: undefined word: DUP\n");
+
 end_test;
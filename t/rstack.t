@@ -15,7 +15,10 @@ forth_ok("1 2 2>R .RS  2R@ .S .RS  2R> .S .RS",
 note "Test R@";
 note "Test I";
 note "Test J";
-forth_ok("1 >R 2 >R 3 >R  R@ . I . J . .RS BYE", "3 3 1 (R: 1 2 3 )");
+forth_ok("1 >R 2 >R 3 >R  R@ . .RS BYE", "3 (R: 1 2 3 )");
+forth_ok(": x 2 0 DO 1 >R 5 3 DO R@ . I . J . LOOP R> DROP LOOP ; x",
+		 "1 3 0 1 4 0 1 3 1 1 4 1 ");
+forth_nok("I", "\nError: return stack underflow\n");
 
 note "Test RDROP";
 forth_ok("1 >R -1 >R .S .RS RDROP RDROP .S .RS", "( )(R: 1 -1 )( )(R: )");
@@ -0,0 +1,114 @@
+#!/usr/bin/perl
+
+BEGIN { use lib 't'; require 'testlib.pl'; }
+
+use IO::Socket::UNIX;
+use Time::HiRes qw( sleep );
+
+if ($^O eq 'MSWin32') {
+	plan skip_all => "Unix domain sockets not supported";
+}
+
+my $sock = "$test.sock";
+
+sub request {
+	my($source) = @_;
+	my $client = IO::Socket::UNIX->new(Type => SOCK_STREAM(), Peer => $sock)
+		or die "connect $sock: $!";
+	print $client $source;
+	$client->shutdown(1);
+	local $/;
+	my $reply = <$client>;
+	close($client);
+	return $reply;
+}
+
+sub request_ok {
+	my($source, $exp_reply) = @_;
+	local $Test::Builder::Level = $Test::Builder::Level + 1;
+	# ignore trailing blanks, like diff -w
+	my $reply = request($source);
+	for ($reply, $exp_reply) { s/[ \t]+$//mg; s/\s*\z/\n/; }
+	is $reply, $exp_reply, $source;
+	check_die();
+}
+
+note "Check --serve";
+path("$test.fs")->spew(<<'END');
+: sq ( n -- n*n ) DUP * ;
+VARIABLE counter
+END
+unlink($sock);
+my $pid = fork();
+if ($pid == 0) {
+	exec("forth", "-e", "HEX", "--serve", $sock, "--workers", "2", "$test.fs")
+		or die "exec: $!";
+}
+for (1..50) { last if -S $sock; sleep(0.1); }
+ok -S $sock, "server started";
+
+request_ok("C sq .", <<'END');
+status: 0
+stack:
+fstack:
+
+90
+END
+
+request_ok("DECIMAL 1 counter +! counter @ 1.5E0", <<'END');
+status: 0
+stack: 1
+fstack: 1.5
+
+END
+
+note "Check requests start from the snapshot";
+request_ok(": sq DROP 0 ; C sq counter @", <<'END');
+status: 0
+stack: 0 0
+fstack:
+
+END
+
+request_ok("C sq counter @ 10 .", <<'END');
+status: 0
+stack: 144 0
+fstack:
+
+10
+END
+
+my($here) = request("HERE") =~ /stack: (\d+)/;
+for (1..20) {
+	request(": x 1 counter +! ; x x HERE 1000 ALLOT HERE 5 ERASE");
+}
+request_ok("counter @ HERE", <<"END");
+status: 0
+stack: 0 $here
+fstack:
+
+END
+
+note "Check errors";
+request_ok("1 2 .( hi) undefined-word", <<'END');
+status: -13
+message: Error: undefined word: undefined-word
+stack:
+fstack:
+
+hi
+END
+
+request_ok("1 0 /", <<'END');
+status: -10
+message: Error: division by zero
+stack:
+fstack:
+
+END
+
+kill 'TERM', $pid;
+waitpid($pid, 0);
+unlink($sock);
+
+end_test;
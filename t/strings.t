@@ -179,6 +179,36 @@ forth_ok('S" ABC" S" ABC " SEARCH 0= [IF] TYPE [THEN]', 'ABC');
 forth_ok('S" A@C" S" @C" SEARCH [IF] TYPE [THEN]', '@C');
 forth_ok('S" A B C" S" B" SEARCH [IF] TYPE [THEN]', 'B C');
 
+# Long strings, matches across SIMD blocks and long patterns
+my $text = "the quick brown fox jumps over the lazy dog " x 4;
+forth_ok(qq{S" $text" S" lazy dog the" SEARCH . NIP .S}, "-1 ( 141 )");
+forth_ok(qq{S" $text" S" lazy dog the quick brown fox jumps over" SEARCH . NIP .S},
+         "-1 ( 141 )");
+forth_ok(qq{S" $text" S" lazy dog the quick brown fox jumps ovex" SEARCH . NIP .S},
+         "0 ( 176 )");
+forth_ok(qq{S" $text" S" LAZY" SEARCH . NIP .S}, "0 ( 176 )");
+forth_ok(qq{S" $text" S" dog " SEARCH . NIP .S}, "-1 ( 136 )");
+
+note "Test ICOMPARE";
+forth_ok('S" abc"  S" ABC"  ICOMPARE .S', '( 0 )');
+forth_ok('S" abc"  S" ABD"  ICOMPARE .S', '( -1 )');
+forth_ok('S" ABD"  S" abc"  ICOMPARE .S', '( 1 )');
+forth_ok('S" ABC"  S" ab"   ICOMPARE .S', '( 1 )');
+forth_ok('S" ab"   S" ABC"  ICOMPARE .S', '( -1 )');
+forth_ok('S" "     S" "     ICOMPARE .S', '( 0 )');
+forth_ok('S" [" S" a" ICOMPARE S" [" S" A" COMPARE .S', '( -1 1 )');
+forth_ok(qq{S" $text" S" \U$text" ICOMPARE .S}, '( 0 )');
+
+note "Test ISEARCH";
+forth_ok('S" ABCDEF" S" cde" ISEARCH [IF] TYPE [THEN]', 'CDEF');
+forth_ok('S" abcdef" S" CDE" ISEARCH [IF] TYPE [THEN]', 'cdef');
+forth_ok('S" ABCDEF" S" xyz" ISEARCH 0= [IF] TYPE [THEN]', 'ABCDEF');
+forth_ok('S" ABCDEF" S" " ISEARCH [IF] TYPE [THEN]', 'ABCDEF');
+forth_ok('S" A[" S" a{" ISEARCH 0= [IF] TYPE [THEN]', 'A[');
+forth_ok(qq{S" $text" S" LAZY DOG THE QUICK BROWN FOX JUMPS OVER" ISEARCH . NIP .S},
+         "-1 ( 141 )");
+forth_ok(qq{S" $text" S" Dog " ISEARCH . NIP .S}, "-1 ( 136 )");
+
 note "Test SLITERAL";
 forth_ok(': x [ S" hello" ] SLITERAL ; x TYPE', 'hello');
 
@@ -45,4 +45,34 @@ forth_ok(<<'END', "( ) ( 44 1000 1004 1008 1012 1020 1028 1036 ) ");
 	.S
 END
 
+note "Check compiled field access";
+forth_ok(<<'END', "42 12 7 ( )");
+	BEGIN-STRUCTURE point  FIELD: p.x  FIELD: p.y  END-STRUCTURE
+	BEGIN-STRUCTURE rect  point +FIELD r.tl  point +FIELD r.br  END-STRUCTURE
+	CREATE r rect ALLOT
+	: x1 r.br p.y ! ;  : x2 r.br p.y @ ;  : x3 r r.br p.y r - ;
+	: x4 DUP p.x @ SWAP p.y @ + ;
+	42 r x1  r x2 .  x3 .
+	3 r p.x !  4 r p.y !  r x4 .
+	.S
+END
+
+forth_ok(<<'END', <<'END2');
+	BEGIN-STRUCTURE point  FIELD: p.x  FIELD: p.y  END-STRUCTURE
+	BEGIN-STRUCTURE rect  point +FIELD r.tl  point +FIELD r.br  END-STRUCTURE
+	: x r.tl p.x @ SWAP r.br p.y ! ;  SEE x  SEE r.br
+END
+
+: x
+    @
+    SWAP
+    12 
+    +
+    !
+    EXIT
+;
+
+FIELD r.br OFFSET 8
+END2
+
 end_test;
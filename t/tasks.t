@@ -0,0 +1,152 @@
+#!/usr/bin/perl
+
+BEGIN { use lib 't'; require 'testlib.pl'; }
+
+note "Test TASK";
+forth_ok("TASK t1 t1 t1 = . ' t1 >BODY t1 = .", "-1 -1 ");
+forth_ok("TASK t1 TASK t2 t1 t2 <> .", "-1 ");
+
+note "Test ACTIVATE";
+forth_ok(<<'END', "m1 t1 m2 t2 m3 ");
+TASK t1
+: go t1 ACTIVATE ." t1 " PAUSE ." t2 " ;
+: main go ." m1 " PAUSE ." m2 " PAUSE ." m3 " PAUSE ;
+main
+END
+
+forth_ok(<<'END', "t: 0 -1 0 ( 7 ) ");
+TASK t1
+: go t1 ACTIVATE ." t: " DEPTH . 5 5 = . FDEPTH . ;
+7 go PAUSE .S
+END
+
+forth_nok("TASK t1 t1 ACTIVATE", "\nError: interpreting a compile-only word: ACTIVATE\n");
+forth_nok(": x 0 ACTIVATE ; x", "\nError: invalid memory address: 0\n");
+
+note "Check tasks have their own user variables";
+forth_ok(<<'END', "10 10 A ");
+TASK t1
+: go t1 ACTIVATE 10 . HEX PAUSE 10 . ;
+: main DECIMAL go PAUSE 10 . PAUSE ;
+HEX main
+END
+
+note "Check tasks have their own return and loop stacks";
+forth_ok(<<'END', "a0 b0 a1 b1 a2 b2 ");
+TASK t1
+: go t1 ACTIVATE 3 0 DO ." b" I . PAUSE LOOP ;
+: main go 3 0 DO ." a" I . PAUSE LOOP ;
+main
+END
+
+note "Check activating a running task restarts it";
+forth_ok(<<'END', "1 1 2 1 2 3 1 ");
+TASK t1
+: count t1 ACTIVATE 1 BEGIN DUP . 1+ PAUSE AGAIN ;
+: count-to 0 ?DO PAUSE LOOP count ;
+count 1 count-to 2 count-to 3 count-to PAUSE
+END
+
+note "Test PAUSE";
+forth_ok("1 2 PAUSE .S", "( 1 2 )");
+forth_ok(<<'END', "ABCABCABC");
+TASK tb TASK tc
+: b tb ACTIVATE 3 0 DO [CHAR] B EMIT PAUSE LOOP ;
+: c tc ACTIVATE 3 0 DO [CHAR] C EMIT PAUSE LOOP ;
+: a b c 3 0 DO [CHAR] A EMIT PAUSE LOOP ;
+a
+END
+
+note "Test STOP";
+forth_ok(<<'END', "t1 m m m ");
+TASK t1
+: go t1 ACTIVATE ." t1 " STOP ." never " ;
+: main go 3 0 DO PAUSE ." m " LOOP ;
+main
+END
+
+forth_ok(<<'END', "t1 t1 ");
+TASK t1
+: go t1 ACTIVATE ." t1 " STOP ;
+go PAUSE PAUSE go PAUSE PAUSE
+END
+
+forth_ok("1 STOP .S", "( 1 )");
+
+note "Check STOP is not caught by CATCH";
+forth_ok(<<'END', "t1 m m ");
+TASK t1
+: inner ." t1 " STOP ;
+: go t1 ACTIVATE ['] inner CATCH ." caught " DROP ;
+go PAUSE ." m " PAUSE ." m "
+END
+
+note "Check an error stops only the task";
+path("$test.fs")->spew(<<'END');
+TASK t1
+: go t1 ACTIVATE 1 0 / ." never " ;
+go PAUSE ." main " PAUSE ." main "
+END
+capture_ok("forth $test.fs 2> $test.err", "main main ");
+is path("$test.err")->slurp, "\nError: division by zero\n", "error message";
+
+note "Check MS lets the other tasks run";
+forth_ok(<<'END', "m t t t m ");
+TASK t1
+: go t1 ACTIVATE 3 0 DO ." t " PAUSE LOOP ;
+: main go ." m " 50 MS ." m " ;
+main
+END
+
+note "Check READ-LINE lets the other tasks run";
+path("$test.txt")->spew("line1\nline2\n");
+forth_ok(<<"END", "t line1 t line2 t ");
+TASK t1
+: go t1 ACTIVATE 3 0 DO ." t " PAUSE LOOP ;
+CREATE buf 80 ALLOT
+: main go S" $test.txt" R/O OPEN-FILE THROW
+  2 0 DO buf 80 2 PICK READ-LINE THROW DROP buf SWAP TYPE SPACE LOOP
+  CLOSE-FILE THROW ;
+main PAUSE
+END
+unlink "$test.txt";
+
+note "Test CHANNEL";
+forth_ok("1 CHANNEL 1 CHANNEL <> .", "-1 ");
+forth_nok("0 CHANNEL", "\nError: invalid numeric argument: 0\n");
+forth_nok("99 RECEIVE", "\nError: invalid numeric argument: channel 99\n");
+
+note "Test SEND";
+note "Test RECEIVE";
+forth_ok(<<'END', "1 2 3 ");
+3 CHANNEL CONSTANT ch
+1 ch SEND 2 ch SEND 3 ch SEND
+ch RECEIVE . ch RECEIVE . ch RECEIVE .
+END
+
+forth_ok(<<'END', "0 1 2 3 4 5 6 7 8 9 done ");
+2 CHANNEL CONSTANT ch
+TASK producer
+: produce producer ACTIVATE 10 0 DO I ch SEND LOOP -1 ch SEND ;
+: consume produce BEGIN ch RECEIVE DUP 0>= WHILE . REPEAT DROP ." done " ;
+consume
+END
+
+note "Check a pipeline of tasks";
+forth_ok(<<'END', "500500 ");
+1 CHANNEL CONSTANT in
+1 CHANNEL CONSTANT out
+TASK source TASK square
+: run-source source ACTIVATE 1001 1 DO I in SEND LOOP 0 in SEND ;
+: run-double square ACTIVATE BEGIN in RECEIVE DUP WHILE out SEND REPEAT out SEND ;
+: sink run-source run-double 0 BEGIN out RECEIVE ?DUP WHILE + REPEAT . ;
+sink
+END
+
+note "Test TRY-RECEIVE";
+forth_ok(<<'END', "0 -1 7 0 ");
+4 CHANNEL CONSTANT ch
+ch TRY-RECEIVE . 7 ch SEND ch TRY-RECEIVE . . ch TRY-RECEIVE .
+END
+
+end_test;
@@ -5,44 +5,52 @@ BEGIN { use lib 't'; require 'testlib.pl'; }
 note "Test WORDS";
 
 forth_ok("words", <<'END');
-FORTH FORTH-WORDLIST ORDER ONLY PREVIOUS ALSO SEARCH-WORDLIST SET-ORDER
-GET-ORDER SET-CURRENT GET-CURRENT WORDLIST DEFINITIONS UNESCAPE SUBSTITUTE
-REPLACES SLITERAL SEARCH COMPARE CMOVE> CMOVE BLANK /STRING -TRAILING .( C" S\"
-S" ." COUNT [THEN] [ELSE] [IF] [UNDEFINED] [DEFINED] TRAVERSE-WORDLIST SYNONYM
-NAME>INTERPRET NAME>STRING NAME>COMPILE >NAME FORGET NR> N>R CS-ROLL CS-PICK
-AHEAD OFF ON SEE DUMP NEXT-ARG ENVIRONMENT? WORDS .FS .RS .S RESIZE FREE
-ALLOCATE { {: LOCALS| (LOCAL) SET-PRECISION PRECISION F~ FTRUNC FSQRT FLNP1
-FEXPM1 FLN FEXP FALOG FLOG FSINCOS FATAN2 FATANH FACOSH FASINH FATAN FACOS
-FASIN FTANH FCOSH FSINH FTAN FCOS FSIN FABS F>S S>F FS. FE. F. F** REPRESENT
-FROUND FNEGATE FMIN FMAX FLOOR SFLOATS SFLOAT+ DFLOATS DFLOAT+ FLOATS FLOAT+
-FDEPTH -FROT FROT FOVER FDUP FSWAP FDROP SFALIGNED SFALIGN DFALIGNED DFALIGN
-FALIGNED FALIGN F0>= F0<= F0> F0< F0<> F0= F>= F<= F> F< F<> F= F/ F- F* F+ SF@
-SF! DF@ DF! F@ F! F>D D>F >FLOAT FVARIABLE FCONSTANT FLITERAL FS-EXECUTABLE
-FS-WRITABLE FS-READABLE FS-SYMLINK FS-DIRECTORY FS-REGULAR FS-EXISTS
-FILE-STATUS REQUIRED REQUIRE INCLUDE INCLUDE-FILE INCLUDED RENAME-FILE
-DELETE-FILE CLOSE-FILE FLUSH-FILE RESIZE-FILE FILE-SIZE REPOSITION-FILE
-FILE-POSITION WRITE-LINE READ-LINE WRITE-FILE READ-FILE OPEN-FILE CREATE-FILE
-BIN R/W W/O R/O TIME&DATE MS K-F12 K-F11 K-F10 K-F9 K-F8 K-F7 K-F6 K-F5 K-F4
-K-F3 K-F2 K-F1 K-NEXT K-PRIOR K-DELETE K-INSERT K-END K-HOME K-RIGHT K-LEFT
-K-DOWN K-UP K-SHIFT-MASK K-CTRL-MASK K-ALT-MASK EMIT? EKEY>FKEY EKEY>CHAR EKEY
-EKEY? KEY KEY? END-STRUCTURE DFFIELD: SFFIELD: FFIELD: 2FIELD: FIELD: CFIELD:
-+FIELD BEGIN-STRUCTURE PAGE AT-XY ABORT" ABORT CATCH THROW DNEGATE DMIN DMAX
-DABS D>S D0>= D0> D0<= D0< D0<> D0= DU>= DU> DU<= DU< D>= D> D<= D< D<> D= M+
-M*/ D2/ D2* D- D+ 2LITERAL 2VARIABLE 2CONSTANT THRU LIST UPDATE LOAD FLUSH
-EMPTY-BUFFERS SAVE-BUFFERS BUFFER BLOCK SCR BLK BYE QUIT ENDCASE ENDOF OF CASE
-RECURSE REPEAT WHILE UNTIL AGAIN BEGIN UNLOOP LEAVE +LOOP LOOP ?DO DO THEN ELSE
-IF #! \ ( IS ACTION-OF DEFER! DEFER@ DEFER [COMPILE] COMPILE, IMMEDIATE
-POSTPONE DOES> LITERAL CONSTANT TO FVALUE 2VALUE VALUE BUFFER: VARIABLE CREATE
-['] ' ] [ ; :NONAME : STATE EXIT EXECUTE EVALUATE INTERPRET TRACE U.R .R U. D.R
-D. ? . #> SIGN HOLDS HOLD #S # <# SPACES SPACE CR EMIT TYPE RESTORE-INPUT
-SAVE-INPUT QUERY EXPECT SPAN ACCEPT REFILL SOURCE-ID #TIB TIB SOURCE #IN >IN
-CONVERT >NUMBER NUMBER NUMBER? DPL [CHAR] CHAR PARSE-NAME PARSE-WORD PARSE WORD
-MARKER UNUSED ALLOT ALIGNED ALIGN >BODY FIND LATEST HERE C, , RDROP 2R@ 2R> 2>R
-J I R@ R> >R -2ROT 2ROT 2OVER 2DUP 2SWAP 2DROP TUCK ROLL PICK NIP DEPTH -ROT
-ROT OVER ?DUP DUP SWAP DROP MOVE ERASE FILL 2@ 2! C@ C! +! @ ! 0>= 0<= 0> 0<
-0<> 0= U>= U<= U> U< >= <= > < <> = RSHIFT LSHIFT INVERT XOR OR AND WITHIN
-CELLS CELL+ CHARS CHAR+ MIN MAX ABS UM* S>D NEGATE 2/ 2* 1- 1+ M* SM/REM UM/MOD
-FM/MOD */MOD */ /MOD MOD / - * + HEX DECIMAL BASE TRUE FALSE PAD BL
+SET-RECOGNIZERS GET-RECOGNIZERS RECOGNIZE RECTYPE>POST RECTYPE>COMP RECTYPE>INT
+RECTYPE: RECTYPE-FLOAT RECTYPE-DNUM RECTYPE-NUM RECTYPE-NAME RECTYPE-NULL
+REC-FLOAT REC-NUMBER REC-NAME FORTH FORTH-WORDLIST ORDER ONLY PREVIOUS ALSO
+SEARCH-WORDLIST SET-ORDER GET-ORDER SET-CURRENT GET-CURRENT WORDLIST
+DEFINITIONS UNESCAPE SUBSTITUTE REPLACES SLITERAL ISEARCH SEARCH ICOMPARE
+COMPARE CMOVE> CMOVE BLANK /STRING -TRAILING .( C" S\" S" ." COUNT [THEN]
+[ELSE] [IF] [UNDEFINED] [DEFINED] TRAVERSE-WORDLIST SYNONYM NAME>INTERPRET
+NAME>STRING NAME>COMPILE >NAME FORGET NR> N>R CS-ROLL CS-PICK AHEAD OFF ON
+STACK-EFFECT SEE DUMP NEXT-ARG ENVIRONMENT? WORDS .FS .RS .S POOL-DESTROY
+POOL-FREE POOL-ALLOC POOL ARENA-RESET ARENA-RELEASE ARENA-MARK ARENA-ALLOT
+ARENA RESIZE FREE ALLOCATE { {: LOCALS| (LOCAL) MAT-TRANSPOSE MAT*V MAT+ MAT*
+FSUM FDOT FV-SQRT FV-SCALE FV* FV+ SET-PRECISION PRECISION F~ FTRUNC FSQRT
+FLNP1 FEXPM1 FLN FEXP FALOG FLOG FSINCOS FATAN2 FATANH FACOSH FASINH FATAN
+FACOS FASIN FTANH FCOSH FSINH FTAN FCOS FSIN FABS F>S S>F FS. FE. F. F**
+REPRESENT FROUND FNEGATE FMIN FMAX FLOOR SFLOATS SFLOAT+ DFLOATS DFLOAT+ FLOATS
+FLOAT+ FDEPTH -FROT FROT FOVER FDUP FSWAP FDROP SFALIGNED SFALIGN DFALIGNED
+DFALIGN FALIGNED FALIGN F0>= F0<= F0> F0< F0<> F0= F>= F<= F> F< F<> F= F/ F-
+F* F+ SF@ SF! DF@ DF! F@ F! F>D D>F >FLOAT FVARIABLE FCONSTANT FLITERAL
+FS-EXECUTABLE FS-WRITABLE FS-READABLE FS-SYMLINK FS-DIRECTORY FS-REGULAR
+FS-EXISTS FILE-STATUS REQUIRED REQUIRE INCLUDE INCLUDE-FILE INCLUDED
+RENAME-FILE DELETE-FILE CLOSE-FILE FLUSH-FILE RESIZE-FILE FILE-SIZE
+REPOSITION-FILE FILE-POSITION WRITE-LINE READ-LINE AWAIT WRITE-FILE-ASYNC
+READ-FILE-ASYNC WRITE-FILE READ-FILE OPEN-FILE CREATE-FILE BIN R/W W/O R/O
+FENCE CAS ATOMIC+! ATOMIC! ATOMIC@ PARALLEL-REDUCE PARALLEL-FOR TRY-RECEIVE
+RECEIVE SEND CHANNEL STOP PAUSE ACTIVATE TASK TIME&DATE MS K-F12 K-F11 K-F10
+K-F9 K-F8 K-F7 K-F6 K-F5 K-F4 K-F3 K-F2 K-F1 K-NEXT K-PRIOR K-DELETE K-INSERT
+K-END K-HOME K-RIGHT K-LEFT K-DOWN K-UP K-SHIFT-MASK K-CTRL-MASK K-ALT-MASK
+EMIT? EKEY>FKEY EKEY>CHAR EKEY EKEY? KEY KEY? END-STRUCTURE DFFIELD: SFFIELD:
+FFIELD: 2FIELD: FIELD: CFIELD: +FIELD BEGIN-STRUCTURE PAGE AT-XY ABORT" ABORT
+CATCH THROW DNEGATE DMIN DMAX DABS D>S D0>= D0> D0<= D0< D0<> D0= DU>= DU> DU<=
+DU< D>= D> D<= D< D<> D= M+ M*/ D2/ D2* D- D+ 2LITERAL 2VARIABLE 2CONSTANT THRU
+LIST UPDATE LOAD FLUSH EMPTY-BUFFERS SAVE-BUFFERS BUFFER BLOCK SCR BLK BYE QUIT
+ENDCASE ENDOF OF CASE INLINE-LIMIT INLINE RECURSE REPEAT WHILE UNTIL AGAIN
+BEGIN UNLOOP LEAVE +LOOP LOOP ?DO DO THEN ELSE IF #! \ ( IS ACTION-OF DEFER!
+DEFER@ DEFER [COMPILE] COMPILE, IMMEDIATE POSTPONE DOES> LITERAL CONSTANT TO
+FVALUE 2VALUE VALUE BUFFER: VARIABLE CREATE ['] ' ] [ ; :NONAME : STATE EXIT
+EXECUTE EVALUATE INTERPRET TRACE U.R .R U. D.R D. ? . #> SIGN HOLDS HOLD #S #
+<# SPACES SPACE CR EMIT TYPE RESTORE-INPUT SAVE-INPUT QUERY EXPECT SPAN ACCEPT
+REFILL SOURCE-ID #TIB TIB SOURCE #IN >IN CONVERT >NUMBER NUMBER NUMBER? DPL
+[CHAR] CHAR PARSE-NAME PARSE-WORD PARSE WORD MARKER UNUSED ALLOT ALIGNED ALIGN
+>BODY FIND LATEST HERE C, , RDROP 2R@ 2R> 2>R J I R@ R> >R -2ROT 2ROT 2OVER
+2DUP 2SWAP 2DROP TUCK ROLL PICK NIP DEPTH -ROT ROT OVER ?DUP DUP SWAP DROP MOVE
+ERASE FILL 2@ 2! C@ C! +! @ ! 0>= 0<= 0> 0< 0<> 0= U>= U<= U> U< >= <= > < <> =
+RSHIFT LSHIFT INVERT XOR OR AND WITHIN CELLS CELL+ CHARS CHAR+ MIN MAX ABS UM*
+S>D NEGATE 2/ 2* 1- 1+ M* SM/REM UM/MOD FM/MOD */MOD */ /MOD MOD / - * + HEX
+DECIMAL BASE TRUE FALSE PAD BL
 END
 die if !Test::More->builder->is_passing;
 
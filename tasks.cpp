@@ -0,0 +1,225 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#include "errors.h"
+#include "tasks.h"
+#include "vm.h"
+#include <chrono>
+#include <thread>
+
+// machine stack of each task, Forth words nest on it only through EXECUTE,
+// CATCH and the outer interpreter
+static const size_t TASK_STACK_SZ = 256 * 1024;
+
+Task::Task(ucell addr_, User* user_)
+    : addr(addr_), user(user_) {
+}
+
+Task::~Task() {
+    if (context != nullptr) {
+        delete_context(context);
+    }
+}
+
+void Tasks::init() {
+    tasks_.clear();
+    tasks_.push_back(std::make_unique<Task>(0, vm->user));
+    tasks_[0]->awake = true;
+    current_ = 0;
+    num_awake_ = 1;
+}
+
+void Tasks::clear() {
+    if (tasks_.empty() || current_ != 0) {
+        return;
+    }
+    for (size_t i = 1; i < tasks_.size(); i++) {
+        Task& task = *tasks_[i];
+        set_awake(task, false);
+        if (task.running) {
+            task.restart = true;        // unwinds in pause() and returns here
+            switch_to(i);
+        }
+    }
+}
+
+std::vector<ucell> Tasks::addresses() const {
+    std::vector<ucell> addresses;
+    for (size_t i = 1; i < tasks_.size(); i++) {
+        addresses.push_back(tasks_[i]->addr);
+    }
+    return addresses;
+}
+
+void Tasks::restore(const std::vector<ucell>& addresses) {
+    clear();
+    init();
+    for (ucell addr : addresses) {
+        User* user = reinterpret_cast<User*>(mem_char_ptr(addr + CELL_SZ));
+        tasks_.push_back(std::make_unique<Task>(addr, user));
+    }
+}
+
+void Tasks::create() {
+    vm->dict.parse_create(idXDOVAR, 0);
+    ucell addr = vm->here;
+    comma(static_cast<cell>(tasks_.size()));
+    User* user = reinterpret_cast<User*>(mem_char_ptr(vm->here));
+    vm->dict.allot(sizeof(User));
+    align();
+    user->init();
+    tasks_.push_back(std::make_unique<Task>(addr, user));
+}
+
+Task& Tasks::find(ucell addr) {
+    ucell index = fetch(addr);
+    if (index == 0 || index >= tasks_.size() || tasks_[index]->addr != addr) {
+        error(Error::InvalidMemoryAddress, std::to_string(addr));
+    }
+    return *tasks_[index];
+}
+
+void Tasks::activate(ucell addr, ucell ip) {
+    Task& task = find(addr);
+
+    // the task starts with a copy of the user variables of its activator
+    *task.user = *vm->user;
+    task.user->STATE = STATE_INTERPRET;
+    task.entry = ip;
+
+    if (tasks_[0]->context == nullptr) {
+        tasks_[0]->context = new_main_context();
+    }
+    if (task.context == nullptr) {
+        task.context = new_task_context(run, TASK_STACK_SZ);
+    }
+    if (task.running) {
+        task.restart = true;    // unwinds when it resumes, then runs entry
+    }
+    set_awake(task, true);
+}
+
+void Tasks::pause() {
+    num_pauses_++;
+    yield();
+}
+
+// sleep when no task did a PAUSE since the last turn, i.e. all are waiting;
+// only the first one to notice sleeps in each round
+void Tasks::wait() {
+    ucell num_pauses = num_pauses_;
+    yield();
+    if (num_pauses_ == num_pauses) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        num_pauses_++;
+    }
+}
+
+void Tasks::stop() {
+    if (current_ == 0) {
+        pause();
+    }
+    else {
+        throw TaskStop();
+    }
+}
+
+void Tasks::set_awake(Task& task, bool awake) {
+    if (task.awake != awake) {
+        task.awake = awake;
+        num_awake_ += awake ? 1 : -1;
+    }
+}
+
+void Tasks::switch_to(size_t next) {
+    Task& from = *tasks_[current_];
+    Task& to = *tasks_[next];
+    if (&from != &to) {
+        from.ip = vm->ip;
+        exchange_stacks(from);
+        vm->ip = to.ip;
+        vm->user = to.user;
+        exchange_stacks(to);
+        current_ = next;
+        switch_context(from.context, to.context);
+    }
+
+    // resumed
+    if (from.restart) {
+        throw TaskStop();
+    }
+}
+
+// continue in the next awake task, the main task is always awake
+void Tasks::yield() {
+    if (num_awake_ > 1 || !tasks_[current_]->awake) {
+        size_t next = current_;
+        do {
+            next = (next + 1) % tasks_.size();
+        } while (!tasks_[next]->awake);
+        switch_to(next);
+    }
+}
+
+void Tasks::exchange_stacks(Task& task) {
+    vm->stack.swap(task.stack);
+    vm->r_stack.swap(task.r_stack);
+    vm->loop_stack.swap(task.loop_stack);
+    vm->except_stack.swap(task.except_stack);
+    vm->f_stack.swap(task.f_stack);
+    vm->locals.swap(task.locals);
+}
+
+// entry point of every task, runs its code each time it is activated
+void Tasks::run() {
+    while (true) {
+        Tasks& tasks = vm->tasks;
+        Task& task = *tasks.tasks_[tasks.current_];
+        task.running = true;
+        task.restart = false;
+
+        vm->stack.clear();
+        vm->r_stack.clear();
+        vm->loop_stack.clear();
+        vm->except_stack.clear();
+        vm->f_stack.clear();
+        vm->locals.resize(0);
+        vm->locals.set_frame(0);
+
+        // return into the code after ACTIVATE, the final EXIT returns to 0
+        cell error_code = 0;
+        try {
+            r_push(0);
+            r_push(task.entry);
+            error_code = catch_error([]() { f_execute(xtEXIT); });
+        }
+        catch (TaskStop&) {
+        }
+        task.running = false;
+        print_error(error_code);
+
+        if (!task.restart || !task.awake) {
+            tasks.set_awake(task, false);
+            try {
+                tasks.yield();          // back here when activated again
+            }
+            catch (TaskStop&) {
+            }
+        }
+    }
+}
+
+void f_task() {
+    vm->tasks.create();
+}
+
+void f_activate() {
+    ucell task = pop();
+    if (vm->ip == 0) {
+        error(Error::InterpretingACompileOnlyWord, "ACTIVATE");
+    }
+    vm->tasks.activate(task, vm->ip);
+}
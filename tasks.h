@@ -0,0 +1,107 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "control.h"
+#include "forth.h"
+#include "locals.h"
+#include "stack.h"
+#include <memory>
+#include <vector>
+
+// machine stack and registers of a task, implemented in tasks_posix.cpp and
+// tasks_win32.cpp
+struct TaskContext;
+
+// context of the thread running the VM, and a new context that calls entry,
+// that must not return
+TaskContext* new_main_context();
+TaskContext* new_task_context(void (*entry)(), size_t stack_size);
+void delete_context(TaskContext* context);
+
+// save the current context in from and continue in to
+void switch_context(TaskContext* from, TaskContext* to);
+
+// thrown by STOP, and in a task that was activated again, to unwind the
+// task to its entry point; not caught by CATCH
+struct TaskStop {};
+
+// a task created by TASK; the task address is the body of the word, with
+// the index of the task followed by its user variables
+struct Task {
+    Task(ucell addr_, User* user_);
+    ~Task();
+
+    ucell addr;
+    User* user;
+    cell ip{ 0 };
+    ucell entry{ 0 };           // code to run, set by ACTIVATE
+    bool awake{ false };        // in the round-robin
+    bool running{ false };      // has frames on its machine stack
+    bool restart{ false };      // unwind and run entry again, if awake
+    TaskContext* context{ nullptr };
+
+    // stacks of the task while it is not running
+    Stack<cell> stack{ '\0', Error::StackUnderflow };
+    Stack<cell> r_stack{ 'R', Error::ReturnStackUnderflow };
+    Stack<LoopFrame> loop_stack{ 'L', Error::ReturnStackUnderflow };
+    Stack<cell> except_stack{ 'E', Error::ExceptionStackUnderflow };
+    Stack<double> f_stack{ 'F', Error::FloatStackUnderflow };
+    Locals locals;
+};
+
+// cooperative round-robin multitasker; task 0 is the main task that runs
+// the interpreter, it is always awake and cannot be stopped
+class Tasks {
+public:
+    Tasks() = default;
+    Tasks(const Tasks&) = delete;
+    Tasks& operator=(const Tasks&) = delete;
+
+    void init();
+
+    // unwind and stop all tasks, called by the main task, e.g. before the
+    // VM is destroyed
+    void clear();
+
+    // addresses of the tasks, to recreate them after a snapshot restore
+    std::vector<ucell> addresses() const;
+    void restore(const std::vector<ucell>& addresses);
+
+    // other tasks wait to run, blocking words poll and PAUSE
+    bool multitasking() const {
+        return num_awake_ > 1;
+    }
+
+    void create();                          // TASK name
+    void activate(ucell task, ucell ip);    // run the code at ip in task
+    void pause();                           // switch to the next task
+    void wait();                            // pause while waiting for I/O
+    void stop();                            // end the current task
+
+    // a waiting task made progress, e.g. a channel transfer, the other
+    // waiting tasks should not sleep
+    void progress() {
+        num_pauses_++;
+    }
+
+private:
+    std::vector<std::unique_ptr<Task>> tasks_;
+    size_t current_{ 0 };
+    size_t num_awake_{ 1 };
+    ucell num_pauses_{ 0 };     // PAUSEs and progress, to detect idle rounds
+
+    Task& find(ucell addr);
+    void set_awake(Task& task, bool awake);
+    void yield();
+    void switch_to(size_t next);
+    void exchange_stacks(Task& task);
+    static void run();
+};
+
+void f_task();
+void f_activate();
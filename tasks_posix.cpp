@@ -0,0 +1,182 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#include "tasks.h"
+
+#ifndef _WIN32
+#include <cstdint>
+
+// swapcontext() saves the signal mask with a system call on every switch;
+// on x86-64 and AArch64 the switch only saves the callee-saved registers
+// on the stack and swaps the stack pointers, other systems use ucontext
+#if (defined(__x86_64__) || defined(__aarch64__)) && !defined(__CYGWIN__)
+#define FAST_SWITCH 1
+#else
+#define FAST_SWITCH 0
+#include <ucontext.h>
+#endif
+
+struct TaskContext {
+    std::unique_ptr<char[]> stack;
+#if FAST_SWITCH
+    void* sp{ nullptr };
+#else
+    ucontext_t uc;
+#endif
+};
+
+#if FAST_SWITCH
+
+#ifdef __APPLE__
+#define ASM_NAME(name)      "_" #name
+#define ASM_TYPE(name)
+#else
+#define ASM_NAME(name)      #name
+#define ASM_TYPE(name)      ".type " #name ", %function\n"
+#endif
+
+// save the registers on the current stack, store the stack pointer in
+// *from_sp, load to_sp and restore the registers saved there
+extern "C" void forth_switch_stack(void** from_sp, void* to_sp);
+
+#ifdef __x86_64__
+// rbp rbx r12-r15 and the SSE and x87 control words; a new stack holds
+// the same frame with the entry function as the return address, followed
+// by a null return address for the entry function
+static const size_t FRAME_CELLS = 9;
+static const size_t RETURN_CELL = 7;
+
+asm(".text\n"
+    ".globl " ASM_NAME(forth_switch_stack) "\n"
+    ASM_TYPE(forth_switch_stack)
+    ASM_NAME(forth_switch_stack) ":\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n");
+
+static void init_frame(uintptr_t* frame) {
+    uint32_t mxcsr;
+    uint16_t fpucw;
+    asm volatile("stmxcsr %0" : "=m"(mxcsr));
+    asm volatile("fnstcw %0" : "=m"(fpucw));
+    frame[0] = mxcsr | (static_cast<uintptr_t>(fpucw) << 32);
+}
+#endif
+
+#ifdef __aarch64__
+// x19-x28, x29 (fp), x30 (lr) and d8-d15; a new stack holds the same frame
+// with a null frame pointer and the entry function in x30
+static const size_t FRAME_CELLS = 20;
+static const size_t RETURN_CELL = 11;
+
+asm(".text\n"
+    ".globl " ASM_NAME(forth_switch_stack) "\n"
+    ASM_TYPE(forth_switch_stack)
+    ".p2align 2\n"
+    ASM_NAME(forth_switch_stack) ":\n"
+    "    sub sp, sp, #160\n"
+    "    stp x19, x20, [sp, #0]\n"
+    "    stp x21, x22, [sp, #16]\n"
+    "    stp x23, x24, [sp, #32]\n"
+    "    stp x25, x26, [sp, #48]\n"
+    "    stp x27, x28, [sp, #64]\n"
+    "    stp x29, x30, [sp, #80]\n"
+    "    stp d8, d9, [sp, #96]\n"
+    "    stp d10, d11, [sp, #112]\n"
+    "    stp d12, d13, [sp, #128]\n"
+    "    stp d14, d15, [sp, #144]\n"
+    "    mov x2, sp\n"
+    "    str x2, [x0]\n"
+    "    mov sp, x1\n"
+    "    ldp x19, x20, [sp, #0]\n"
+    "    ldp x21, x22, [sp, #16]\n"
+    "    ldp x23, x24, [sp, #32]\n"
+    "    ldp x25, x26, [sp, #48]\n"
+    "    ldp x27, x28, [sp, #64]\n"
+    "    ldp x29, x30, [sp, #80]\n"
+    "    ldp d8, d9, [sp, #96]\n"
+    "    ldp d10, d11, [sp, #112]\n"
+    "    ldp d12, d13, [sp, #128]\n"
+    "    ldp d14, d15, [sp, #144]\n"
+    "    add sp, sp, #160\n"
+    "    ret\n");
+
+static void init_frame(uintptr_t* /*frame*/) {
+}
+#endif
+
+TaskContext* new_main_context() {
+    return new TaskContext;
+}
+
+TaskContext* new_task_context(void (*entry)(), size_t stack_size) {
+    TaskContext* context = new TaskContext;
+    context->stack.reset(new char[stack_size]);
+
+    // frame at the 16-byte aligned top of the stack
+    uintptr_t top = reinterpret_cast<uintptr_t>(context->stack.get()) +
+                    stack_size;
+    top &= ~static_cast<uintptr_t>(15);
+    uintptr_t* frame = reinterpret_cast<uintptr_t*>(top) - FRAME_CELLS;
+    for (size_t i = 0; i < FRAME_CELLS; i++) {
+        frame[i] = 0;
+    }
+    init_frame(frame);
+    frame[RETURN_CELL] = reinterpret_cast<uintptr_t>(entry);
+    context->sp = frame;
+    return context;
+}
+
+void switch_context(TaskContext* from, TaskContext* to) {
+    forth_switch_stack(&from->sp, to->sp);
+}
+
+#else
+
+TaskContext* new_main_context() {
+    return new TaskContext;
+}
+
+TaskContext* new_task_context(void (*entry)(), size_t stack_size) {
+    TaskContext* context = new TaskContext;
+    context->stack.reset(new char[stack_size]);
+    getcontext(&context->uc);
+    context->uc.uc_stack.ss_sp = context->stack.get();
+    context->uc.uc_stack.ss_size = stack_size;
+    context->uc.uc_link = nullptr;
+    makecontext(&context->uc, entry, 0);
+    return context;
+}
+
+void switch_context(TaskContext* from, TaskContext* to) {
+    swapcontext(&from->uc, &to->uc);
+}
+
+#endif
+
+void delete_context(TaskContext* context) {
+    delete context;
+}
+
+#endif
@@ -0,0 +1,56 @@
+//-----------------------------------------------------------------------------
+// C++ implementation of a Forth interpreter
+// Copyright (c) Paulo Custodio, 2020-2026
+// License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
+//-----------------------------------------------------------------------------
+
+#include "tasks.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+// each task runs in a fiber, the main task converts the thread into one
+struct TaskContext {
+    void* fiber{ nullptr };
+    void (*entry)() { nullptr };
+    bool converted{ false };        // thread converted by new_main_context()
+};
+
+static void CALLBACK fiber_entry(void* param) {
+    static_cast<TaskContext*>(param)->entry();
+}
+
+TaskContext* new_main_context() {
+    TaskContext* context = new TaskContext;
+    if (IsThreadAFiber()) {
+        context->fiber = GetCurrentFiber();
+    }
+    else {
+        context->fiber = ConvertThreadToFiber(nullptr);
+        context->converted = true;
+    }
+    return context;
+}
+
+TaskContext* new_task_context(void (*entry)(), size_t stack_size) {
+    TaskContext* context = new TaskContext;
+    context->entry = entry;
+    context->fiber = CreateFiber(stack_size, fiber_entry, context);
+    return context;
+}
+
+void delete_context(TaskContext* context) {
+    if (context->converted) {
+        ConvertFiberToThread();
+    }
+    else if (context->entry != nullptr && context->fiber != nullptr) {
+        DeleteFiber(context->fiber);
+    }
+    delete context;
+}
+
+void switch_context(TaskContext* /*from*/, TaskContext* to) {
+    SwitchToFiber(to->fiber);
+}
+
+#endif
@@ -4,6 +4,7 @@
 // License: GPL3 https://www.gnu.org/licenses/gpl-3.0.html
 //-----------------------------------------------------------------------------
 
+#include "optimizer.h"
 #include "parser.h"
 #include "tools.h"
 #include "vm.h"
@@ -13,62 +14,78 @@
 #include <iostream>
 
 void f_dump() {
-    uint size = pop();
-    uint addr = pop();
+    ucell size = pop();
+    ucell addr = pop();
     const char* mem = mem_char_ptr(addr, size);
     f_dump(mem, size);
 }
 
-void f_dump(const char* mem, uint size) {
-    uint addr = mem_addr(mem);
-    uint addr_lo = addr & ~0xF;
-    uint addr_hi = (addr + size + 15) & ~0xF;
-    for (uint p = addr_lo; p < addr_hi; p += 16) {
-        std::cout << std::endl << std::hex << std::setfill('0') << std::setw(
+void f_dump(const char* mem, ucell size) {
+    ucell addr = mem_addr(mem);
+    ucell addr_lo = addr & ~0xF;
+    ucell addr_hi = (addr + size + 15) & ~0xF;
+    for (ucell p = addr_lo; p < addr_hi; p += 16) {
+        vm->out << std::endl << std::hex << std::setfill('0') << std::setw(
                       8) << p << BL << BL;
-        for (uint q = p; q < p + 16; ++q) {
+        for (ucell q = p; q < p + 16; ++q) {
             if (q < addr || q >= addr + size) {
-                std::cout << BL << BL << BL;
+                vm->out << BL << BL << BL;
             }
             else {
-                std::cout << std::hex << std::setfill('0') << std::setw(2) << cfetch(q) << BL;
+                vm->out << std::hex << std::setfill('0') << std::setw(2) << cfetch(q) << BL;
             }
         }
-        std::cout << BL << BL;
-        for (uint q = p; q < p + 16; ++q) {
+        vm->out << BL << BL;
+        for (ucell q = p; q < p + 16; ++q) {
             if (q < addr || q >= addr + size) {
-                std::cout << BL;
+                vm->out << BL;
             }
             else {
                 char c = cfetch(q);
-                std::cout << (is_print(c) ? c : '.');
+                vm->out << (is_print(c) ? c : '.');
             }
         }
     }
-    std::cout << std::endl << std::dec << std::setfill(' ') << std::setw(0);
+    vm->out << std::endl << std::dec << std::setfill(' ') << std::setw(0);
 }
 
 struct Line {
-    uint label_id{ 0 };
-    uint addr{ 0 };
-    uint target_addr{ 0 };
+    ucell label_id{ 0 };
+    ucell addr{ 0 };
+    ucell target_addr{ 0 };
     std::string text;
 };
 
-static std::vector<Line> disassemble(uint body, uint size) {
+static std::vector<Line> disassemble(ucell body, ucell size) {
     std::vector<Line> lines;
 
-    uint ptr = body;
-    int indent = 0;
+    ucell ptr = body;
+    cell indent = 0;
+    std::vector<ucell> inlined_ends;
     while (ptr < body + size) {
+        while (!inlined_ends.empty() && ptr >= inlined_ends.back()) {
+            inlined_ends.pop_back();
+            indent -= 2;
+        }
+        auto it = vm->inlined.find(ptr);
+        if (it != vm->inlined.end() && it->second.end <= body + size) {
+            Line line;
+            line.addr = ptr;
+            line.text = std::string(indent, ' ') + "\\ inlined " +
+                        Header::header(it->second.xt)->name()->to_string();
+            lines.push_back(line);
+            inlined_ends.push_back(it->second.end);
+            indent += 2;
+        }
+
         Line line;
         line.addr = ptr;
 
-        uint xt = fetch(ptr);
+        ucell xt = unfused_xt(fetch(ptr));
         ptr += CELL_SZ;
         Header* header = Header::header(xt);
         if (xt == xtXLITERAL) {
-            int value = fetch(ptr);
+            cell value = fetch(ptr);
             ptr += CELL_SZ;
             line.text = std::string(indent, ' ') + number_to_string(value);
         }
@@ -83,77 +100,90 @@ static std::vector<Line> disassemble(uint body, uint size) {
             line.text = std::string(indent, ' ') + number_e_to_string(value);
         }
         else if (xt == xtBRANCH || xt == xtZBRANCH) {
-            int dist = fetch(ptr);
+            cell dist = fetch(ptr);
             line.target_addr = ptr + dist;
             ptr += CELL_SZ;
             line.text = std::string(indent, ' ') + header->name()->to_string();
         }
+        else if (is_local_op(xt)) {
+            cell index = fetch(ptr);
+            ptr += CELL_SZ;
+            line.text = std::string(indent, ' ') + header->name()->to_string() +
+                        " " + std::to_string(index);
+        }
+        else if (xt == xtXTAIL_CALL) {
+            cell called_xt = fetch(ptr);
+            ptr += CELL_SZ;
+            Header* called = Header::header(called_xt);
+            line.text = std::string(indent, ' ') + called->name()->to_string() +
+                        " \\ tail call";
+        }
         else if (xt == xtXDOT_QUOTE) {
-            int str_addr = fetch(ptr);
+            cell str_addr = fetch(ptr);
             ptr += CELL_SZ;
             const LongString* message = reinterpret_cast<const LongString*>(
                                             mem_char_ptr(str_addr));
             line.text = std::string(indent, ' ') + ".\" " + message->to_string() + "\"";
         }
         else if (xt == xtXSLITERAL) {
-            int str_addr = fetch(ptr);
+            cell str_addr = fetch(ptr);
             ptr += CELL_SZ;
             const LongString* message = reinterpret_cast<const LongString*>(
                                             mem_char_ptr(str_addr));
             line.text = std::string(indent, ' ') + "S\" " + message->to_string() + "\"";
         }
         else if (xt == xtXABORT_QUOTE) {
-            int str_addr = fetch(ptr);
+            cell str_addr = fetch(ptr);
             ptr += CELL_SZ;
             const LongString* message = reinterpret_cast<const LongString*>(
                                             mem_char_ptr(str_addr));
             line.text = std::string(indent, ' ') + "ABORT\" " + message->to_string() + "\"";
         }
         else if (xt == xtXC_QUOTE) {
-            int str_addr = fetch(ptr);
+            cell str_addr = fetch(ptr);
             ptr += CELL_SZ;
             const CString* message = reinterpret_cast<const CString*>(
                                          mem_char_ptr(str_addr));
             line.text = std::string(indent, ' ') + "C\" " + message->to_string() + "\"";
         }
         else if (xt == xtXDOES_DEFINE) {
-            fetch(ptr);     // int creator_xt =
+            fetch(ptr);     // cell creator_xt =
             ptr += CELL_SZ;
-            int run_code = fetch(ptr);
+            cell run_code = fetch(ptr);
             ptr += CELL_SZ;
             line.target_addr = run_code;
             line.text = std::string(indent, ' ') + "DOES>";
         }
         else if (xt == xtXDO) {
-            int dist = fetch(ptr);
+            cell dist = fetch(ptr);
             line.target_addr = ptr + dist;
             ptr += CELL_SZ;
             line.text = std::string(indent, ' ') + "DO";
             indent += 2;
         }
         else if (xt == xtXQUERY_DO) {
-            int dist = fetch(ptr);
+            cell dist = fetch(ptr);
             line.target_addr = ptr + dist;
             ptr += CELL_SZ;
             line.text = std::string(indent, ' ') + "?DO";
             indent += 2;
         }
         else if (xt == xtXLOOP) {
-            int dist = fetch(ptr);
+            cell dist = fetch(ptr);
             line.target_addr = ptr + dist;
             ptr += CELL_SZ;
             indent -= 2;
             line.text = std::string(indent, ' ') + "LOOP";
         }
         else if (xt == xtXPLUS_LOOP) {
-            int dist = fetch(ptr);
+            cell dist = fetch(ptr);
             line.target_addr = ptr + dist;
             ptr += CELL_SZ;
             indent -= 2;
             line.text = std::string(indent, ' ') + "+LOOP";
         }
         else if (xt == xtXLEAVE) {
-            int dist = fetch(ptr);
+            cell dist = fetch(ptr);
             line.target_addr = ptr + dist;
             ptr += CELL_SZ;
             line.text = std::string(indent, ' ') + "LEAVE";
@@ -162,7 +192,7 @@ static std::vector<Line> disassemble(uint body, uint size) {
             line.text = std::string(indent, ' ') + "UNLOOP";
         }
         else if (xt == xtXOF) {
-            int dist = fetch(ptr);
+            cell dist = fetch(ptr);
             line.target_addr = ptr + dist;
             ptr += CELL_SZ;
             line.text = std::string(indent, ' ') + "OF";
@@ -177,7 +207,7 @@ static std::vector<Line> disassemble(uint body, uint size) {
 }
 
 static void mark_labels(std::vector<Line>& lines) {
-    int label_id = 1;
+    cell label_id = 1;
     for (auto& line : lines) {
         if (line.target_addr != 0) {
             auto it = find_if(lines.begin(), lines.end(),
@@ -194,76 +224,76 @@ static void mark_labels(std::vector<Line>& lines) {
     }
 }
 
-static void dump_colon_definition(uint body, uint size) {
+static void dump_colon_definition(ucell body, ucell size) {
     std::vector<Line> lines = disassemble(body, size);
     mark_labels(lines);
 
     for (const auto& line : lines) {
         if (line.label_id != 0) {
-            std::cout << "L" << line.label_id << ":" << std::endl;
+            vm->out << "L" << line.label_id << ":" << std::endl;
         }
-        std::cout << "    " << line.text << std::endl;
+        vm->out << "    " << line.text << std::endl;
     }
-    std::cout << ";" << std::endl;
+    vm->out << ";" << std::endl;
 }
 
-void dump_body_definition(uint body, uint size) {
-    std::cout << std::endl;
-    for (uint ptr = body; ptr < body + size; ptr += CELL_SZ) {
-        std::cout << fetch(ptr) << BL;
+void dump_body_definition(ucell body, ucell size) {
+    vm->out << std::endl;
+    for (ucell ptr = body; ptr < body + size; ptr += CELL_SZ) {
+        vm->out << fetch(ptr) << BL;
     }
-    std::cout << std::endl;
+    vm->out << std::endl;
 }
 
 void f_see() {
-    Header* header = vm.dict.parse_find_existing_word();
+    Header* header = vm->dict.parse_find_existing_word();
     assert(header != nullptr);
-    uint xt = header->xt();
-    uint size = header->get_size();
-    uint body = xt + CELL_SZ;
-    uint code = header->code;
+    ucell xt = header->xt();
+    ucell size = header->get_size();
+    ucell body = xt + CELL_SZ;
+    ucell code = header->code;
     std::string name = header->name()->to_string();
 
     switch (code) {
     case idXDOCOL:
-        std::cout << std::endl << ": " << name << std::endl;
+        vm->out << std::endl << ": " << name << std::endl;
         dump_colon_definition(body, size);
         break;
     case idXDOVAR:
         if (size == CELL_SZ) {
-            int value = fetch(body);
-            std::cout << std::endl << "VARIABLE " << name << BL;
+            cell value = fetch(body);
+            vm->out << std::endl << "VARIABLE " << name << BL;
             print_number(value);
-            std::cout << name << BL << "!" << std::endl;
+            vm->out << name << BL << "!" << std::endl;
         }
         else if (size == DCELL_SZ) {
             dint value = dfetch(body);
-            std::cout << std::endl << "2VARIABLE " << name << BL;
+            vm->out << std::endl << "2VARIABLE " << name << BL;
             print_number_dot(value);
-            std::cout << name << BL << "2!" << std::endl;
+            vm->out << name << BL << "2!" << std::endl;
         }
         else {
-            std::cout << std::endl << "CREATE " << name << BL;
+            vm->out << std::endl << "CREATE " << name << BL;
             dump_body_definition(body, size);
         }
         break;
     case idXDOFVAR:
         if (size == FCELL_SZ) {
             double value = ffetch(body);
-            std::cout << std::endl << "FVARIABLE " << name << BL;
+            vm->out << std::endl << "FVARIABLE " << name << BL;
             print_number_e(value);
-            std::cout << name << BL << "F!" << std::endl;
+            vm->out << name << BL << "F!" << std::endl;
         }
         else {
-            std::cout << std::endl << "CREATE " << name << BL;
+            vm->out << std::endl << "CREATE " << name << BL;
             dump_body_definition(body, size);
         }
         break;
     case idXDOCONST: {
-        int value = fetch(body);
-        std::cout << std::endl;
+        cell value = fetch(body);
+        vm->out << std::endl;
         print_number(value);
-        std::cout << "CONSTANT " << name << std::endl;
+        vm->out << "CONSTANT " << name << std::endl;
 
         if (size > CELL_SZ) {
             dump_body_definition(body + CELL_SZ, size - CELL_SZ);
@@ -272,9 +302,9 @@ void f_see() {
     }
     case idXDO2CONST: {
         dint value = dfetch(body);
-        std::cout << std::endl;
+        vm->out << std::endl;
         print_number_dot(value);
-        std::cout << "2CONSTANT " << name << std::endl;
+        vm->out << "2CONSTANT " << name << std::endl;
 
         if (size > DCELL_SZ) {
             dump_body_definition(body + DCELL_SZ, size - DCELL_SZ);
@@ -283,41 +313,62 @@ void f_see() {
     }
     case idXDOFCONST: {
         double value = ffetch(body);
-        std::cout << std::endl;
+        vm->out << std::endl;
         print_number_e(value);
-        std::cout << "FCONSTANT " << name << std::endl;
+        vm->out << "FCONSTANT " << name << std::endl;
 
         if (size > FCELL_SZ) {
             dump_body_definition(body + FCELL_SZ, size - FCELL_SZ);
         }
         break;
     }
+    case idXDOVALUE: {
+        cell value = fetch(body);
+        vm->out << std::endl;
+        print_number(value);
+        vm->out << "VALUE " << name << std::endl;
+        break;
+    }
+    case idXDO2VALUE: {
+        dint value = dfetch(body);
+        vm->out << std::endl;
+        print_number_dot(value);
+        vm->out << "2VALUE " << name << std::endl;
+        break;
+    }
+    case idXDOFVALUE: {
+        double value = ffetch(body);
+        vm->out << std::endl;
+        print_number_e(value);
+        vm->out << "FVALUE " << name << std::endl;
+        break;
+    }
     case idXMARKER: {
-        uint ptr = body;
-        std::cout << std::endl << "MARKER " << name << std::endl
-                  << "Latest:    ";
+        ucell ptr = body;
+        vm->out << std::endl << "MARKER " << name << std::endl
+                << "Latest:    ";
         print_number(fetch(ptr));
         ptr += CELL_SZ;
-        std::cout << std::endl
-                  << "Here:      ";
+        vm->out << std::endl
+                << "Here:      ";
         print_number(fetch(ptr));
         ptr += CELL_SZ;
-        std::cout << std::endl
-                  << "Names:     ";
+        vm->out << std::endl
+                << "Names:     ";
         print_number(fetch(ptr));
         ptr += CELL_SZ;
-        std::cout << std::endl
-                  << "Wordlists: ";
-        uint num_wordlists = fetch(ptr);
+        vm->out << std::endl
+                << "Wordlists: ";
+        ucell num_wordlists = fetch(ptr);
         ptr += CELL_SZ;
-        for (uint i = 0; i < num_wordlists; ++i) {
+        for (ucell i = 0; i < num_wordlists; ++i) {
             if (i > 0) {
-                std::cout << ", ";
+                vm->out << ", ";
             }
             print_number(fetch(ptr));
             ptr += CELL_SZ;
         }
-        std::cout << std::endl;
+        vm->out << std::endl;
         if (size > ptr) {
             dump_body_definition(ptr, body + size - ptr);
         }
@@ -325,10 +376,10 @@ void f_see() {
     }
     case idXDEFER:
         if (size == CELL_SZ) {
-            int action_xt = fetch(body);
+            cell action_xt = fetch(body);
             Header* action_header = Header::header(action_xt);
-            std::cout << std::endl << "DEFER " << name << BL
-                      << "ACTION OF " << action_header->name()->to_string() << std::endl;
+            vm->out << std::endl << "DEFER " << name << BL
+                    << "ACTION OF " << action_header->name()->to_string() << std::endl;
         }
         if (size > CELL_SZ) {
             dump_body_definition(body + CELL_SZ, size - CELL_SZ);
@@ -336,15 +387,15 @@ void f_see() {
         break;
     case idXDOES_RUN: {
         Header* creator_header = Header::header(header->creator_xt);
-        std::cout << std::endl << creator_header->name()->to_string() << BL << name;
+        vm->out << std::endl << creator_header->name()->to_string() << BL << name;
         dump_body_definition(body, size);
         break;
     }
     case idXPLUS_FIELD:
         if (size == CELL_SZ) {
-            uint offset = fetch(body);
-            std::cout << std::endl << "FIELD " << name << BL
-                      << "OFFSET " << offset << std::endl;
+            ucell offset = fetch(body);
+            vm->out << std::endl << "FIELD " << name << BL
+                    << "OFFSET " << offset << std::endl;
         }
         if (size > CELL_SZ) {
             dump_body_definition(body + CELL_SZ, size - CELL_SZ);
@@ -352,10 +403,10 @@ void f_see() {
         break;
     case idXSYNONYM: {
         if (size == CELL_SZ) {
-            uint old_xt = fetch(body);
+            ucell old_xt = fetch(body);
             Header* old_header = Header::header(old_xt);
-            std::cout << std::endl << "SYNONYM " << name << BL
-                      << old_header->name()->to_string() << std::endl;
+            vm->out << std::endl << "SYNONYM " << name << BL
+                    << old_header->name()->to_string() << std::endl;
         }
         if (size > CELL_SZ) {
             dump_body_definition(body + CELL_SZ, size - CELL_SZ);
@@ -363,7 +414,7 @@ void f_see() {
         break;
     }
     default: {
-        std::cout << std::endl << name << std::endl;
+        vm->out << std::endl << name << std::endl;
         dump_body_definition(body, size);
         break;
     }
@@ -371,50 +422,51 @@ void f_see() {
 }
 
 void f_n_to_r() {
-    uint n = pop();
-    for (uint i = 0; i < n; ++i) {
+    ucell n = pop();
+    for (ucell i = 0; i < n; ++i) {
         r_push(pop());
     }
     r_push(n);
 }
 
 void f_n_r_from() {
-    uint n = r_pop();
-    for (uint i = 0; i < n; ++i) {
+    ucell n = r_pop();
+    for (ucell i = 0; i < n; ++i) {
         push(r_pop());
     }
     push(n);
 }
 
 void f_forget() {
-    Header* header = vm.dict.parse_find_existing_word();
+    Header* header = vm->dict.parse_find_existing_word();
     assert(header != nullptr);
-    vm.here = mem_addr(reinterpret_cast<char*>
+    vm->here = mem_addr(reinterpret_cast<char*>
                        (header)); // reset here to reclaim memory
-    vm.latest_word = header->prev; // point to previous word
+    forget_inlined(vm->here);
+    vm->latest_word = header->prev; // point to previous word
     Header* latest = reinterpret_cast<Header*>(
-                         mem_char_ptr(vm.latest_word));
-    vm.names = latest->name_addr;
+                         mem_char_ptr(vm->latest_word));
+    vm->names = latest->name_addr;
 
     // reclaim wordlists
-    for (uint i = 0; i < static_cast<uint>(vm.wordlists.size()); ++i) {
-        while (vm.wordlists[i] > vm.latest_word) {
+    for (ucell i = 0; i < static_cast<ucell>(vm->wordlists.size()); ++i) {
+        while (vm->wordlists[i] > vm->latest_word) {
             Header* latest = reinterpret_cast<Header*>(
-                                 mem_char_ptr(vm.wordlists[i]));
-            vm.wordlists[i] = latest->link;
+                                 mem_char_ptr(vm->wordlists[i]));
+            vm->wordlists[i] = latest->link;
         }
     }
 }
 
 void f_to_name() {
-    uint xt = pop();
+    ucell xt = pop();
     Header* header = Header::header(xt);
-    uint nt = mem_addr(reinterpret_cast<char*>(header));
+    ucell nt = mem_addr(reinterpret_cast<char*>(header));
     push(nt);
 }
 
 void f_xcompile() {
-    uint nt = pop();
+    ucell nt = pop();
     Header* header = reinterpret_cast<Header*>(mem_char_ptr(nt));
     if (header->flags.immediate) {
         f_execute(header->xt());  // execute immediately
@@ -425,13 +477,13 @@ void f_xcompile() {
 }
 
 void f_name_to_compile() {
-    uint nt = pop();
+    ucell nt = pop();
     push(nt);
     push(xtXCOMPILE);
 }
 
 void f_name_to_string() {
-    uint name_addr = pop();
+    ucell name_addr = pop();
     Header* header = reinterpret_cast<Header*>(
                          mem_char_ptr(name_addr));
     CString* name = reinterpret_cast<CString*>(
@@ -441,18 +493,18 @@ void f_name_to_string() {
 }
 
 void f_name_to_interpret() {
-    uint name_addr = pop();
+    ucell name_addr = pop();
     Header* header = reinterpret_cast<Header*>(
                          mem_char_ptr(name_addr));
-    uint xt = header->xt();
+    ucell xt = header->xt();
     push(xt);
 }
 
 void f_synonym() {
-    uint new_xt = vm.dict.parse_create(idXSYNONYM, 0);
+    ucell new_xt = vm->dict.parse_create(idXSYNONYM, 0);
     Header* new_header = Header::header(new_xt);
 
-    Header* old_header = vm.dict.parse_find_existing_word();
+    Header* old_header = vm->dict.parse_find_existing_word();
     assert(old_header != nullptr);
 
     comma(old_header->xt());
@@ -461,11 +513,11 @@ void f_synonym() {
     }
 }
 
-void f_xsynonym(uint body) {
-    uint old_xt = fetch(body);
+void f_xsynonym(ucell body) {
+    ucell old_xt = fetch(body);
     Header* old_header = Header::header(old_xt);
     if (old_header->flags.immediate ||
-            vm.user->STATE == STATE_INTERPRET) {
+            vm->user->STATE == STATE_INTERPRET) {
         f_execute(old_xt);
     }
     else {
@@ -474,10 +526,10 @@ void f_xsynonym(uint body) {
 }
 
 void f_traverse_wordlist() {
-    uint wid = pop();
-    uint xt = pop();
+    ucell wid = pop();
+    ucell xt = pop();
 
-    std::vector<uint> nts = vm.dict.get_word_nts(wid);
+    std::vector<ucell> nts = vm->dict.get_word_nts(wid);
     for (auto nt : nts) {
         push(nt);
         f_execute(xt);
@@ -489,7 +541,7 @@ void f_traverse_wordlist() {
 }
 
 void f_bracket_defined() {
-    Header* header = vm.dict.parse_find_word();
+    Header* header = vm->dict.parse_find_word();
     if (header != nullptr) {
         push(F_TRUE);
     }
@@ -499,7 +551,7 @@ void f_bracket_defined() {
 }
 
 void f_bracket_undefined() {
-    Header* header = vm.dict.parse_find_word();
+    Header* header = vm->dict.parse_find_word();
     if (header == nullptr) {
         push(F_TRUE);
     }
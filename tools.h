@@ -7,7 +7,7 @@
 #pragma once
 
 void f_dump();
-void f_dump(const char* mem, uint size);
+void f_dump(const char* mem, ucell size);
 void f_see();
 void f_n_to_r();
 void f_n_r_from();
@@ -18,7 +18,7 @@ void f_name_to_compile();
 void f_name_to_string();
 void f_name_to_interpret();
 void f_synonym();
-void f_xsynonym(uint body);
+void f_xsynonym(ucell body);
 void f_traverse_wordlist();
 void f_bracket_defined();
 void f_bracket_undefined();
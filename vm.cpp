@@ -9,10 +9,13 @@
 #include "kbd_input.h"
 #include "strings.h"
 #include "vm.h"
+#include <cstring>
 
-VM vm;
+thread_local VM* vm = nullptr;
 
 VM::VM() {
+    make_current();
+
     // bottom of memory
     wordbuf_data = mem.alloc_bottom(WORDBUF_SZ);
     wordbuf.init();
@@ -32,11 +35,12 @@ VM::VM() {
     // user variables
     user = reinterpret_cast<User*>(mem.alloc_bottom(sizeof(User)));
     user->init();
+    tasks.init();
 
     // split the rest in two halves - dictionary and heap
-    uint bottom = mem.addr(mem.alloc_bottom(0));
-    uint top = mem.addr(mem.alloc_top(0));
-    uint mid_mem = aligned((bottom + top) / 2);
+    ucell bottom = mem.addr(mem.alloc_bottom(0));
+    ucell top = mem.addr(mem.alloc_top(0));
+    ucell mid_mem = aligned((bottom + top) / 2);
 
     dict_lo_mem = bottom;
     dict_hi_mem = mid_mem;
@@ -47,6 +51,7 @@ VM::VM() {
 
     // initilize dictionary and heap
     dict.init();
+    recognizers.init();
     heap.init();
 
     // reinit wordbuf to get predictable results in tests
@@ -56,116 +61,204 @@ VM::VM() {
     init_console_input();
 }
 
+// shares the memory of parent, the buffers, user variables and dictionary
+// pointers are set by the workers before each loop
+VM::VM(VM& parent)
+    : mem(parent.mem), user(nullptr) {
+    make_current();
+    workers.set_nested();
+}
+
 VM::~VM() {
+    VM* current = vm;
+    make_current();
+    workers.clear();
+    tasks.clear();
     blocks.deinit();
+    out.flush();
+    vm = (current == this) ? nullptr : current;
+}
+
+void VM::make_current() {
+    vm = this;
+}
+
+void VM::save_snapshot(VMSnapshot& snapshot) {
+    const char* data = mem.char_ptr(0, MEM_SZ);
+    snapshot.mem.assign(data, data + MEM_SZ);
+    snapshot.wordbuf_ptr = wordbuf_ptr;
+    snapshot.number_output_ptr = number_output_ptr;
+    snapshot.precision = precision;
+    snapshot.latest_word = latest_word;
+    snapshot.wordlists = wordlists;
+    snapshot.search_order = search_order;
+    snapshot.definitions_wid = definitions_wid;
+    snapshot.name_filter = name_filter;
+    snapshot.here = here;
+    snapshot.names = names;
+    snapshot.substitutions = substitutions;
+    snapshot.heap = heap;
+    snapshot.recognizers = recognizers;
+    snapshot.inlined = inlined;
+    snapshot.included_files = included_files;
+    snapshot.callbacks = callbacks;
+    snapshot.tasks = tasks.addresses();
+}
+
+void VM::restore_snapshot(const VMSnapshot& snapshot) {
+    tasks.restore(snapshot.tasks);     // unwind the tasks before the memory
+    memcpy(mem.char_ptr(0, MEM_SZ), snapshot.mem.data(), MEM_SZ);
+    wordbuf_ptr = snapshot.wordbuf_ptr;
+    number_output_ptr = snapshot.number_output_ptr;
+    precision = snapshot.precision;
+    latest_word = snapshot.latest_word;
+    wordlists = snapshot.wordlists;
+    search_order = snapshot.search_order;
+    definitions_wid = snapshot.definitions_wid;
+    name_filter = snapshot.name_filter;
+    here = snapshot.here;
+    names = snapshot.names;
+    substitutions = snapshot.substitutions;
+    heap = snapshot.heap;
+    recognizers = snapshot.recognizers;
+    inlined = snapshot.inlined;
+    included_files = snapshot.included_files;
+    callbacks = snapshot.callbacks;
+
+    ip = 0;
+    error_message.clear();
+    stack.clear();
+    r_stack.clear();
+    loop_stack.clear();
+    cs_stack.clear();
+    except_stack.clear();
+    f_stack.clear();
+    locals.clear();
+    skipping_stack.clear();
+    skipping = false;
+    last_call = 0;
+    last_back_target = 0;
+    fwd_jumps.clear();
+    literals.clear();
+}
+
+void exit_forth(int status) {
+    if (vm != nullptr) {
+        vm->out.flush();
+    }
+    exit(status);
 }
 
 // pointer - address conversion
-uint mem_addr(const char* ptr) {
-    return vm.mem.addr(ptr);
+ucell mem_addr(const char* ptr) {
+    return vm->mem.addr(ptr);
+}
+
+ucell mem_addr(const cell* ptr) {
+    return vm->mem.addr(ptr);
 }
 
-uint mem_addr(const int* ptr) {
-    return vm.mem.addr(ptr);
+ucell mem_addr(const ucell* ptr) {
+    return vm->mem.addr(reinterpret_cast<const cell*>(ptr));
 }
 
-uint mem_addr(const uint* ptr) {
-    return vm.mem.addr(reinterpret_cast<const int*>(ptr));
+ucell mem_addr(const CString* ptr) {
+    return vm->mem.addr(reinterpret_cast<const char*>(ptr));
 }
 
-uint mem_addr(const CString* ptr) {
-    return vm.mem.addr(reinterpret_cast<const char*>(ptr));
+char* mem_char_ptr(ucell addr, ucell size) {
+    return vm->mem.char_ptr(addr, size);
 }
 
-char* mem_char_ptr(uint addr, uint size) {
-    return vm.mem.char_ptr(addr, size);
+cell* mem_int_ptr(ucell addr, ucell size) {
+    return vm->mem.int_ptr(addr, size);
 }
 
-int* mem_int_ptr(uint addr, uint size) {
-    return vm.mem.int_ptr(addr, size);
+double* mem_float_ptr(ucell addr, ucell size) {
+    return vm->mem.float_ptr(addr, size);
 }
 
 // access memory
-int fetch(uint addr) {
-    return vm.mem.fetch(addr);
+cell fetch(ucell addr) {
+    return vm->mem.fetch(addr);
 }
 
-void store(uint addr, int value) {
-    vm.mem.store(addr, value);
+void store(ucell addr, cell value) {
+    vm->mem.store(addr, value);
 }
 
-dint dfetch(uint addr) {
-    return vm.mem.dfetch(addr);
+dint dfetch(ucell addr) {
+    return vm->mem.dfetch(addr);
 }
 
-void dstore(uint addr, dint value) {
-    vm.mem.dstore(addr, value);
+void dstore(ucell addr, dint value) {
+    vm->mem.dstore(addr, value);
 }
 
-double ffetch(uint addr) {
-    return vm.mem.ffetch(addr);
+double ffetch(ucell addr) {
+    return vm->mem.ffetch(addr);
 }
 
-void fstore(uint addr, double value) {
-    vm.mem.fstore(addr, value);
+void fstore(ucell addr, double value) {
+    vm->mem.fstore(addr, value);
 }
 
-double sffetch(uint addr) {
-    return static_cast<double>(vm.mem.sffetch(addr));
+double sffetch(ucell addr) {
+    return static_cast<double>(vm->mem.sffetch(addr));
 }
 
-void sfstore(uint addr, double value) {
-    vm.mem.sfstore(addr, static_cast<float>(value));
+void sfstore(ucell addr, double value) {
+    vm->mem.sfstore(addr, static_cast<float>(value));
 }
 
-int cfetch(uint addr) {
-    return vm.mem.cfetch(addr);
+cell cfetch(ucell addr) {
+    return vm->mem.cfetch(addr);
 }
 
-void cstore(uint addr, int value) {
-    vm.mem.cstore(addr, value);
+void cstore(ucell addr, cell value) {
+    vm->mem.cstore(addr, value);
 }
 
 // allot dictionary space
-void ccomma(int value) {
-    vm.dict.ccomma(value);
+void ccomma(cell value) {
+    vm->dict.ccomma(value);
 }
 
-void comma(int value) {
-    vm.dict.comma(value);
+void comma(cell value) {
+    vm->dict.comma(value);
 }
 
 void dcomma(dint value) {
-    vm.dict.dcomma(value);
+    vm->dict.dcomma(value);
 }
 
 void fcomma(double value) {
-    vm.dict.fcomma(value);
+    vm->dict.fcomma(value);
 }
 
 void align() {
-    vm.dict.align();
+    vm->dict.align();
 }
 
 // stacks
-void push(int value) {
-    vm.stack.push(value);
+void push(cell value) {
+    vm->stack.push(value);
 }
 
-int pop() {
-    return vm.stack.pop();
+cell pop() {
+    return vm->stack.pop();
 }
 
-int peek(uint depth) {
-    return vm.stack.peek(depth);
+cell peek(ucell depth) {
+    return vm->stack.peek(depth);
 }
 
-uint depth() {
-    return vm.stack.size();
+ucell depth() {
+    return vm->stack.size();
 }
 
-void roll(uint depth) {
-    vm.stack.roll(depth);
+void roll(ucell depth) {
+    vm->stack.roll(depth);
 }
 
 void dpush(dint value) {
@@ -174,31 +267,31 @@ void dpush(dint value) {
 }
 
 dint dpop() {
-    int hi = pop();
-    int lo = pop();
+    cell hi = pop();
+    cell lo = pop();
     return mk_dcell(hi, lo);
 }
 
-dint dpeek(uint depth) {
-    int hi = vm.stack.peek(2 * depth);
-    int lo = vm.stack.peek(2 * depth + 1);
+dint dpeek(ucell depth) {
+    cell hi = vm->stack.peek(2 * depth);
+    cell lo = vm->stack.peek(2 * depth + 1);
     return mk_dcell(hi, lo);
 }
 
-void r_push(int value) {
-    vm.r_stack.push(value);
+void r_push(cell value) {
+    vm->r_stack.push(value);
 }
 
-int r_pop() {
-    return vm.r_stack.pop();
+cell r_pop() {
+    return vm->r_stack.pop();
 }
 
-int r_peek(uint depth) {
-    return vm.r_stack.peek(depth);
+cell r_peek(ucell depth) {
+    return vm->r_stack.peek(depth);
 }
 
-uint r_depth() {
-    return vm.r_stack.size();
+ucell r_depth() {
+    return vm->r_stack.size();
 }
 
 void r_dpush(dint value) {
@@ -207,86 +300,86 @@ void r_dpush(dint value) {
 }
 
 dint r_dpop() {
-    int hi = r_pop();
-    int lo = r_pop();
+    cell hi = r_pop();
+    cell lo = r_pop();
     return mk_dcell(hi, lo);
 }
 
-dint r_dpeek(uint depth) {
-    int hi = vm.r_stack.peek(2 * depth);
-    int lo = vm.r_stack.peek(2 * depth + 1);
+dint r_dpeek(ucell depth) {
+    cell hi = vm->r_stack.peek(2 * depth);
+    cell lo = vm->r_stack.peek(2 * depth + 1);
     return mk_dcell(hi, lo);
 }
 
 void cs_dpush(dint pos_addr) {
-    vm.cs_stack.push(dcell_lo(pos_addr));
-    vm.cs_stack.push(dcell_hi(pos_addr));
+    vm->cs_stack.push(dcell_lo(pos_addr));
+    vm->cs_stack.push(dcell_hi(pos_addr));
 }
 
 dint cs_dpop() {
-    int hi = vm.cs_stack.pop();
-    int lo = vm.cs_stack.pop();
+    cell hi = vm->cs_stack.pop();
+    cell lo = vm->cs_stack.pop();
     return mk_dcell(hi, lo);
 }
 
-dint cs_dpeek(uint depth) {
-    int hi = vm.cs_stack.peek(2 * depth);
-    int lo = vm.cs_stack.peek(2 * depth + 1);
+dint cs_dpeek(ucell depth) {
+    cell hi = vm->cs_stack.peek(2 * depth);
+    cell lo = vm->cs_stack.peek(2 * depth + 1);
     return mk_dcell(hi, lo);
 }
 
-void cs_droll(uint depth) {
+void cs_droll(ucell depth) {
     std::vector<dint> save;
-    for (uint i = 0; i < depth; ++i) {
+    for (ucell i = 0; i < depth; ++i) {
         save.push_back(cs_dpop());
     }
     dint value = cs_dpop();
-    for (uint i = depth - 1; i < depth; --i) {
+    for (ucell i = depth - 1; i < depth; --i) {
         cs_dpush(save[i]);
     }
     cs_dpush(value);
 }
 
-uint cs_ddepth() {
-    return vm.cs_stack.size() / 2;
+ucell cs_ddepth() {
+    return vm->cs_stack.size() / 2;
 }
 
 void fpush(double value) {
-    vm.f_stack.push(value);
+    vm->f_stack.push(value);
 }
 
 double fpop() {
-    return vm.f_stack.pop();
+    return vm->f_stack.pop();
 }
 
-double fpeek(uint depth) {
-    return vm.f_stack.peek(depth);
+double fpeek(ucell depth) {
+    return vm->f_stack.peek(depth);
 }
 
-uint fdepth() {
-    return vm.f_stack.size();
+ucell fdepth() {
+    return vm->f_stack.size();
 }
 
 void init_conditional() {
-    vm.skipping_stack.clear();
-    vm.skipping = 0;
+    vm->skipping_stack.clear();
+    vm->skipping = 0;
 }
 
 void end_conditional() {
     // Check for missing [THEN]
-    if (!vm.skipping_stack.empty()) {
+    if (!vm->skipping_stack.empty()) {
         error(Error::UnmatchedConditionalCompilation);
         init_conditional();
     }
 }
 
 void compute_skipping() {
-    for (auto skipping : vm.skipping_stack) {
+    for (auto skipping : vm->skipping_stack) {
         if (skipping) {
-            vm.skipping = true;
+            vm->skipping = true;
             return;
         }
     }
-    vm.skipping = false;
+    vm->skipping = false;
 }
 
@@ -7,41 +7,96 @@
 #pragma once
 
 #include "block.h"
+#include "control.h"
 #include "dict.h"
 #include "file.h"
 #include "input.h"
 #include "locals.h"
 #include "memory.h"
+#include "optimizer.h"
 #include "output.h"
+#include "parallel.h"
+#include "recognizer.h"
 #include "stack.h"
 #include "strings.h"
+#include "tasks.h"
+#include <map>
+#include <ostream>
 #include <set>
 #include <string>
 #include <unordered_map>
 
+// words defined by the host with forth_register()
+struct HostCallback {
+    void (*func)(struct VM* vm, void* user_data);
+    void* user_data;
+};
+
+// state of a VM after loading its libraries, to restore it later; open
+// files and block buffers are not part of it
+struct VMSnapshot {
+    std::vector<char> mem;
+    ucell wordbuf_ptr;
+    ucell number_output_ptr;
+    ucell precision;
+    ucell latest_word;
+    std::vector<ucell> wordlists;
+    std::vector<ucell> search_order;
+    ucell definitions_wid;
+    NameFilter name_filter;
+    ucell here;
+    ucell names;
+    std::unordered_map<std::string, std::string> substitutions;
+    Heap heap;
+    Recognizers recognizers;
+    std::map<ucell, InlinedCode> inlined;
+    std::set<std::string> included_files;
+    std::vector<HostCallback> callbacks;
+    std::vector<ucell> tasks;
+};
+
+// an independent interpreter; each thread runs its own VM, made current by
+// the constructor or by make_current()
 struct VM {
     VM();
+    explicit VM(VM& parent);        // worker of PARALLEL-FOR, see Workers
     virtual ~VM();
+    VM(const VM&) = delete;
+    VM& operator=(const VM&) = delete;
+
+    void make_current();
+
+    // save and restore the memory and the dictionary, the stacks are
+    // cleared on restore
+    void save_snapshot(VMSnapshot& snapshot);
+    void restore_snapshot(const VMSnapshot& snapshot);
 
     // instruction pointer
-    int ip{ 0 };
+    cell ip{ 0 };
 
     // abort error message
     std::string error_message;
 
+    // message of the last error caught by forth_evaluate()
+    std::string last_error;
+
     // word buffer
     char* wordbuf_data{ nullptr };
-    uint wordbuf_ptr{ 0 };
+    ucell wordbuf_ptr{ 0 };
     Wordbuf wordbuf;
 
     // pad
     char* pad_data{ nullptr };
     Pad pad;
 
+    // buffered console output
+    ConsoleOutput console;
+    std::ostream out{ &console };
+
     // number output buffer
     char* number_output_data{ nullptr };
-    uint number_output_ptr{ 0 };
-    uint precision{ 7 };    // number of significant digits for float output
+    ucell number_output_ptr{ 0 };
+    ucell precision{ 7 };    // number of significant digits for float output
     NumberOutput number_output;
 
     // input buffer
@@ -63,16 +118,19 @@ struct VM {
     User* user;
 
     // data stack
-    Stack<int> stack{ '\0', Error::StackUnderflow };
+    Stack<cell> stack{ '\0', Error::StackUnderflow };
 
     // return stack
-    Stack<int> r_stack{ 'R', Error::ReturnStackUnderflow };
+    Stack<cell> r_stack{ 'R', Error::ReturnStackUnderflow };
+
+    // DO-loop stack
+    Stack<LoopFrame> loop_stack{ 'L', Error::ReturnStackUnderflow };
 
     // control stack
-    Stack<int> cs_stack{ 'C', Error::ControlFlowStackUnderflow };
+    Stack<cell> cs_stack{ 'C', Error::ControlFlowStackUnderflow };
 
     // exception stack
-    Stack<int> except_stack{ 'E', Error::ExceptionStackUnderflow };
+    Stack<cell> except_stack{ 'E', Error::ExceptionStackUnderflow };
 
     // floating point stack
     Stack<double> f_stack{ 'F', Error::FloatStackUnderflow };
@@ -82,17 +140,18 @@ struct VM {
     bool skipping{ false };             // currently skipping
 
     // dictionary
-    uint dict_lo_mem, dict_hi_mem;      // memory limits for dictionary
-    uint heap_lo_mem, heap_hi_mem;      // memory limits for heap
+    ucell dict_lo_mem, dict_hi_mem;      // memory limits for dictionary
+    ucell heap_lo_mem, heap_hi_mem;      // memory limits for heap
 
-    uint latest_word;                   // last defined word
+    ucell latest_word;                   // last defined word
     // each wordlist latest word indexed by wid
-    std::vector<uint> wordlists;
-    std::vector<uint> search_order;     // search order of wordlists
-    uint definitions_wid;               // wid where definitions are stored
+    std::vector<ucell> wordlists;
+    std::vector<ucell> search_order;     // search order of wordlists
+    ucell definitions_wid;               // wid where definitions are stored
+    NameFilter name_filter;              // names defined in any wordlist
 
-    uint here;			// point to next free position at bottom of memory
-    uint names;			// point to last name created at top of memory
+    ucell here;			// point to next free position at bottom of memory
+    ucell names;			// point to last name created at top of memory
 
     // list of substitutions
     std::unordered_map<std::string, std::string> substitutions;
@@ -100,62 +159,93 @@ struct VM {
     Dict dict;
     Heap heap;
 
+    // recognizer stack of the outer interpreter
+    Recognizers recognizers;
+
+    // code copied by the inliner, indexed by start address
+    std::map<ucell, InlinedCode> inlined;
+
+    // compiler state for tail calls
+    ucell last_call{ 0 };            // address of last call to a colon definition
+    ucell last_back_target{ 0 };     // address of last BEGIN or DO
+    std::vector<ucell> fwd_jumps;    // forward jump operands of current definition
+
+    // compiler state for constant folding
+    std::vector<ucell> literals;     // (LITERAL) addresses of current definition
+
     // files
     Files files;            // system files
 
     // included files
     std::set<std::string> included_files;
+
+    // host functions called by (CALLBACK), indexed by the word body
+    std::vector<HostCallback> callbacks;
+
+    // tasks created by TASK, switched by PAUSE
+    Tasks tasks;
+
+    // threads that run the iterations of PARALLEL-FOR
+    Workers workers;
 };
 
-extern VM vm;
+// VM of the current thread
+extern thread_local VM* vm;
+
+// flush the output of the VM and end the process
+[[noreturn]] void exit_forth(int status);
+
+// call a host function
+void f_xcallback(ucell body);
 
 // pointer - address conversion
-uint mem_addr(const char* ptr);
-uint mem_addr(const int* ptr);
-uint mem_addr(const uint* ptr);
-uint mem_addr(const CString* ptr);
+ucell mem_addr(const char* ptr);
+ucell mem_addr(const cell* ptr);
+ucell mem_addr(const ucell* ptr);
+ucell mem_addr(const CString* ptr);
 
-char* mem_char_ptr(uint addr, uint size = 0);
-int* mem_int_ptr(uint addr, uint size = 0);
+char* mem_char_ptr(ucell addr, ucell size = 0);
+cell* mem_int_ptr(ucell addr, ucell size = 0);
+double* mem_float_ptr(ucell addr, ucell size = 0);
 
 // access memory
-int fetch(uint addr);
-void store(uint addr, int value);
-dint dfetch(uint addr);
-void dstore(uint addr, dint value);
-double ffetch(uint addr);
-void fstore(uint addr, double value);
-double sffetch(uint addr);
-void sfstore(uint addr, double value);
-int cfetch(uint addr);
-void cstore(uint addr, int value);
+cell fetch(ucell addr);
+void store(ucell addr, cell value);
+dint dfetch(ucell addr);
+void dstore(ucell addr, dint value);
+double ffetch(ucell addr);
+void fstore(ucell addr, double value);
+double sffetch(ucell addr);
+void sfstore(ucell addr, double value);
+cell cfetch(ucell addr);
+void cstore(ucell addr, cell value);
 
 // allot dictionary space
-void ccomma(int value);
-void comma(int value);
+void ccomma(cell value);
+void comma(cell value);
 void dcomma(dint value);
 void fcomma(double value);
 void align();
 
 // stacks
-void push(int value);
-int pop();
-int peek(uint depth = 0);
-uint depth();
-void roll(uint depth);
+void push(cell value);
+cell pop();
+cell peek(ucell depth = 0);
+ucell depth();
+void roll(ucell depth);
 
 void dpush(dint value);
 dint dpop();
-dint dpeek(uint depth = 0);
+dint dpeek(ucell depth = 0);
 
-void r_push(int value);
-int r_pop();
-int r_peek(uint depth = 0);
-uint r_depth();
+void r_push(cell value);
+cell r_pop();
+cell r_peek(ucell depth = 0);
+ucell r_depth();
 
 void r_dpush(dint value);
 dint r_dpop();
-dint r_dpeek(uint depth = 0);
+dint r_dpeek(ucell depth = 0);
 
 enum {
     POS_COLON_START, POS_BEGIN_START, POS_DO_START, POS_CASE_START,
@@ -169,14 +259,14 @@ enum {
 
 void cs_dpush(dint pos_addr);
 dint cs_dpop();
-dint cs_dpeek(uint depth = 0);
-void cs_droll(uint depth);
-uint cs_ddepth();
+dint cs_dpeek(ucell depth = 0);
+void cs_droll(ucell depth);
+ucell cs_ddepth();
 
 void fpush(double value);
 double fpop();
-double fpeek(uint depth = 0);
-uint fdepth();
+double fpeek(ucell depth = 0);
+ucell fdepth();
 
 void init_conditional();
 void end_conditional();